@@ -115,6 +115,9 @@ def main():
 
         # 3. Robust extraction for YCSB TotalOps
         if 'duration' in df.columns:
+            # Keep only the throughput rows (results appended before the latency
+            # percentiles moved to ycsb_latencies.csv also contain their rows)
+            df = df[pd.to_numeric(df['duration'], errors='coerce').notna()].copy()
             cols_after_duration = df.columns[df.columns.get_loc('duration')+1:]
             df['real_total_ops'] = pd.to_numeric(df[cols_after_duration].ffill(axis=1).iloc[:, -1], errors='coerce')
         else:
@@ -0,0 +1,426 @@
+#pragma once
+#ifndef NUMA_MIGRATOR_HPP
+#define NUMA_MIGRATOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <numa.h>
+#include <numaif.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Opt-in user-space page migrator.
+//
+// Unlike AutoNUMA (on or off for the whole machine) it only looks at the
+// pages accepted by a filter - e.g. the pages of the numa pools - and never
+// touches the pinned ranges. A background thread samples the memory loads
+// of the process (perf "mem-loads" samples carry the data address and the
+// CPU), counts the samples per page and per accessing node, and every
+// interval moves (move_pages) the pages that are mostly accessed from
+// a node other than the one they are on, hottest first and at most
+// max_pages_per_sec of them.
+//
+// Sampling all CPUs needs perf_event_paranoid <= 0 (or CAP_PERFMON).
+
+struct numa_migrator_config {
+    unsigned interval_ms = 1000;       // length of a sampling round
+    unsigned max_pages_per_sec = 4096; // rate limit of the migrations
+    unsigned min_samples = 4;          // samples making a page hot
+    unsigned dominance_pct = 75;       // share of them the target node needs
+    uint64_t sample_period = 1000;     // events per sample
+    // sample page faults instead of memory loads (CPUs without PEBS/IBS)
+    bool page_faults = false;
+
+    // NUMA_MIGRATE_INTERVAL_MS, NUMA_MIGRATE_PAGES_PER_SEC,
+    // NUMA_MIGRATE_SAMPLE_PERIOD, NUMA_MIGRATE_EVENT=page-faults
+    static numa_migrator_config from_env() {
+        numa_migrator_config cfg;
+        if (const char* v = getenv("NUMA_MIGRATE_INTERVAL_MS")) cfg.interval_ms = strtoul(v, nullptr, 10);
+        if (const char* v = getenv("NUMA_MIGRATE_PAGES_PER_SEC")) cfg.max_pages_per_sec = strtoul(v, nullptr, 10);
+        if (const char* v = getenv("NUMA_MIGRATE_SAMPLE_PERIOD")) cfg.sample_period = strtoull(v, nullptr, 10);
+        if (const char* v = getenv("NUMA_MIGRATE_EVENT")) cfg.page_faults = (strcmp(v, "page-faults") == 0);
+        if (cfg.interval_ms == 0) cfg.interval_ms = 1000;
+        if (cfg.sample_period == 0) cfg.sample_period = 1;
+        return cfg;
+    }
+};
+
+class numa_migrator {
+public:
+    // returns true if the page of addr may be migrated
+    using filter_fn = bool (*)(const void* addr);
+
+    struct stats {
+        uint64_t samples;  // samples accepted by the filter
+        uint64_t hot;      // pages found on a non-dominant node
+        uint64_t migrated; // pages moved
+        uint64_t failed;   // pages move_pages() could not move
+    };
+
+    // Starts the migrator thread, returns false if sampling is not possible.
+    static bool start(const numa_migrator_config& cfg = numa_migrator_config(),
+                      filter_fn filter = nullptr) {
+        std::lock_guard<std::mutex> guard(control_lock);
+        if (running.load()) {
+            return true;
+        }
+        config = cfg;
+        page_filter = filter;
+        page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+        num_nodes = numa_max_node() + 1;
+        self_pid = (uint32_t)getpid();
+        if (!open_events()) {
+            close_events();
+            return false;
+        }
+        running.store(true);
+        worker = new std::thread(run);
+        return true;
+    }
+
+    // Stops and joins the migrator thread. It has to run before UMF and the
+    // statics of the process are torn down (e.g. from an atexit() hook
+    // registered after start()); a second call does nothing.
+    static void stop() {
+        std::lock_guard<std::mutex> guard(control_lock);
+        if (!running.exchange(false)) {
+            return;
+        }
+        worker->join();
+        delete worker;
+        worker = nullptr;
+        close_events();
+        pages.clear();
+    }
+
+    // Excludes [addr, addr + len) from migration, e.g. data placed on
+    // purpose that must stay where it is.
+    static void pin(const void* addr, size_t len) {
+        std::lock_guard<std::mutex> guard(pinned_lock);
+        pinned.emplace_back((uintptr_t)addr, (uintptr_t)addr + len);
+    }
+
+    static void unpin(const void* addr, size_t len) {
+        std::lock_guard<std::mutex> guard(pinned_lock);
+        auto range = std::make_pair((uintptr_t)addr, (uintptr_t)addr + len);
+        pinned.erase(std::remove(pinned.begin(), pinned.end(), range), pinned.end());
+    }
+
+    static stats get_stats() {
+        return {n_samples.load(), n_hot.load(), n_migrated.load(), n_failed.load()};
+    }
+
+private:
+    static constexpr size_t RING_PAGES = 8; // data pages of a ring (power of 2)
+
+    struct ring {
+        int fd;
+        void* base;
+        size_t size;
+    };
+
+    static inline numa_migrator_config config;
+    static inline filter_fn page_filter = nullptr;
+    static inline uintptr_t page_size = 4096;
+    static inline int num_nodes = 1;
+    // the samples of other processes are dropped (set by start())
+    static inline uint32_t self_pid = 0;
+    static inline std::vector<ring> rings;
+    static inline std::vector<int> cpu_node;
+    // a pointer - no std::thread destructor (std::terminate() if it is still
+    // joinable) runs at exit
+    static inline std::thread* worker = nullptr;
+    static inline std::atomic<bool> running{false};
+    static inline std::mutex control_lock;
+
+    static inline std::mutex pinned_lock;
+    static inline std::vector<std::pair<uintptr_t, uintptr_t>> pinned;
+
+    // page -> number of samples per accessing node (migrator thread only)
+    static inline std::unordered_map<uintptr_t, std::vector<uint32_t>> pages;
+
+    static inline std::atomic<uint64_t> n_samples{0};
+    static inline std::atomic<uint64_t> n_hot{0};
+    static inline std::atomic<uint64_t> n_migrated{0};
+    static inline std::atomic<uint64_t> n_failed{0};
+
+    // Reads the "mem-loads" event of the core PMU from sysfs,
+    // e.g. "event=0xcd,umask=0x1,ldlat=3".
+    static bool mem_loads_attr(perf_event_attr& attr) {
+        for (const char* pmu : {"cpu", "cpu_core"}) {
+            std::string dir = std::string("/sys/bus/event_source/devices/") + pmu;
+            std::ifstream type_file(dir + "/type");
+            std::ifstream event_file(dir + "/events/mem-loads");
+            unsigned type;
+            std::string spec;
+            if (!(type_file >> type) || !std::getline(event_file, spec)) {
+                continue;
+            }
+            attr.type = type;
+            std::stringstream ss(spec);
+            std::string term;
+            while (std::getline(ss, term, ',')) {
+                size_t eq = term.find('=');
+                uint64_t value = (eq == std::string::npos) ? 1 : strtoull(term.c_str() + eq + 1, nullptr, 0);
+                std::string key = term.substr(0, eq);
+                if (key == "event") {
+                    attr.config |= value;
+                } else if (key == "umask") {
+                    attr.config |= value << 8;
+                } else if (key == "ldlat") {
+                    attr.config1 = value;
+                } else {
+                    std::cerr << "numa_migrator: unsupported term of mem-loads: " << term << std::endl;
+                    return false;
+                }
+            }
+            attr.precise_ip = 2;
+            return true;
+        }
+        std::cerr << "numa_migrator: no mem-loads event (try NUMA_MIGRATE_EVENT=page-faults)" << std::endl;
+        return false;
+    }
+
+    static bool open_events() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (config.page_faults) {
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+        } else if (!mem_loads_attr(attr)) {
+            return false;
+        }
+        attr.sample_period = config.sample_period;
+        attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_ADDR | PERF_SAMPLE_CPU;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.disabled = 1;
+
+        int ncpus = numa_num_configured_cpus();
+        cpu_node.assign(ncpus, 0);
+        for (int cpu = 0; cpu < ncpus; cpu++) {
+            int node = numa_node_of_cpu(cpu);
+            cpu_node[cpu] = (node < 0) ? 0 : node;
+
+            // the threads of the process come and go - sample every CPU
+            // and keep the samples of this process
+            int fd = (int)syscall(__NR_perf_event_open, &attr, -1, cpu, -1, 0);
+            if (fd < 0) {
+                if (errno == ENODEV) {
+                    continue; // offline CPU
+                }
+                std::cerr << "numa_migrator: perf_event_open failed on CPU " << cpu
+                          << ": " << strerror(errno) << std::endl;
+                return false;
+            }
+            size_t size = (RING_PAGES + 1) * page_size;
+            void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) {
+                close(fd);
+                std::cerr << "numa_migrator: cannot map the perf ring buffer" << std::endl;
+                return false;
+            }
+            rings.push_back({fd, base, size});
+        }
+        for (auto& r : rings) {
+            ioctl(r.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        return !rings.empty();
+    }
+
+    static void close_events() {
+        for (auto& r : rings) {
+            munmap(r.base, r.size);
+            close(r.fd);
+        }
+        rings.clear();
+    }
+
+    static void add_sample(uint32_t pid, uint64_t addr, uint32_t cpu) {
+        if (pid != self_pid || addr == 0 || cpu >= cpu_node.size()) {
+            return;
+        }
+        if (page_filter && !page_filter((const void*)addr)) {
+            return;
+        }
+        auto& counts = pages[addr & ~(page_size - 1)];
+        if (counts.empty()) {
+            counts.assign(num_nodes, 0);
+        }
+        counts[cpu_node[cpu]]++;
+        n_samples.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void drain(ring& r) {
+        auto* meta = static_cast<perf_event_mmap_page*>(r.base);
+        char* data = static_cast<char*>(r.base) + page_size;
+        uint64_t data_size = RING_PAGES * page_size;
+        uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = meta->data_tail;
+
+        while (tail < head) {
+            perf_event_header hdr;
+            copy_from_ring(&hdr, data, data_size, tail, sizeof(hdr));
+            if (hdr.size == 0) {
+                break;
+            }
+            if (hdr.type == PERF_RECORD_SAMPLE) {
+                // PERF_SAMPLE_TID, PERF_SAMPLE_ADDR, PERF_SAMPLE_CPU (in this order)
+                struct {
+                    uint32_t pid, tid;
+                    uint64_t addr;
+                    uint32_t cpu, res;
+                } s;
+                copy_from_ring(&s, data, data_size, tail + sizeof(hdr), sizeof(s));
+                add_sample(s.pid, s.addr, s.cpu);
+            }
+            tail += hdr.size;
+        }
+        __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    static void copy_from_ring(void* dst, const char* data, uint64_t data_size, uint64_t pos, size_t len) {
+        uint64_t off = pos & (data_size - 1);
+        size_t first = std::min<uint64_t>(len, data_size - off);
+        memcpy(dst, data + off, first);
+        memcpy(static_cast<char*>(dst) + first, data, len - first);
+    }
+
+    static bool is_pinned(uintptr_t page) {
+        std::lock_guard<std::mutex> guard(pinned_lock);
+        for (auto& range : pinned) {
+            if (page + page_size > range.first && page < range.second) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves the hottest pages whose dominant node is not their current one.
+    static void migrate() {
+        struct candidate {
+            uintptr_t page;
+            int node;
+            uint32_t total;
+        };
+        std::vector<candidate> candidates;
+        for (auto& [page, counts] : pages) {
+            uint32_t total = 0;
+            int best = 0;
+            for (int n = 0; n < num_nodes; n++) {
+                total += counts[n];
+                if (counts[n] > counts[best]) {
+                    best = n;
+                }
+            }
+            if (total >= config.min_samples &&
+                (uint64_t)counts[best] * 100 >= (uint64_t)total * config.dominance_pct) {
+                candidates.push_back({page, best, total});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const candidate& a, const candidate& b) { return a.total > b.total; });
+
+        size_t budget = std::max<size_t>(1, (size_t)config.max_pages_per_sec * config.interval_ms / 1000);
+        std::vector<void*> batch;
+        std::vector<int> nodes;
+        for (auto& c : candidates) {
+            if (batch.size() == budget) {
+                break;
+            }
+            if (!is_pinned(c.page)) {
+                batch.push_back((void*)c.page);
+                nodes.push_back(c.node);
+            }
+        }
+        if (batch.empty()) {
+            return;
+        }
+
+        // keep only the pages that are not on their target node yet
+        std::vector<int> status(batch.size());
+        if (move_pages(0, batch.size(), batch.data(), nullptr, status.data(), 0) != 0) {
+            return;
+        }
+        size_t n = 0;
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (status[i] >= 0 && status[i] != nodes[i]) {
+                batch[n] = batch[i];
+                nodes[n] = nodes[i];
+                n++;
+            }
+        }
+        if (n == 0) {
+            return;
+        }
+        n_hot.fetch_add(n, std::memory_order_relaxed);
+
+        if (move_pages(0, n, batch.data(), nodes.data(), status.data(), MPOL_MF_MOVE) < 0) {
+            n_failed.fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (status[i] == nodes[i]) {
+                n_migrated.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                n_failed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // halves the counts, so the decisions follow a drifting workload
+    static void decay() {
+        for (auto it = pages.begin(); it != pages.end();) {
+            uint32_t total = 0;
+            for (auto& c : it->second) {
+                c /= 2;
+                total += c;
+            }
+            it = (total == 0) ? pages.erase(it) : std::next(it);
+        }
+    }
+
+    static void run() {
+        std::vector<pollfd> fds;
+        for (auto& r : rings) {
+            fds.push_back({r.fd, POLLIN, 0});
+        }
+        auto next = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.interval_ms);
+        while (running.load()) {
+            poll(fds.data(), fds.size(), 10);
+            for (auto& r : rings) {
+                drain(r);
+            }
+            if (std::chrono::steady_clock::now() >= next) {
+                migrate();
+                decay();
+                next += std::chrono::milliseconds(config.interval_ms);
+            }
+        }
+        for (auto& r : rings) {
+            ioctl(r.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+};
+
+#endif
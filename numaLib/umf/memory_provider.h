@@ -261,6 +261,23 @@ umf_result_t
 umfMemoryProviderAllocationMerge(umf_memory_provider_handle_t hProvider,
                                  void *lowPtr, void *highPtr, size_t totalSize);
 
+///
+/// @brief Moves an allocated range to another NUMA node. The pages already
+///        faulted in are migrated and the range stays bound to the new node.
+/// @param hProvider handle to the memory provider
+/// @param ptr page-aligned beginning of the range, or NULL (with \p size 0)
+///        to place the memory allocated by the provider from now on
+///        on \p target_node
+/// @param size size of the range
+/// @param target_node OS index of the destination NUMA node
+/// @return UMF_RESULT_SUCCESS on success or appropriate error code on failure
+///         UMF_RESULT_ERROR_INVALID_ALIGNMENT if ptr is not page-aligned.
+///         UMF_RESULT_ERROR_NOT_SUPPORTED if operation is not supported by this provider.
+///
+umf_result_t umfMemoryProviderMigrate(umf_memory_provider_handle_t hProvider,
+                                      void *ptr, size_t size,
+                                      unsigned target_node);
+
 #ifdef __cplusplus
 }
 #endif
@@ -78,6 +78,45 @@ static inline umf_disjoint_pool_params_t umfDisjointPoolParamsDefault(void) {
     return params;
 }
 
+/// @brief Configuration of NUMA-aware Disjoint Pool
+typedef struct umf_numa_disjoint_pool_params_t {
+    /// Configuration of the Disjoint Pool of every NUMA node
+    /// (and of the one using the provider the pool is created with).
+    umf_disjoint_pool_params_t NodeParams;
+
+    /// Maximum number of free chunks of one size class cached by a thread,
+    /// 0 disables the per-thread caches.
+    size_t ThreadCacheSize;
+
+    /// Only allocations up to this size are cached by the threads.
+    size_t ThreadCacheMaxSize;
+} umf_numa_disjoint_pool_params_t;
+
+/// @brief NUMA-aware Disjoint Pool: a set of size buckets per NUMA node,
+///        each backed by an OS memory provider bound to the node.
+///        Allocations are served from the node of the calling thread,
+///        small ones through a per-thread cache of free chunks.
+///        The provider the pool is created with is used only if the node
+///        of the thread cannot be determined.
+///        umfPoolByPtr() returns the internal pool of the node owning
+///        the pointer.
+umf_memory_pool_ops_t *umfNumaDisjointPoolOps(void);
+
+/// @brief Create default params struct for NUMA-aware disjoint pool
+static inline umf_numa_disjoint_pool_params_t
+umfNumaDisjointPoolParamsDefault(void) {
+    umf_numa_disjoint_pool_params_t params;
+    params.NodeParams = umfDisjointPoolParamsDefault();
+    params.NodeParams.SlabMinSize = 64 * 1024;
+    params.NodeParams.MaxPoolableSize = 2 * 1024 * 1024;
+    params.NodeParams.Capacity = 4;
+    params.NodeParams.Name = "numa_disjoint_pool";
+    params.ThreadCacheSize = 64;
+    params.ThreadCacheMaxSize = 1024;
+
+    return params;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,8 +33,14 @@ using namespace std;
 
 #include <stdbool.h>
 
+// The fields read on every allocation come first - the struct is allocated
+// cache line aligned, so they share a single cache line.
 typedef struct umf_memory_pool_t {
     void *pool_priv;
+
+    // Sampled allocation tracker, NULL if sampling was never enabled.
+    struct umf_pool_sampler_t *sampler;
+
     umf_memory_pool_ops_t ops;
     umf_pool_create_flags_t flags;
 
@@ -65,14 +71,24 @@ inline unsigned __attribute__((always_inline)) tid(){
 	return thread_id;
 }
 
+#define JEMALLOC_POOL_CACHE_LINE_SIZE 64
+
+// The fields read by umfFastJemallocMalloc()/umfFastJemallocFree() come first
+// and the cold ones after the tcaches[] array, so they never share a cache
+// line. The struct is allocated from the memory provider of the pool,
+// so it lives on the NUMA node of the memory it manages.
 typedef struct jemalloc_memory_pool_t {
-    umf_memory_provider_handle_t provider;
     unsigned arena_index; // base index of jemalloc arena
 	unsigned num_arenas; // range of associated indices
 	unsigned tcaches[MAX_JEMALLOC_THREADS];
+
+    umf_memory_provider_handle_t provider;
     // set to true if umfMemoryProviderFree() should never be called
     bool disable_provider_free;
-} jemalloc_memory_pool_t;
+    // size of the provider allocation holding the struct,
+    // 0 if it was allocated by the base allocator
+    size_t metadata_size;
+} __attribute__((aligned(JEMALLOC_POOL_CACHE_LINE_SIZE))) jemalloc_memory_pool_t;
 
 
 inline void* __attribute__((always_inline))
@@ -98,6 +114,10 @@ umfFastJemallocMalloc(umf_memory_pool_handle_t hPool, size_t size){
 
     //VALGRIND_DO_MEMPOOL_ALLOC(hPool, ptr, size);
 
+    if (hPool->sampler) {
+        umfPoolSampleAlloc(hPool, ptr, size, __builtin_return_address(0));
+    }
+
     return ptr;	
 }
 
@@ -109,6 +129,9 @@ umf_result_t umfFastJemallocFree(umf_memory_pool_handle_t hPool, void* ptr){
 
     if (ptr != NULL) {
         //VALGRIND_DO_MEMPOOL_FREE(hPool, ptr);
+        if (hPool->sampler) {
+            umfPoolSampleFree(hPool, ptr);
+        }
         dallocx(ptr, MALLOCX_TCACHE(je_pool->tcaches[tid()]));
     }
 
@@ -0,0 +1,82 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ */
+
+#ifndef UMF_LOCAL_NODE_MEMORY_POOL_H
+#define UMF_LOCAL_NODE_MEMORY_POOL_H 1
+
+#include <umf/base.h>
+#include <umf/memory_pool.h>
+#include <umf/memory_provider.h>
+#include <umf/providers/provider_os_memory.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Configuration of the local node pool. The pool creates a pool
+///        of the \p node_pool_ops type for every NUMA node of the host
+///        (on an OS memory provider bound to that node) and serves every
+///        allocation from the pool of the node the calling thread runs on.
+///        The memory provider the pool is created with backs the pool used
+///        by threads whose NUMA node cannot be determined.
+typedef struct umf_local_node_pool_params_t {
+    /// ops of the pools created for every NUMA node
+    umf_memory_pool_ops_t *node_pool_ops;
+    /// params passed to each of them
+    void *node_pool_params;
+    /// params of the OS memory providers of the nodes (their NUMA config
+    /// is overwritten), NULL means the defaults
+    umf_os_memory_provider_params_t *node_provider_params;
+    /// number of allocations a thread makes before its NUMA node is read
+    /// again (it is a syscall), 0 means on every allocation
+    unsigned node_refresh_period;
+} umf_local_node_pool_params_t;
+
+umf_memory_pool_ops_t *umfLocalNodePoolOps(void);
+
+/// @brief Get the NUMA node of the calling thread as seen by a local node
+///        pool (the node is re-read every node_refresh_period calls, shared
+///        with the allocations of the pool).
+/// @param hPool handle to a local node pool
+/// @param hNodePool [out] if not NULL, the pool allocations of the calling
+///        thread are served from (the default pool if -1 is returned)
+/// @return the NUMA node ID, or -1 if the node is unknown, there is no pool
+///         on it or \p hPool is not a local node pool
+int umfLocalNodePoolGetLocalNode(umf_memory_pool_handle_t hPool,
+                                 umf_memory_pool_handle_t *hNodePool);
+
+/// @brief Get the NUMA node whose pool owns the given pointer.
+/// @param hPool handle to a local node pool
+/// @param ptr pointer allocated from \p hPool
+/// @param hNodePool [out] if not NULL, the pool owning \p ptr (the default
+///        pool if -1 is returned)
+/// @return the NUMA node ID, or -1 if \p ptr belongs to the default pool
+///         or \p hPool is not a local node pool
+int umfLocalNodePoolGetNodeOf(umf_memory_pool_handle_t hPool, const void *ptr,
+                              umf_memory_pool_handle_t *hNodePool);
+
+/// @brief Create default params for the local node pool
+static inline umf_local_node_pool_params_t
+umfLocalNodePoolParamsDefault(umf_memory_pool_ops_t *node_pool_ops,
+                              void *node_pool_params) {
+    umf_local_node_pool_params_t params = {
+        node_pool_ops,    /* node_pool_ops */
+        node_pool_params, /* node_pool_params */
+        NULL,             /* node_provider_params */
+        256,              /* node_refresh_period */
+    };
+
+    return params;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UMF_LOCAL_NODE_MEMORY_POOL_H */
@@ -31,6 +31,8 @@
 
 #include <iostream>
 
+#include "numa_migrator.hpp"
+
 #ifndef NUMA_NODE_NUM
     #warning "NUMA NODES for je malloc handle is set to 2."
     #define NUMA_NODE_NUM 2
@@ -80,64 +82,123 @@ error_memspace:
 }
 
 static constexpr unsigned NUM_NODES = NUMA_NODE_NUM;
-static umf_memory_provider_handle_t NUMA_HANDLES[NUM_NODES]={};
-umf_memory_pool_handle_t jemalloc_pool[NUM_NODES]={};
+// Pools [NUM_NODES, 2 * NUM_NODES) are the weighted interleave pools
+// created by umf_weighted_init(), pool umf_weighted_node(i) favours node i.
+static constexpr unsigned NUM_POOLS = 2 * NUM_NODES;
+static umf_memory_provider_handle_t NUMA_HANDLES[NUM_POOLS]={};
+umf_memory_pool_handle_t jemalloc_pool[NUM_POOLS]={};
     
 static std::mutex umf_lock[NUM_NODES];
 
+// Size in bytes of an environment variable given in MB (0 if unset).
+static size_t umf_env_size_mb(const char *name) {
+    const char *val = getenv(name);
+    if (val == NULL) {
+        return 0;
+    }
+    return (size_t)strtoull(val, NULL, 10) * 1024 * 1024;
+}
+
+// True if addr belongs to one of the per-node pools (the weighted pools
+// interleave on purpose and are left alone). Needs tracked pools.
+static bool umf_numa_pool_owns(const void *addr) {
+    umf_memory_pool_handle_t pool = umfPoolByPtr(addr);
+    for (unsigned i = 0; pool && i < NUM_NODES; ++i) {
+        if (pool == jemalloc_pool[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Optional warm-up of the per-node pools, so page faults and mbind calls
+// happen here instead of inside the timed section of a benchmark:
+//   NUMA_POPULATE=1      pre-fault every extent right after it is bound
+//   NUMA_RESERVE_MB=<n>  map and bind <n> MB per node up front
+//                        (pre-faulted too with NUMA_POPULATE=1)
+// NUMA_MIGRATE=1 starts the page migrator (numa_migrator.hpp) on the pages
+// of the per-node pools.
 __attribute__((constructor))
 void umf_alloc_init() {
-    void* ptr = NULL;
-    umf_memspace_handle_t hMemspace= NULL;
-    umf_mempolicy_handle_t hPolicy = NULL;
+    const char *populate = getenv("NUMA_POPULATE");
+    size_t reserve_size = umf_env_size_mb("NUMA_RESERVE_MB");
+    const char *migrate = getenv("NUMA_MIGRATE");
+    bool migration = migrate && strcmp(migrate, "0") != 0;
+    // the migrator finds the pool of a sampled address by the UMF tracker
+    umf_pool_create_flags_t flags = migration ? 0 : UMF_POOL_CREATE_FLAG_DISABLE_TRACKING;
     for (unsigned i = 0; i < NUM_NODES; ++i) {
-        auto r = umfMemspaceCreateFromNumaArray(&i, 1, &hMemspace);
-        if (r != UMF_RESULT_SUCCESS) {
-            throw std::runtime_error("Could not create space");
+        umf_os_memory_provider_params_t params = umfOsMemoryProviderParamsDefault();
+        params.numa_list = &i;
+        params.numa_list_len = 1;
+        params.numa_mode = UMF_NUMA_MODE_BIND;
+        params.populate = populate && strcmp(populate, "0") != 0;
+        params.reserve_size = reserve_size;
+        auto h = umfMemoryProviderCreate(umfOsMemoryProviderOps(), &params, &NUMA_HANDLES[i]);
+        if (h != UMF_RESULT_SUCCESS) {
+            throw std::runtime_error("Could not create provider");
         }
-        auto policy = umfMempolicyCreate(UMF_MEMPOLICY_BIND, &hPolicy);
-        if (policy != UMF_RESULT_SUCCESS) {
-            throw std::runtime_error("Could not create policy");
+        auto pool = umfPoolCreate(umfJemallocPoolOps(), NUMA_HANDLES[i], NULL, flags, &jemalloc_pool[i]);
+        if(pool != UMF_RESULT_SUCCESS){
+            throw std::runtime_error("Could not create pool");
+        }
+    }
+    if (migration) {
+        if (numa_migrator::start(numa_migrator_config::from_env(), umf_numa_pool_owns)) {
+            // runs before the statics (registered earlier) and UMF are torn down
+            std::atexit(numa_migrator::stop);
+        } else {
+            std::cerr << "NUMA_MIGRATE: the page migrator could not be started" << std::endl;
         }
-        auto h = umfMemoryProviderCreateFromMemspace(hMemspace, hPolicy, &NUMA_HANDLES[i]);
+    }
+}
+
+// Pseudo node id (usable as the NodeID of numa<T, NodeID>) of the weighted
+// interleave pool whose local node is the given one.
+static constexpr unsigned umf_weighted_node(unsigned node) {
+    return NUM_NODES + node;
+}
+
+// Creates the weighted interleave pools: the pages of pool umf_weighted_node(i)
+// are interleaved local_weight:remote_weight between node i and every other
+// node (e.g. 3:1 local:remote for bandwidth-bound scans).
+void umf_weighted_init(unsigned local_weight, unsigned remote_weight) {
+    if (local_weight == 0 && remote_weight == 0) {
+        throw std::runtime_error("Weighted interleave needs a non-zero weight");
+    }
+    unsigned nodes[NUM_NODES];
+    for (unsigned i = 0; i < NUM_NODES; ++i) {
+        nodes[i] = i;
+    }
+    for (unsigned i = 0; i < NUM_NODES; ++i) {
+        unsigned id = umf_weighted_node(i);
+        if (jemalloc_pool[id]) {
+            continue;
+        }
+        umf_numa_split_partition_t partitions[NUM_NODES];
+        unsigned len = 0;
+        for (unsigned n = 0; n < NUM_NODES; ++n) {
+            unsigned weight = (n == i) ? local_weight : remote_weight;
+            if (weight) {
+                partitions[len++] = {weight, n};
+            }
+        }
+        umf_os_memory_provider_params_t params = umfOsMemoryProviderParamsDefault();
+        params.numa_list = nodes;
+        params.numa_list_len = NUM_NODES;
+        params.numa_mode = UMF_NUMA_MODE_INTERLEAVE;
+        params.partitions = partitions;
+        params.partitions_len = len;
+        auto h = umfMemoryProviderCreate(umfOsMemoryProviderOps(), &params, &NUMA_HANDLES[id]);
         if (h != UMF_RESULT_SUCCESS) {
-            throw std::runtime_error("Could not create policy");
+            throw std::runtime_error("Could not create provider");
         }
-        auto pool = umfPoolCreate(umfJemallocPoolOps(), NUMA_HANDLES[i], NULL,  UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &jemalloc_pool[i]);
+        auto pool = umfPoolCreate(umfJemallocPoolOps(), NUMA_HANDLES[id], NULL,  UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &jemalloc_pool[id]);
         if(pool != UMF_RESULT_SUCCESS){
             throw std::runtime_error("Could not create pool");
         }
-        umfMempolicyDestroy(hPolicy);
-        umfMemspaceDestroy(hMemspace);
-        // size_t sz;
-        // unsigned narenas;
-        // bool tcache;
-        // size_t tcache_max;
-    
-        // sz = sizeof(unsigned);
-        // printf("sz: %zu\n", sz);  
-        // mallctl("opt.narenas", &narenas, &sz, NULL, 0);
-       
-        // mallctl("opt.tcache_max", &tcache_max, &sz, NULL, 0);
-        // printf("Number of arenas: %u\n", narenas);
-        // printf("Thread cache enabled: %s\n", tcache ? "yes" : "no");
-        // printf("Thread cache max: %zu\n", tcache_max);
-
-        // ptr = umfPoolAlignedMalloc(jemalloc_pool[i], 100*1024*1024, sizeof(char));
-        // printf("Allocated %u bytes\n", 100*1024*1024);
-        // if(ptr == NULL){
-        //     throw std::runtime_error("Could not allocate pool");
-        // }
-        // for(int j = 0; j < 100*1024*1024; j+=4096){
-        //     ((char*)ptr)[j] = 'a';
-        // }
-        // if(umfPoolFree(jemalloc_pool[i], ptr) != UMF_RESULT_SUCCESS){
-        //     throw std::runtime_error("Could not free pool");
-        // }
     }
 }
 
-
 void* umf_alloc(unsigned NodeId, size_t size, size_t allign){
     // umf_lock[NodeId].lock();
     void *ptr = NULL;
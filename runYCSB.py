@@ -26,6 +26,7 @@ CORE OPTIONS:
     -d, --output PATH      Output directory (Default: ROOT_DIR/Result).
     --graph                Generate plots after the run finishes.
     --workload STR [STR..] One or more workload configs (Default: A-50-50-50,D-100-0-50)
+    --nodes N              Number of node shards of the tables (Default: 2).
 
 WORKFLOW EXAMPLE:
     python3 runYCSB.py --ROOT_DIR=$SCRATCH/NUMATyping --numafy --UMF --workload A-50-50-50 B-100-0-0
@@ -89,7 +90,7 @@ def compile_experiment(UMF: bool, do_numafy: bool, root_dir: str, jemalloc_root:
     
     subprocess.run(f"make -C {experiment_folder} {make_vars}", shell=True, check=True)
 
-def run_experiment(output_csv: Path, experiment_folder: str, workload: str) -> None:
+def run_experiment(output_csv: Path, latency_csv: Path, experiment_folder: str, workload: str, nodes: int) -> None:
     max_node = os.environ.get("MAX_NODE_ID", "0")
     
     if max_node == "0":
@@ -101,12 +102,21 @@ def run_experiment(output_csv: Path, experiment_folder: str, workload: str) -> N
 
     cmd = (f'cd {experiment_folder} && python3 meta.py '
            f'numactl --cpunodebind=0,7 --membind=0,7 ./bin/ycsb '
+           f'--latencies="{latency_csv}" --nodes={nodes} '
            f'--meta th_config:numa:regular --meta DS_config:numa:regular '
            f'--meta t:128 --meta b:266600 --meta w:{workload} --meta u:7200 '
-           f'--meta k:200000000 --meta i:20 --meta a:1000 >> "{output_csv}"')
+           f'--meta k:200000000 --meta i:20 --meta a:1000')
     
     print(f"--- Running Experiment ---\n{cmd}\n")
-    subprocess.run(cmd, shell=True, check=True)
+    # the CSV has its own header, the one printed by every run is dropped
+    with open(output_csv, "a") as out, \
+            subprocess.Popen(cmd, shell=True, stdout=subprocess.PIPE, text=True) as proc:
+        for line in proc.stdout:
+            if not line.startswith("Date, "):
+                out.write(line)
+                out.flush()
+    if proc.returncode:
+        raise subprocess.CalledProcessError(proc.returncode, cmd)
 
 # ============================================================================
 # Main
@@ -125,6 +135,7 @@ if __name__ == "__main__":
     parser.add_argument('--graph', action='store_true')
     parser.add_argument('--jemalloc-root')
     parser.add_argument('--workload', type=str, nargs='+', default=["A-50-50-50,D-100-0-50"]) 
+    parser.add_argument('--nodes', type=int, default=2)
 
     try:
         args = parser.parse_args()
@@ -161,11 +172,14 @@ if __name__ == "__main__":
             # Define all 4 output paths
             out_exp_path = OUT_BASE / an_folder / "ycsb_experiments.csv"
             out_wl_path = OUT_BASE / an_folder / safe_filename
+            # the latency percentiles of every run, with their own header
+            out_lat_path = OUT_BASE / an_folder / "ycsb_latencies.csv"
             graph_exp_path = GRAPH_BASE / an_folder / "ycsb_experiments.csv"
             graph_wl_path = GRAPH_BASE / an_folder / safe_filename
             
-            # 1. Dynamic Header Formatting
-            base_header = "Date, Time, num_tables, num_threads, thread_config, DS_config, buckets, workload, duration, num_keys, locality, interval, ops_node0, ops_node1, total_ops\n"
+            # 1. Dynamic Header Formatting (one ops column per node shard)
+            ops_cols = "".join([f"ops_node{i}, " for i in range(args.nodes)])
+            base_header = f"Date, Time, num_tables, num_threads, thread_config, DS_config, buckets, workload, duration, num_keys, locality, interval, {ops_cols}total_ops\n"
             
             workload_count = wl.count(",") + 1
             if workload_count > 1:
@@ -180,13 +194,17 @@ if __name__ == "__main__":
                     exp_path.parent.mkdir(parents=True, exist_ok=True)
                     with exp_path.open("w") as f:
                         f.write(header_to_write)
+                else:
+                    with exp_path.open("r") as f:
+                        if f.readline() != header_to_write:
+                            print(f"Warning: {exp_path} has a different header (number of nodes or workloads)")
 
             # Note the number of lines in the main experiment file BEFORE running
             with open(out_exp_path, "r") as f:
                 lines_before_run = len(f.readlines())
 
             # Path 1: Append to main ycsb_experiments.csv in the Result directory
-            run_experiment(out_exp_path.absolute(), EXPERIMENT_FOLDER, wl)
+            run_experiment(out_exp_path.absolute(), out_lat_path.absolute(), EXPERIMENT_FOLDER, wl, args.nodes)
 
             # Extract ONLY the newest results
             with open(out_exp_path, "r") as f:
@@ -218,6 +236,7 @@ if __name__ == "__main__":
                 subprocess.run(f'python3 {plot_script} --AN {args.AN}', shell=True)
                 
             print(f"COMPLETE. Primary Results for {wl} appended to: {out_exp_path}")
+            print(f"Latency percentiles appended to: {out_lat_path}")
 
     except subprocess.CalledProcessError as e:
         print(f"\n[FATAL ERROR] Experiment failed during execution (Exit Code: {e.returncode})")
@@ -15,10 +15,16 @@
 #include <umf/pools/pool_scalable.h>
 #include <umf/providers/provider_os_memory.h>
 
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <numeric>
 
+#ifdef UMF_BENCH_NUMA
+#include <numa.h>
+#endif
+
 struct bench_params {
     // bench_params() = default;
     size_t n_repeats = 5;
@@ -90,6 +96,287 @@ static void mt_alloc_free(poolCreateExtParams params,
               << std::endl;
 }
 
+#ifdef UMF_BENCH_NUMA
+
+// NUMA scenarios: n_threads_per_node threads are pinned to each node and
+// the allocators are compared on the placement patterns of our benchmarks.
+// The results are reported per operation (an allocation and its free),
+// so the allocators may run different numbers of iterations.
+
+struct numa_bench_params {
+    size_t n_repeats = 5;
+    size_t n_iterations = 50000;
+    size_t n_threads_per_node = 4;
+};
+
+static std::vector<unsigned> numa_nodes() {
+    std::vector<unsigned> nodes;
+    for (int n = 0; n <= numa_max_node(); n++) {
+        if (numa_bitmask_isbitset(numa_all_nodes_ptr, (unsigned)n)) {
+            nodes.push_back((unsigned)n);
+        }
+    }
+    return nodes;
+}
+
+// placement is not controlled - first touch by the allocating thread
+struct glibc_allocator {
+    static constexpr const char *name = "glibc malloc";
+    void *alloc(unsigned, size_t size) { return malloc(size); }
+    void free(unsigned, void *ptr, size_t) { ::free(ptr); }
+};
+
+// a separate mapping per allocation
+struct numa_onnode_allocator {
+    static constexpr const char *name = "numa_alloc_onnode";
+    void *alloc(unsigned node, size_t size) {
+        return numa_alloc_onnode(size, (int)node);
+    }
+    void free(unsigned, void *ptr, size_t size) {
+        if (ptr) {
+            numa_free(ptr, size);
+        }
+    }
+};
+
+// a pool (with an OS provider bound to the node) per node,
+// indexed by the node ID
+struct umf_node_pools {
+    umf_node_pools(umf_memory_pool_ops_t *pool_ops,
+                   const std::vector<unsigned> &nodes) {
+        pools.resize(nodes.back() + 1);
+        for (auto node : nodes) {
+            auto osParams = umfOsMemoryProviderParamsDefault();
+            osParams.numa_list = &node;
+            osParams.numa_list_len = 1;
+            osParams.numa_mode = UMF_NUMA_MODE_BIND;
+            pools[node] = poolCreateExtUnique(poolCreateExtParams{
+                pool_ops, nullptr, umfOsMemoryProviderOps(), &osParams});
+        }
+    }
+
+    std::vector<std::shared_ptr<umf_memory_pool_t>> pools;
+};
+
+#if defined(UMF_BUILD_LIBUMF_POOL_JEMALLOC)
+struct umf_jemalloc_allocator : umf_node_pools {
+    static constexpr const char *name = "umfPoolMalloc (jemalloc_pool)";
+    umf_jemalloc_allocator(const std::vector<unsigned> &nodes)
+        : umf_node_pools(umfJemallocPoolOps(), nodes) {}
+    void *alloc(unsigned node, size_t size) {
+        return umfPoolMalloc(pools[node].get(), size);
+    }
+    void free(unsigned node, void *ptr, size_t) {
+        umfPoolFree(pools[node].get(), ptr);
+    }
+};
+
+struct umf_fast_jemalloc_allocator : umf_node_pools {
+    static constexpr const char *name = "umfFastJemallocMalloc";
+    umf_fast_jemalloc_allocator(const std::vector<unsigned> &nodes)
+        : umf_node_pools(umfJemallocPoolOps(), nodes) {}
+    void *alloc(unsigned node, size_t size) {
+        return umfFastJemallocMalloc(pools[node].get(), size);
+    }
+    void free(unsigned node, void *ptr, size_t) {
+        umfFastJemallocFree(pools[node].get(), ptr);
+    }
+};
+#endif
+
+template <typename T>
+static void print_numa_results(const char *scenario, const char *allocator,
+                               const std::vector<T> &values, size_t n_ops,
+                               const std::vector<size_t> &numFailures) {
+    // values are in [us] per thread
+    std::cout << scenario << " " << allocator
+              << ": mean: " << umf_bench::mean(values) * 1000.0 / n_ops
+              << " [ns/op] std_dev: "
+              << umf_bench::std_dev(values) * 1000.0 / n_ops << " [ns/op]"
+              << " (total alloc failures: "
+              << std::accumulate(numFailures.begin(), numFailures.end(), 0ULL)
+              << ")" << std::endl;
+}
+
+// Every thread allocates n_iterations blocks of the given size(s)
+// on the node (thread node + node_offset), touches them and frees them.
+// With sizes.size() > 1 the odd blocks are freed before the even ones
+// to fragment the heap.
+template <typename Allocator>
+static void numa_alloc_free(Allocator &allocator, const char *scenario,
+                            const std::vector<unsigned> &nodes,
+                            size_t node_offset,
+                            const std::vector<size_t> &sizes,
+                            const numa_bench_params &bench) {
+    size_t n_threads = bench.n_threads_per_node * nodes.size();
+    std::vector<std::vector<void *>> allocs(n_threads);
+    std::vector<size_t> numFailures(n_threads);
+    for (auto &v : allocs) {
+        v.reserve(bench.n_iterations);
+    }
+
+    auto thread_node = [&](size_t thread_id) {
+        return nodes[thread_id % nodes.size()];
+    };
+    auto mem_node = [&](size_t thread_id) {
+        return nodes[(thread_id + node_offset) % nodes.size()];
+    };
+    auto size_of = [&](size_t i) { return sizes[(i * 7) % sizes.size()]; };
+
+    auto values = umf_bench::measure<std::chrono::microseconds>(
+        bench.n_repeats, n_threads,
+        [&](size_t thread_id) {
+            numa_run_on_node((int)thread_node(thread_id));
+        },
+        [&](size_t thread_id) {
+            unsigned node = mem_node(thread_id);
+            auto &v = allocs[thread_id];
+            for (size_t i = 0; i < bench.n_iterations; i++) {
+                void *ptr = allocator.alloc(node, size_of(i));
+                if (ptr) {
+                    *static_cast<char *>(ptr) = 1;
+                } else {
+                    numFailures[thread_id]++;
+                }
+                v.push_back(ptr);
+            }
+
+            size_t first = (sizes.size() > 1) ? 1 : 0;
+            for (size_t i = first; i < bench.n_iterations; i += 1 + first) {
+                allocator.free(node, v[i], size_of(i));
+            }
+            for (size_t i = 0; first && i < bench.n_iterations; i += 2) {
+                allocator.free(node, v[i], size_of(i));
+            }
+
+            // clear the vector as this function might be called multiple times
+            v.clear();
+        });
+
+    print_numa_results(scenario, Allocator::name, values, bench.n_iterations,
+                       numFailures);
+}
+
+// Producers on the first node allocate (on their node) and hand the blocks
+// over in batches to the paired consumers on the second node, which free
+// them - the cross-node free pattern of the delegated/remote updates.
+template <typename Allocator>
+static void numa_producer_consumer(Allocator &allocator,
+                                   const std::vector<unsigned> &nodes,
+                                   size_t size,
+                                   const numa_bench_params &bench) {
+    constexpr size_t batch = 64;
+    unsigned producer_node = nodes[0];
+    unsigned consumer_node = nodes[1 % nodes.size()];
+
+    struct alignas(64) channel {
+        std::vector<void *> ptrs;
+        std::atomic<size_t> published{0};
+    };
+
+    size_t n_pairs = bench.n_threads_per_node;
+    std::vector<channel> channels(n_pairs);
+    std::vector<size_t> numFailures(2 * n_pairs);
+    for (auto &c : channels) {
+        c.ptrs.resize(bench.n_iterations);
+    }
+
+    // even threads are the producers, odd ones the consumers
+    auto values = umf_bench::measure<std::chrono::microseconds>(
+        bench.n_repeats, 2 * n_pairs,
+        [&](size_t thread_id) {
+            if (thread_id % 2 == 0) {
+                channels[thread_id / 2].published.store(0);
+                numa_run_on_node((int)producer_node);
+            } else {
+                numa_run_on_node((int)consumer_node);
+            }
+        },
+        [&](size_t thread_id) {
+            auto &c = channels[thread_id / 2];
+            if (thread_id % 2 == 0) {
+                for (size_t i = 0; i < bench.n_iterations; i++) {
+                    void *ptr = allocator.alloc(producer_node, size);
+                    if (ptr) {
+                        *static_cast<char *>(ptr) = 1;
+                    } else {
+                        numFailures[thread_id]++;
+                    }
+                    c.ptrs[i] = ptr;
+                    if ((i + 1) % batch == 0 || i + 1 == bench.n_iterations) {
+                        c.published.store(i + 1, std::memory_order_release);
+                    }
+                }
+                return;
+            }
+
+            size_t i = 0;
+            while (i < bench.n_iterations) {
+                size_t published = c.published.load(std::memory_order_acquire);
+                if (published == i) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (; i < published; i++) {
+                    allocator.free(producer_node, c.ptrs[i], size);
+                }
+            }
+        });
+
+    print_numa_results("producer_consumer", Allocator::name, values,
+                       bench.n_iterations, numFailures);
+}
+
+template <typename Allocator>
+static void numa_scenarios(Allocator &allocator,
+                           const std::vector<unsigned> &nodes,
+                           const numa_bench_params &bench) {
+    const std::vector<size_t> mixed_sizes = {16,  24,   48,   64,   128,
+                                             200, 512, 1024, 4096, 16384};
+
+    numa_alloc_free(allocator, "local", nodes, 0, {64}, bench);
+    numa_alloc_free(allocator, "remote", nodes, 1, {64}, bench);
+    numa_producer_consumer(allocator, nodes, 64, bench);
+    numa_alloc_free(allocator, "mixed_sizes", nodes, 0, mixed_sizes, bench);
+}
+
+static void numa_benchmarks() {
+    if (numa_available() < 0) {
+        std::cout << "skipping NUMA scenarios (libnuma is not available)"
+                  << std::endl;
+        return;
+    }
+
+    auto nodes = numa_nodes();
+    if (nodes.size() < 2) {
+        std::cout << "NUMA scenarios: only one node, remote = local"
+                  << std::endl;
+    }
+
+    numa_bench_params bench;
+
+    glibc_allocator glibc;
+    numa_scenarios(glibc, nodes, bench);
+
+#if defined(UMF_BUILD_LIBUMF_POOL_JEMALLOC)
+    umf_jemalloc_allocator jemalloc(nodes);
+    numa_scenarios(jemalloc, nodes, bench);
+
+    umf_fast_jemalloc_allocator fast_jemalloc(nodes);
+    numa_scenarios(fast_jemalloc, nodes, bench);
+#else
+    std::cout << "skipping jemalloc_pool NUMA scenarios" << std::endl;
+#endif
+
+    // every allocation is an mmap() - fewer iterations
+    numa_bench_params onnode_bench = bench;
+    onnode_bench.n_iterations /= 10;
+    numa_onnode_allocator onnode;
+    numa_scenarios(onnode, nodes, onnode_bench);
+}
+
+#endif /* UMF_BENCH_NUMA */
+
 int main() {
     auto osParams = umfOsMemoryProviderParamsDefault();
 
@@ -126,6 +413,12 @@ int main() {
     std::cout << "skipping disjoint_pool mt_alloc_free" << std::endl;
 #endif
 
+#ifdef UMF_BENCH_NUMA
+    numa_benchmarks();
+#else
+    std::cout << "skipping NUMA scenarios" << std::endl;
+#endif
+
     // ctest looks for "PASSED" in the output
     std::cout << "PASSED" << std::endl;
 
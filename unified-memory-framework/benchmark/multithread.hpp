@@ -36,9 +36,12 @@ typename TimeUnit::rep measure(F &&func) {
     return duration.count();
 }
 
-/* Measure time of execution of run_workload(thread_id) function. */
-template <typename TimeUnit, typename F>
-auto measure(size_t iterations, size_t concurrency, F &&run_workload) {
+/* Measure time of execution of run_workload(thread_id) function.
+ * setup(thread_id) is called (not measured) by each thread before it starts,
+ * e.g. to pin the thread to a NUMA node. */
+template <typename TimeUnit, typename S, typename F>
+auto measure(size_t iterations, size_t concurrency, S &&setup,
+             F &&run_workload) {
     if (iterations == 1) {
         throw std::runtime_error("iterations must be > 1");
     }
@@ -50,6 +53,7 @@ auto measure(size_t iterations, size_t concurrency, F &&run_workload) {
         std::vector<ResultsType> iteration_results(concurrency);
         umf_test::syncthreads_barrier syncthreads(concurrency);
         umf_test::parallel_exec(concurrency, [&](size_t id) {
+            setup(id);
             syncthreads();
 
             iteration_results[id] =
@@ -66,6 +70,14 @@ auto measure(size_t iterations, size_t concurrency, F &&run_workload) {
     return results;
 }
 
+/* Measure time of execution of run_workload(thread_id) function. */
+template <typename TimeUnit, typename F>
+auto measure(size_t iterations, size_t concurrency, F &&run_workload) {
+    return measure<TimeUnit>(
+        iterations, concurrency, [](size_t) {},
+        std::forward<F>(run_workload));
+}
+
 template <typename T> T min(const std::vector<T> &values) {
     return *std::min_element(values.begin(), values.end());
 }
@@ -8,8 +8,11 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 
 #ifndef _WIN32
+#include <time.h>
 #include <unistd.h>
 #endif
 
@@ -365,6 +368,259 @@ UBENCH_EX(simple, scalable_pool_with_os_memory_provider) {
 }
 #endif /* (defined UMF_POOL_SCALABLE_ENABLED) */
 
+////////////////// PER-SIZE-CLASS LATENCY HISTOGRAMS
+
+// ubench reports only the mean time of a whole batch of allocations,
+// so the tail latencies of single malloc/free calls (e.g. a tcache refill
+// or a call into the provider) are measured separately: every call is timed
+// and recorded in a log-linear histogram (16 sub-buckets per power of two,
+// so the reported values are within 6.25%) per size class.
+
+#define LATENCY_N_ALLOCS 10000
+#define LATENCY_N_ROUNDS 10
+
+#define LATENCY_SUB_BUCKETS_LOG2 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKETS_LOG2)
+#define LATENCY_N_BUCKETS                                                      \
+    ((64 - LATENCY_SUB_BUCKETS_LOG2 + 1) * LATENCY_SUB_BUCKETS)
+
+static const size_t Latency_sizes[] = {8,   16,  32,   64,  128,
+                                       256, 512, 1024, 4096};
+#define LATENCY_N_SIZES (sizeof(Latency_sizes) / sizeof(Latency_sizes[0]))
+
+typedef struct latency_hist_t {
+    uint64_t counts[LATENCY_N_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} latency_hist_t;
+
+typedef struct latency_stats_t {
+    latency_hist_t malloc_hist;
+    latency_hist_t free_hist;
+} latency_stats_t;
+
+// ubench_ns() reads CLOCK_REALTIME with a raw syscall on Linux -
+// too slow to time a single call
+static uint64_t latency_now_ns(void) {
+#ifdef _WIN32
+    return (uint64_t)ubench_ns();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// the cost of reading the clock, subtracted from every measurement
+static uint64_t latency_timer_overhead(void) {
+    uint64_t min = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t t0 = latency_now_ns();
+        uint64_t t1 = latency_now_ns();
+        if (t1 - t0 < min) {
+            min = t1 - t0;
+        }
+    }
+    return min;
+}
+
+static size_t latency_bucket(uint64_t ns) {
+    if (ns < LATENCY_SUB_BUCKETS) {
+        return (size_t)ns;
+    }
+
+    unsigned msb = 0;
+    for (uint64_t v = ns; v > 1; v >>= 1) {
+        msb++;
+    }
+
+    unsigned shift = msb - LATENCY_SUB_BUCKETS_LOG2;
+    size_t sub = (size_t)(ns >> shift) & (LATENCY_SUB_BUCKETS - 1);
+    return (shift + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+// the highest value falling into the bucket
+static uint64_t latency_bucket_value(size_t bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    unsigned shift = (unsigned)(bucket / LATENCY_SUB_BUCKETS) - 1;
+    uint64_t sub = bucket % LATENCY_SUB_BUCKETS;
+    return ((LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+static void latency_record(latency_hist_t *hist, uint64_t ns) {
+    hist->counts[latency_bucket(ns)]++;
+    hist->total++;
+    if (ns > hist->max) {
+        hist->max = ns;
+    }
+}
+
+static uint64_t latency_percentile(const latency_hist_t *hist,
+                                   double percentile) {
+    uint64_t rank = (uint64_t)((double)hist->total * percentile / 100.0);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t count = 0;
+    for (size_t i = 0; i < LATENCY_N_BUCKETS; i++) {
+        count += hist->counts[i];
+        if (count >= rank) {
+            uint64_t value = latency_bucket_value(i);
+            return (value < hist->max) ? value : hist->max;
+        }
+    }
+
+    return hist->max;
+}
+
+static void latency_print(const char *name, latency_stats_t *stats) {
+    printf("latency [ns] of %s (malloc | free):\n", name);
+    printf("%8s | %8s %8s %8s %8s | %8s %8s %8s %8s\n", "size", "p50", "p99",
+           "p99.9", "max", "p50", "p99", "p99.9", "max");
+
+    for (size_t s = 0; s < LATENCY_N_SIZES; s++) {
+        latency_hist_t *m = &stats[s].malloc_hist;
+        latency_hist_t *f = &stats[s].free_hist;
+        printf("%8zu | %8llu %8llu %8llu %8llu | %8llu %8llu %8llu %8llu\n",
+               Latency_sizes[s],
+               (unsigned long long)latency_percentile(m, 50.0),
+               (unsigned long long)latency_percentile(m, 99.0),
+               (unsigned long long)latency_percentile(m, 99.9),
+               (unsigned long long)m->max,
+               (unsigned long long)latency_percentile(f, 50.0),
+               (unsigned long long)latency_percentile(f, 99.0),
+               (unsigned long long)latency_percentile(f, 99.9),
+               (unsigned long long)f->max);
+    }
+}
+
+// Every round allocates LATENCY_N_ALLOCS blocks of the size class and frees
+// them in the same order, timing every call. The first round is a warmup.
+static void do_latency_benchmark(const char *name, malloc_t malloc_f,
+                                 free_t free_f, void *provider) {
+    alloc_t *array = alloc_array(LATENCY_N_ALLOCS);
+    latency_stats_t *stats = calloc(LATENCY_N_SIZES, sizeof(*stats));
+    if (stats == NULL) {
+        perror("calloc() failed");
+        exit(-1);
+    }
+
+    uint64_t overhead = latency_timer_overhead();
+
+    for (size_t s = 0; s < LATENCY_N_SIZES; s++) {
+        size_t size = Latency_sizes[s];
+        for (int round = 0; round <= LATENCY_N_ROUNDS; round++) {
+            for (size_t i = 0; i < LATENCY_N_ALLOCS; i++) {
+                uint64_t t0 = latency_now_ns();
+                array[i].ptr = malloc_f(provider, size, 0);
+                uint64_t t1 = latency_now_ns();
+                if (array[i].ptr == NULL) {
+                    fprintf(stderr, "error: %s: allocation failed\n", name);
+                    exit(-1);
+                }
+                if (round) {
+                    uint64_t ns = t1 - t0;
+                    latency_record(&stats[s].malloc_hist,
+                                   ns > overhead ? ns - overhead : 0);
+                }
+            }
+
+            for (size_t i = 0; i < LATENCY_N_ALLOCS; i++) {
+                uint64_t t0 = latency_now_ns();
+                free_f(provider, array[i].ptr, size);
+                uint64_t t1 = latency_now_ns();
+                if (round) {
+                    uint64_t ns = t1 - t0;
+                    latency_record(&stats[s].free_hist,
+                                   ns > overhead ? ns - overhead : 0);
+                }
+            }
+        }
+    }
+
+    latency_print(name, stats);
+
+    free(stats);
+    free(array);
+}
+
+#if (defined UMF_BUILD_LIBUMF_POOL_JEMALLOC)
+static void *w_umfFastJemallocMalloc(void *provider, size_t size,
+                                     size_t alignment) {
+    (void)alignment; // unused
+    umf_memory_pool_handle_t hPool = (umf_memory_pool_handle_t)provider;
+    return umfFastJemallocMalloc(hPool, size);
+}
+
+static void w_umfFastJemallocFree(void *provider, void *ptr, size_t size) {
+    (void)size; // unused
+    umf_memory_pool_handle_t hPool = (umf_memory_pool_handle_t)provider;
+    umfFastJemallocFree(hPool, ptr);
+}
+#endif /* (defined UMF_BUILD_LIBUMF_POOL_JEMALLOC) */
+
+static umf_memory_pool_handle_t latency_pool_create(umf_memory_pool_ops_t *ops,
+                                                    void *params) {
+    umf_result_t umf_result;
+    umf_memory_provider_handle_t os_memory_provider = NULL;
+    umf_result = umfMemoryProviderCreate(umfOsMemoryProviderOps(),
+                                         &UMF_OS_MEMORY_PROVIDER_PARAMS,
+                                         &os_memory_provider);
+    if (umf_result != UMF_RESULT_SUCCESS) {
+        fprintf(stderr, "error: umfMemoryProviderCreate() failed\n");
+        exit(-1);
+    }
+
+    umf_memory_pool_handle_t pool;
+    umf_result = umfPoolCreate(ops, os_memory_provider, params,
+                               UMF_POOL_CREATE_FLAG_OWN_PROVIDER, &pool);
+    if (umf_result != UMF_RESULT_SUCCESS) {
+        fprintf(stderr, "error: umfPoolCreate() failed\n");
+        exit(-1);
+    }
+
+    return pool;
+}
+
+static void latency_benchmarks(void) {
+    umf_memory_pool_handle_t pool;
+    (void)pool; // unused if no pool is enabled
+
+    do_latency_benchmark("glibc_malloc", glibc_malloc, glibc_free, NULL);
+
+#if (defined UMF_BUILD_LIBUMF_POOL_JEMALLOC)
+    pool = latency_pool_create(umfJemallocPoolOps(), NULL);
+    do_latency_benchmark("jemalloc_pool (umfPoolMalloc/umfPoolFree)",
+                         w_umfPoolMalloc, w_umfPoolFree, pool);
+    do_latency_benchmark("jemalloc_pool (umfFastJemallocMalloc/Free)",
+                         w_umfFastJemallocMalloc, w_umfFastJemallocFree, pool);
+    umfPoolDestroy(pool);
+#endif
+
+#if (defined UMF_BUILD_LIBUMF_POOL_DISJOINT)
+    umf_disjoint_pool_params_t disjoint_params = umfDisjointPoolParamsDefault();
+    disjoint_params.SlabMinSize = 64 * 1024;
+    disjoint_params.MaxPoolableSize = 2 * 1024 * 1024;
+    disjoint_params.Capacity = 4;
+    disjoint_params.MinBucketSize = 8;
+    pool = latency_pool_create(umfDisjointPoolOps(), &disjoint_params);
+    do_latency_benchmark("disjoint_pool", w_umfPoolMalloc, w_umfPoolFree,
+                         pool);
+    umfPoolDestroy(pool);
+#endif
+
+#if (defined UMF_POOL_SCALABLE_ENABLED)
+    pool = latency_pool_create(umfScalablePoolOps(), NULL);
+    do_latency_benchmark("scalable_pool", w_umfPoolMalloc, w_umfPoolFree,
+                         pool);
+    umfPoolDestroy(pool);
+#endif
+}
+
 #if (defined UMF_BUILD_LIBUMF_POOL_DISJOINT &&                                 \
      defined UMF_BUILD_LEVEL_ZERO_PROVIDER && defined UMF_BUILD_GPU_TESTS)
 static void do_ipc_get_put_benchmark(alloc_t *allocs, size_t num_allocs,
@@ -508,7 +764,25 @@ err_destroy_context:
 
 // TODO add IPC benchmark for CUDA
 
-UBENCH_MAIN()
+UBENCH_STATE();
+
+int main(int argc, const char *const argv[]) {
+    int ret = ubench_main(argc, argv);
+
+    // the latency histograms are not ubench benchmarks - skip them
+    // if only some (or none) of the benchmarks were requested
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--filter=", 9) == 0 ||
+            strcmp(argv[i], "--list-benchmarks") == 0 ||
+            strcmp(argv[i], "--help") == 0) {
+            return ret;
+        }
+    }
+
+    latency_benchmarks();
+
+    return ret;
+}
 
 #if defined(_MSC_VER)
 #pragma warning(pop)
@@ -74,6 +74,15 @@ typedef struct coarse_memory_provider_params_t {
 
     /// Destroy upstream_memory_provider in finalize().
     bool destroy_upstream_memory_provider;
+
+    /// Number of per-thread shards caching freed blocks in size-class bins.
+    /// A block freed with a known size is parked in the shard of the calling
+    /// thread and handed out again without taking the global lock; it is
+    /// coalesced with its neighbours only when the shard overflows or
+    /// the provider runs out of free blocks (deferred coalescing).
+    /// Set it to the number of CPUs (or NUMA nodes) sharing the provider.
+    /// 0 disables the shards (every operation takes the global lock).
+    size_t num_shards;
 } coarse_memory_provider_params_t;
 
 /// @brief Coarse Memory Provider stats (TODO move to CTL)
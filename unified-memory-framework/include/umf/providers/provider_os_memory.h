@@ -8,6 +8,8 @@
 #ifndef UMF_OS_MEMORY_PROVIDER_H
 #define UMF_OS_MEMORY_PROVIDER_H
 
+#include <stdbool.h>
+
 #include "umf/memory_provider.h"
 
 #ifdef __cplusplus
@@ -34,6 +36,10 @@ typedef enum umf_numa_mode_t {
 
     /// Interleaves memory allocations across the set of nodes specified in
     /// nodemask. Nodemask must specify at least one node.
+    /// If umf_numa_split_partition_t partitions are passed in
+    /// umf_os_memory_provider_params_t, parts are interleaved by weight
+    /// (e.g. weights 3 and 1 place 3 parts on the first node for every part
+    /// on the second one).
     UMF_NUMA_MODE_INTERLEAVE,
 
     /// Specifies preferred node for allocation. If allocation cannot be
@@ -82,9 +88,19 @@ typedef struct umf_os_memory_provider_params_t {
     size_t part_size;
 
     /// ordered list of the partitions for the split mode
+    /// or the weights of the nodes for the interleave mode
+    /// (the part size defaults to the page size then)
     umf_numa_split_partition_t *partitions;
     /// len of the partitions array
     unsigned partitions_len;
+
+    /// pre-fault the pages of each allocation right after they are bound
+    /// to their NUMA nodes, so page faults do not happen on first touch
+    bool populate;
+    /// size of the memory mapped, bound (and pre-faulted if populate is set)
+    /// at provider creation - allocations are carved out of it first,
+    /// before any new memory is mapped. 0 means no reservation.
+    size_t reserve_size;
 } umf_os_memory_provider_params_t;
 
 /// @brief OS Memory Provider operation results
@@ -97,6 +113,8 @@ typedef enum umf_os_memory_provider_native_error {
     UMF_OS_RESULT_ERROR_PURGE_LAZY_FAILED,     ///< Lazy purging failed
     UMF_OS_RESULT_ERROR_PURGE_FORCE_FAILED,    ///< Force purging failed
     UMF_OS_RESULT_ERROR_TOPO_DISCOVERY_FAILED, ///< HWLOC topology discovery failed
+    UMF_OS_RESULT_ERROR_POPULATE_FAILED,       ///< Pre-faulting pages failed
+    UMF_OS_RESULT_ERROR_MIGRATE_FAILED, ///< Moving pages to NUMA node failed
 } umf_os_memory_provider_native_error_t;
 
 umf_memory_provider_ops_t *umfOsMemoryProviderOps(void);
@@ -113,7 +131,9 @@ umfOsMemoryProviderParamsDefault(void) {
         UMF_NUMA_MODE_DEFAULT, /* numa_mode */
         0,                     /* part_size */
         NULL,                  /* partitions */
-        0};                    /* partitions_len*/
+        0,                     /* partitions_len*/
+        false,                 /* populate */
+        0};                    /* reserve_size */
 
     return params;
 }
@@ -16,11 +16,61 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <umf/providers/provider_os_memory.h>
 
 #include "base_alloc_global.h"
 #include "memory_pool_internal.h"
+#include "memory_pool_sampling.h"
 #include "memory_provider_internal.h"
 #include "provider_tracking.h"
+#include "utils_common.h"
+#include "utils_concurrency.h"
+#include "utils_log.h"
+
+// The pool handle is read on every allocation, so - like the jemalloc pool
+// metadata - it is allocated from the memory provider of the pool and lands
+// on the same NUMA node(s) as the pool's memory instead of the node of the
+// creating thread. Only the OS memory provider is known to return host
+// memory, with any other provider the base allocator is used.
+static umf_memory_pool_handle_t
+pool_handle_alloc(umf_memory_provider_handle_t provider) {
+    umf_memory_pool_handle_t pool = NULL;
+
+    if (umfMemoryProviderHasOps(provider, umfOsMemoryProviderOps()) &&
+        !umfIsFreeOpDefault(provider)) {
+        size_t size = ALIGN_UP(sizeof(umf_memory_pool_t),
+                               utils_get_page_size());
+        void *ptr = NULL;
+        umf_result_t ret = umfMemoryProviderAlloc(provider, size, 0, &ptr);
+        if (ret == UMF_RESULT_SUCCESS && ptr) {
+            pool = ptr;
+            memset(pool, 0, sizeof(*pool));
+            pool->handle_size = size;
+            return pool;
+        }
+
+        LOG_DEBUG("cannot allocate the pool handle from the memory provider, "
+                  "falling back to the base allocator");
+    }
+
+    pool = umf_ba_global_aligned_alloc(sizeof(umf_memory_pool_t),
+                                       UMF_CACHE_LINE_SIZE);
+    if (pool) {
+        pool->handle_size = 0;
+    }
+    return pool;
+}
+
+static void pool_handle_free(umf_memory_pool_handle_t pool,
+                             umf_memory_provider_handle_t provider) {
+    if (pool->handle_size) {
+        umfMemoryProviderFree(provider, pool, pool->handle_size);
+    } else {
+        umf_ba_global_free(pool);
+    }
+}
 
 static umf_result_t umfPoolCreateInternal(const umf_memory_pool_ops_t *ops,
                                           umf_memory_provider_handle_t provider,
@@ -32,8 +82,7 @@ static umf_result_t umfPoolCreateInternal(const umf_memory_pool_ops_t *ops,
     }
 
     umf_result_t ret = UMF_RESULT_SUCCESS;
-    umf_memory_pool_handle_t pool =
-        umf_ba_global_alloc(sizeof(umf_memory_pool_t));
+    umf_memory_pool_handle_t pool = pool_handle_alloc(provider);
     if (!pool) {
         return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
     }
@@ -55,6 +104,17 @@ static umf_result_t umfPoolCreateInternal(const umf_memory_pool_ops_t *ops,
 
     pool->flags = flags;
     pool->ops = *ops;
+    pool->sampler = NULL;
+
+    size_t every_n_allocs, every_n_bytes;
+    if (umfPoolSamplerGetDefaults(&every_n_allocs, &every_n_bytes) == 0) {
+        pool->sampler = umfPoolSamplerCreate();
+        if (!pool->sampler) {
+            ret = UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+            goto err_sampler_create;
+        }
+        umfPoolSamplerConfigure(pool->sampler, every_n_allocs, every_n_bytes);
+    }
 
     ret = ops->initialize(pool->provider, params, &pool->pool_priv);
     if (ret != UMF_RESULT_SUCCESS) {
@@ -66,17 +126,21 @@ static umf_result_t umfPoolCreateInternal(const umf_memory_pool_ops_t *ops,
     return UMF_RESULT_SUCCESS;
 
 err_pool_init:
+    umfPoolSamplerDestroy(pool->sampler);
+err_sampler_create:
     if (!(flags & UMF_POOL_CREATE_FLAG_DISABLE_TRACKING)) {
         umfMemoryProviderDestroy(pool->provider);
     }
 err_provider_create:
-    umf_ba_global_free(pool);
+    pool_handle_free(pool, provider);
     return ret;
 }
 
 void umfPoolDestroy(umf_memory_pool_handle_t hPool) {
     hPool->ops.finalize(hPool->pool_priv);
 
+    umfPoolSamplerDestroy(hPool->sampler);
+
     umf_memory_provider_handle_t hUpstreamProvider = NULL;
     umfPoolGetMemoryProvider(hPool, &hUpstreamProvider);
 
@@ -85,15 +149,17 @@ void umfPoolDestroy(umf_memory_pool_handle_t hPool) {
         umfMemoryProviderDestroy(hPool->provider);
     }
 
-    if (hPool->flags & UMF_POOL_CREATE_FLAG_OWN_PROVIDER) {
-        // Destroy associated memory provider.
-        umfMemoryProviderDestroy(hUpstreamProvider);
-    }
-
     LOG_INFO("Memory pool destroyed: %p", (void *)hPool);
 
+    // the handle may come from the upstream provider, so free it first
+    umf_pool_create_flags_t flags = hPool->flags;
     // TODO: this free keeps memory in base allocator, so it can lead to OOM in some scenarios (it should be optimized)
-    umf_ba_global_free(hPool);
+    pool_handle_free(hPool, hUpstreamProvider);
+
+    if (flags & UMF_POOL_CREATE_FLAG_OWN_PROVIDER) {
+        // Destroy associated memory provider.
+        umfMemoryProviderDestroy(hUpstreamProvider);
+    }
 }
 
 umf_result_t umfFree(void *ptr) {
@@ -140,25 +206,58 @@ umf_result_t umfPoolCreate(const umf_memory_pool_ops_t *ops,
     return UMF_RESULT_SUCCESS;
 }
 
+// The sampler can be installed by umfPoolSetSampling() at any time,
+// so it is read with an acquire load that pairs with the CAS there.
+static inline umf_pool_sampler_t *
+pool_sampler(umf_memory_pool_handle_t hPool) {
+    umf_pool_sampler_t *sampler;
+    utils_atomic_load_acquire(&hPool->sampler, &sampler);
+    return sampler;
+}
+
 void *umfPoolMalloc(umf_memory_pool_handle_t hPool, size_t size) {
     UMF_CHECK((hPool != NULL), NULL);
-    return hPool->ops.malloc(hPool->pool_priv, size);
+    void *ptr = hPool->ops.malloc(hPool->pool_priv, size);
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    if (sampler) {
+        umfPoolSamplerAlloc(sampler, ptr, size, UMF_CALLER_ADDRESS());
+    }
+    return ptr;
 }
 
 void *umfPoolAlignedMalloc(umf_memory_pool_handle_t hPool, size_t size,
                            size_t alignment) {
     UMF_CHECK((hPool != NULL), NULL);
-    return hPool->ops.aligned_malloc(hPool->pool_priv, size, alignment);
+    void *ptr = hPool->ops.aligned_malloc(hPool->pool_priv, size, alignment);
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    if (sampler) {
+        umfPoolSamplerAlloc(sampler, ptr, size, UMF_CALLER_ADDRESS());
+    }
+    return ptr;
 }
 
 void *umfPoolCalloc(umf_memory_pool_handle_t hPool, size_t num, size_t size) {
     UMF_CHECK((hPool != NULL), NULL);
-    return hPool->ops.calloc(hPool->pool_priv, num, size);
+    void *ptr = hPool->ops.calloc(hPool->pool_priv, num, size);
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    if (sampler) {
+        umfPoolSamplerAlloc(sampler, ptr, num * size, UMF_CALLER_ADDRESS());
+    }
+    return ptr;
 }
 
 void *umfPoolRealloc(umf_memory_pool_handle_t hPool, void *ptr, size_t size) {
     UMF_CHECK((hPool != NULL), NULL);
-    return hPool->ops.realloc(hPool->pool_priv, ptr, size);
+    void *new_ptr = hPool->ops.realloc(hPool->pool_priv, ptr, size);
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    // A failed realloc keeps the old block, and so its sample. A moved block
+    // may already be reused by another thread here, which at worst costs
+    // that thread its sample (see umfPoolSamplerAlloc()).
+    if (sampler && (new_ptr || size == 0)) {
+        umfPoolSamplerFree(sampler, ptr);
+        umfPoolSamplerAlloc(sampler, new_ptr, size, UMF_CALLER_ADDRESS());
+    }
+    return new_ptr;
 }
 
 size_t umfPoolMallocUsableSize(umf_memory_pool_handle_t hPool, void *ptr) {
@@ -168,6 +267,11 @@ size_t umfPoolMallocUsableSize(umf_memory_pool_handle_t hPool, void *ptr) {
 
 umf_result_t umfPoolFree(umf_memory_pool_handle_t hPool, void *ptr) {
     UMF_CHECK((hPool != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
+    // remove the sample before the block can be reused by another thread
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    if (sampler) {
+        umfPoolSamplerFree(sampler, ptr);
+    }
     return hPool->ops.free(hPool->pool_priv, ptr);
 }
 
@@ -175,3 +279,90 @@ umf_result_t umfPoolGetLastAllocationError(umf_memory_pool_handle_t hPool) {
     UMF_CHECK((hPool != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
     return hPool->ops.get_last_allocation_error(hPool->pool_priv);
 }
+
+umf_result_t umfPoolMigrate(umf_memory_pool_handle_t hPool,
+                            unsigned target_node) {
+    UMF_CHECK((hPool != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
+
+    if (hPool->flags & UMF_POOL_CREATE_FLAG_DISABLE_TRACKING) {
+        LOG_ERR("pool %p is not tracked, its memory cannot be migrated",
+                (void *)hPool);
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    umf_memory_provider_handle_t hProvider = NULL;
+    umf_result_t ret = umfPoolGetMemoryProvider(hPool, &hProvider);
+    if (ret != UMF_RESULT_SUCCESS) {
+        return ret;
+    }
+
+    // Retarget the provider first, so the ranges the pool gets
+    // while the old ones are being migrated are placed right away.
+    ret = umfMemoryProviderMigrate(hProvider, NULL, 0, target_node);
+    if (ret != UMF_RESULT_SUCCESS) {
+        return ret;
+    }
+
+    return umfMemoryTrackerMigratePool(hPool, hPool->provider, target_node);
+}
+
+umf_result_t umfPoolSetSampling(umf_memory_pool_handle_t hPool,
+                                size_t every_n_allocs, size_t every_n_bytes) {
+    UMF_CHECK((hPool != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
+
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    if (!sampler) {
+        if (every_n_allocs == 0 && every_n_bytes == 0) {
+            return UMF_RESULT_SUCCESS;
+        }
+
+        // The sampler is never freed before the pool is destroyed, so
+        // the threads that have loaded it can keep using it without a lock.
+        umf_pool_sampler_t *new_sampler = umfPoolSamplerCreate();
+        if (!new_sampler) {
+            return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        umfPoolSamplerConfigure(new_sampler, every_n_allocs, every_n_bytes);
+
+        if (utils_compare_exchange_ptr(&hPool->sampler, NULL, new_sampler)) {
+            return UMF_RESULT_SUCCESS;
+        }
+
+        // another thread was faster
+        umfPoolSamplerDestroy(new_sampler);
+        sampler = pool_sampler(hPool);
+    }
+
+    umfPoolSamplerConfigure(sampler, every_n_allocs, every_n_bytes);
+
+    return UMF_RESULT_SUCCESS;
+}
+
+umf_result_t umfPoolGetSamples(umf_memory_pool_handle_t hPool,
+                               umf_pool_sample_t *samples, size_t *count) {
+    UMF_CHECK((hPool != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
+    UMF_CHECK((count != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
+
+    umf_pool_sampler_t *sampler = pool_sampler(hPool);
+    if (!sampler) {
+        *count = 0;
+        return UMF_RESULT_SUCCESS;
+    }
+
+    return umfPoolSamplerGetSamples(sampler, samples, count);
+}
+
+void umfPoolSampleAlloc(umf_memory_pool_handle_t hPool, void *ptr, size_t size,
+                        void *call_site) {
+    umf_pool_sampler_t *sampler = hPool ? pool_sampler(hPool) : NULL;
+    if (sampler) {
+        umfPoolSamplerAlloc(sampler, ptr, size, call_site);
+    }
+}
+
+void umfPoolSampleFree(umf_memory_pool_handle_t hPool, void *ptr) {
+    umf_pool_sampler_t *sampler = hPool ? pool_sampler(hPool) : NULL;
+    if (sampler) {
+        umfPoolSamplerFree(sampler, ptr);
+    }
+}
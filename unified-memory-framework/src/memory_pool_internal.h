@@ -23,13 +23,23 @@ extern "C" {
 
 #include "base_alloc.h"
 
+// The fields read on every allocation come first - the struct is allocated
+// (at least) cache line aligned, so they share a single cache line.
 typedef struct umf_memory_pool_t {
     void *pool_priv;
+
+    // Sampled allocation tracker, NULL if sampling was never enabled.
+    struct umf_pool_sampler_t *sampler;
+
     umf_memory_pool_ops_t ops;
     umf_pool_create_flags_t flags;
 
     // Memory provider used by the pool.
     umf_memory_provider_handle_t provider;
+
+    // Size of the handle allocation if it was allocated from the upstream
+    // memory provider, 0 if it comes from the base allocator.
+    size_t handle_size;
 } umf_memory_pool_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,312 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "base_alloc.h"
+#include "base_alloc_global.h"
+#include "critnib.h"
+#include "memory_pool_sampling.h"
+#include "utils_common.h"
+#include "utils_concurrency.h"
+#include "utils_log.h"
+
+#define POOL_SAMPLING_ENV "UMF_POOL_SAMPLING"
+
+typedef struct sample_value_t {
+    size_t size;
+    void *call_site;
+    size_t weight;
+} sample_value_t;
+
+struct umf_pool_sampler_t {
+    // sampling periods, 0 means the criterion is disabled
+    uint64_t every_n_allocs;
+    uint64_t every_n_bytes;
+
+    umf_ba_pool_t *sample_allocator;
+    critnib *map; // address -> sample_value_t
+
+    // number of live samples - lets umfPoolSamplerFree() skip the lookup
+    // if there is nothing to find
+    uint64_t live_samples;
+};
+
+// The countdowns are per thread (and shared by all the pools the thread
+// allocates from), so making the sampling decision needs no atomics.
+// 0 means "not drawn yet".
+static __TLS int64_t TLS_allocs_until_sample;
+static __TLS int64_t TLS_bytes_until_sample;
+static __TLS uint64_t TLS_rand_state;
+
+static uint64_t sampler_rand(void) {
+    uint64_t x = TLS_rand_state;
+    if (x == 0) {
+        x = (uint64_t)(uintptr_t)&TLS_rand_state ^ 0x9E3779B97F4A7C15ULL;
+    }
+
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    TLS_rand_state = x;
+
+    return x;
+}
+
+// The distance to the next sample is drawn uniformly from [1, 2 * period - 1]
+// (mean: period) rather than being fixed, so periodic allocation patterns
+// do not alias with the sampling period.
+static int64_t sampler_next_interval(uint64_t period) {
+    if (period <= 1) {
+        return 1;
+    }
+
+    return (int64_t)(1 + sampler_rand() % (2 * period - 1));
+}
+
+umf_pool_sampler_t *umfPoolSamplerCreate(void) {
+    umf_pool_sampler_t *sampler =
+        umf_ba_global_alloc(sizeof(umf_pool_sampler_t));
+    if (!sampler) {
+        return NULL;
+    }
+
+    sampler->every_n_allocs = 0;
+    sampler->every_n_bytes = 0;
+    sampler->live_samples = 0;
+
+    sampler->sample_allocator = umf_ba_create(sizeof(sample_value_t));
+    if (!sampler->sample_allocator) {
+        goto err_free_sampler;
+    }
+
+    sampler->map = critnib_new();
+    if (!sampler->map) {
+        goto err_destroy_sample_allocator;
+    }
+
+    LOG_DEBUG("pool sampler created: %p", (void *)sampler);
+
+    return sampler;
+
+err_destroy_sample_allocator:
+    umf_ba_destroy(sampler->sample_allocator);
+err_free_sampler:
+    umf_ba_global_free(sampler);
+    return NULL;
+}
+
+static int free_sample_cb(uintptr_t key, void *value, void *privdata) {
+    (void)key; // unused
+    umf_pool_sampler_t *sampler = privdata;
+    umf_ba_free(sampler->sample_allocator, value);
+    return 0;
+}
+
+void umfPoolSamplerDestroy(umf_pool_sampler_t *sampler) {
+    if (!sampler) {
+        return;
+    }
+
+    // the pool is being destroyed, so the live samples are leaks
+    if (sampler->live_samples) {
+        LOG_DEBUG("pool sampler %p: %llu sampled allocations were not freed",
+                  (void *)sampler,
+                  (unsigned long long)sampler->live_samples);
+    }
+
+    critnib_iter(sampler->map, 0, UINTPTR_MAX, free_sample_cb, sampler);
+    critnib_delete(sampler->map);
+    umf_ba_destroy(sampler->sample_allocator);
+    umf_ba_global_free(sampler);
+}
+
+void umfPoolSamplerConfigure(umf_pool_sampler_t *sampler, size_t every_n_allocs,
+                             size_t every_n_bytes) {
+    assert(sampler);
+
+    utils_atomic_store_release(&sampler->every_n_allocs,
+                               (uint64_t)every_n_allocs);
+    utils_atomic_store_release(&sampler->every_n_bytes,
+                               (uint64_t)every_n_bytes);
+
+    LOG_INFO("pool sampler %p: every_n_allocs=%zu, every_n_bytes=%zu",
+             (void *)sampler, every_n_allocs, every_n_bytes);
+}
+
+int umfPoolSamplerGetDefaults(size_t *every_n_allocs, size_t *every_n_bytes) {
+    const char *envVar = getenv(POOL_SAMPLING_ENV);
+    if (!envVar || !*envVar) {
+        return -1;
+    }
+
+    *every_n_allocs = 0;
+    *every_n_bytes = 0;
+
+    const char *arg;
+    if (utils_parse_var(envVar, "allocs", &arg)) {
+        *every_n_allocs = strtoull(arg, NULL, 10);
+    }
+    if (utils_parse_var(envVar, "bytes", &arg)) {
+        *every_n_bytes = strtoull(arg, NULL, 10);
+    }
+
+    if (*every_n_allocs == 0 && *every_n_bytes == 0) {
+        LOG_ERR("wrong value of %s: \"%s\" (expected: \"allocs,<N>\" and/or "
+                "\"bytes,<N>\")",
+                POOL_SAMPLING_ENV, envVar);
+        return -1;
+    }
+
+    return 0;
+}
+
+void umfPoolSamplerAlloc(umf_pool_sampler_t *sampler, void *ptr, size_t size,
+                         void *call_site) {
+    if (!ptr) {
+        return;
+    }
+
+    uint64_t every_n_allocs, every_n_bytes;
+    utils_atomic_load_acquire(&sampler->every_n_allocs, &every_n_allocs);
+    utils_atomic_load_acquire(&sampler->every_n_bytes, &every_n_bytes);
+
+    // weight - the estimated number of bytes represented by this sample
+    size_t weight = 0;
+
+    if (every_n_allocs) {
+        // (re)draw also if the countdown was drawn for a longer period
+        // (another pool or the previous configuration of this one)
+        if (TLS_allocs_until_sample == 0 ||
+            TLS_allocs_until_sample > (int64_t)(2 * every_n_allocs)) {
+            TLS_allocs_until_sample = sampler_next_interval(every_n_allocs);
+        }
+        if (--TLS_allocs_until_sample == 0) {
+            TLS_allocs_until_sample = sampler_next_interval(every_n_allocs);
+            weight = size * (size_t)every_n_allocs;
+        }
+    }
+
+    if (every_n_bytes && weight == 0) {
+        if (TLS_bytes_until_sample == 0 ||
+            TLS_bytes_until_sample > (int64_t)(2 * every_n_bytes)) {
+            TLS_bytes_until_sample = sampler_next_interval(every_n_bytes);
+        }
+        TLS_bytes_until_sample -= (int64_t)size;
+        if (TLS_bytes_until_sample <= 0) {
+            TLS_bytes_until_sample = sampler_next_interval(every_n_bytes);
+            // allocations of at least every_n_bytes are (almost) always
+            // sampled, the smaller ones with the probability size/period
+            weight = (size > every_n_bytes) ? size : (size_t)every_n_bytes;
+        }
+    }
+
+    if (weight == 0) {
+        return;
+    }
+
+    sample_value_t *value = umf_ba_alloc(sampler->sample_allocator);
+    if (!value) {
+        LOG_ERR("failed to allocate a sample, ptr=%p, size=%zu", ptr, size);
+        return;
+    }
+
+    value->size = size;
+    value->call_site = call_site;
+    value->weight = weight;
+
+    int ret = critnib_insert(sampler->map, (uintptr_t)ptr, value, 0);
+    if (ret != 0) {
+        // EEXIST: a stale sample of a block freed outside of the sampler
+        LOG_DEBUG("failed to insert a sample, ret=%d, ptr=%p, size=%zu", ret,
+                  ptr, size);
+        umf_ba_free(sampler->sample_allocator, value);
+        return;
+    }
+
+    utils_fetch_and_add64(&sampler->live_samples, 1);
+}
+
+void umfPoolSamplerFree(umf_pool_sampler_t *sampler, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    uint64_t live_samples;
+    utils_atomic_load_acquire(&sampler->live_samples, &live_samples);
+    if (live_samples == 0) {
+        return;
+    }
+
+    // critnib_get() is lock-free, critnib_remove() is not -
+    // call the latter only for the (rare) sampled blocks
+    if (!critnib_get(sampler->map, (uintptr_t)ptr)) {
+        return;
+    }
+
+    void *value = critnib_remove(sampler->map, (uintptr_t)ptr);
+    if (value) {
+        utils_fetch_and_add64(&sampler->live_samples, -1);
+        umf_ba_free(sampler->sample_allocator, value);
+    }
+}
+
+typedef struct samples_copy_t {
+    umf_pool_sample_t *samples;
+    size_t capacity;
+    size_t count;
+} samples_copy_t;
+
+static int copy_sample_cb(uintptr_t key, void *value, void *privdata) {
+    samples_copy_t *copy = privdata;
+    sample_value_t *v = value;
+
+    if (copy->count == copy->capacity) {
+        return 1; // stop the iteration
+    }
+
+    umf_pool_sample_t *s = &copy->samples[copy->count++];
+    s->ptr = (void *)key;
+    s->size = v->size;
+    s->call_site = v->call_site;
+    s->weight = v->weight;
+    s->numa_node = -1;
+
+    return 0;
+}
+
+umf_result_t umfPoolSamplerGetSamples(umf_pool_sampler_t *sampler,
+                                      umf_pool_sample_t *samples,
+                                      size_t *count) {
+    assert(sampler);
+    assert(count);
+
+    if (!samples) {
+        uint64_t live_samples;
+        utils_atomic_load_acquire(&sampler->live_samples, &live_samples);
+        *count = (size_t)live_samples;
+        return UMF_RESULT_SUCCESS;
+    }
+
+    samples_copy_t copy = {samples, *count, 0};
+    critnib_iter(sampler->map, 0, UINTPTR_MAX, copy_sample_cb, &copy);
+
+    // resolve the placement outside of the critnib lock - it is a syscall
+    for (size_t i = 0; i < copy.count; i++) {
+        samples[i].numa_node = utils_get_numa_node_of_addr(samples[i].ptr);
+    }
+
+    *count = copy.count;
+
+    return UMF_RESULT_SUCCESS;
+}
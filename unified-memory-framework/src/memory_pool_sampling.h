@@ -0,0 +1,57 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ */
+
+#ifndef UMF_MEMORY_POOL_SAMPLING_H
+#define UMF_MEMORY_POOL_SAMPLING_H 1
+
+#include <stddef.h>
+
+#include <umf/base.h>
+#include <umf/memory_pool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+#include <intrin.h>
+#define UMF_CALLER_ADDRESS() _ReturnAddress()
+#else
+#define UMF_CALLER_ADDRESS() __builtin_return_address(0)
+#endif
+
+// Sampled allocation tracker of a pool. In contrast to the tracking provider,
+// which inserts every provider allocation into the global critnib, it records
+// only one in N pool allocations (or one per N allocated bytes), so it can be
+// left enabled for pools created with UMF_POOL_CREATE_FLAG_DISABLE_TRACKING.
+typedef struct umf_pool_sampler_t umf_pool_sampler_t;
+
+umf_pool_sampler_t *umfPoolSamplerCreate(void);
+void umfPoolSamplerDestroy(umf_pool_sampler_t *sampler);
+
+void umfPoolSamplerConfigure(umf_pool_sampler_t *sampler, size_t every_n_allocs,
+                             size_t every_n_bytes);
+
+// Reads the UMF_POOL_SAMPLING environment variable. Returns 0 and sets
+// the periods if sampling of all pools was requested, -1 otherwise.
+int umfPoolSamplerGetDefaults(size_t *every_n_allocs, size_t *every_n_bytes);
+
+void umfPoolSamplerAlloc(umf_pool_sampler_t *sampler, void *ptr, size_t size,
+                         void *call_site);
+void umfPoolSamplerFree(umf_pool_sampler_t *sampler, void *ptr);
+
+umf_result_t umfPoolSamplerGetSamples(umf_pool_sampler_t *sampler,
+                                      umf_pool_sample_t *samples,
+                                      size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UMF_MEMORY_POOL_SAMPLING_H */
@@ -67,6 +67,15 @@ static umf_result_t umfDefaultAllocationMerge(void *provider, void *lowPtr,
     return UMF_RESULT_ERROR_NOT_SUPPORTED;
 }
 
+static umf_result_t umfDefaultMigrate(void *provider, void *ptr, size_t size,
+                                      unsigned target_node) {
+    (void)provider;
+    (void)ptr;
+    (void)size;
+    (void)target_node;
+    return UMF_RESULT_ERROR_NOT_SUPPORTED;
+}
+
 static umf_result_t umfDefaultGetIPCHandleSize(void *provider, size_t *size) {
     (void)provider;
     (void)size;
@@ -121,6 +130,9 @@ void assignOpsExtDefaults(umf_memory_provider_ops_t *ops) {
     if (!ops->ext.allocation_merge) {
         ops->ext.allocation_merge = umfDefaultAllocationMerge;
     }
+    if (!ops->ext.migrate) {
+        ops->ext.migrate = umfDefaultMigrate;
+    }
 }
 
 void assignOpsIpcDefaults(umf_memory_provider_ops_t *ops) {
@@ -173,6 +185,11 @@ bool umfIsFreeOpDefault(umf_memory_provider_handle_t hProvider) {
     return (hProvider->ops.ext.free == umfDefaultFree);
 }
 
+bool umfMemoryProviderHasOps(umf_memory_provider_handle_t hProvider,
+                             const umf_memory_provider_ops_t *ops) {
+    return ops && hProvider->ops.alloc == ops->alloc;
+}
+
 umf_result_t umfMemoryProviderCreate(const umf_memory_provider_ops_t *ops,
                                      void *params,
                                      umf_memory_provider_handle_t *hProvider) {
@@ -379,3 +396,17 @@ umfMemoryProviderCloseIPCHandle(umf_memory_provider_handle_t hProvider,
     return hProvider->ops.ipc.close_ipc_handle(hProvider->provider_priv, ptr,
                                                size);
 }
+
+umf_result_t umfMemoryProviderMigrate(umf_memory_provider_handle_t hProvider,
+                                      void *ptr, size_t size,
+                                      unsigned target_node) {
+    UMF_CHECK((hProvider != NULL), UMF_RESULT_ERROR_INVALID_ARGUMENT);
+    if ((ptr == NULL) != (size == 0)) {
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    umf_result_t res = hProvider->ops.ext.migrate(hProvider->provider_priv,
+                                                  ptr, size, target_node);
+    checkErrorAndSetLastProvider(res, hProvider);
+    return res;
+}
@@ -21,6 +21,8 @@ extern "C" {
 void *umfMemoryProviderGetPriv(umf_memory_provider_handle_t hProvider);
 umf_memory_provider_handle_t *umfGetLastFailedMemoryProviderPtr(void);
 bool umfIsFreeOpDefault(umf_memory_provider_handle_t hProvider);
+bool umfMemoryProviderHasOps(umf_memory_provider_handle_t hProvider,
+                             const umf_memory_provider_ops_t *ops);
 
 #ifdef __cplusplus
 }
@@ -18,6 +18,7 @@
 #include "base_alloc_global.h"
 #include "mempolicy_internal.h"
 #include "memtarget_numa.h"
+#include "memtarget_numa_calibration.h"
 #include "topology.h"
 #include "utils_assert.h"
 #include "utils_log.h"
@@ -197,11 +198,6 @@ static umf_result_t numa_get_capacity(void *memTarget, size_t *capacity) {
     return UMF_RESULT_SUCCESS;
 }
 
-typedef enum memattr_type_t {
-    MEMATTR_TYPE_BANDWIDTH,
-    MEMATTR_TYPE_LATENCY
-} memattr_type_t;
-
 static size_t memattr_get_worst_value(memattr_type_t type) {
     switch (type) {
     case MEMATTR_TYPE_BANDWIDTH:
@@ -268,6 +264,16 @@ static umf_result_t query_attribute_value(void *srcMemoryTarget,
     hwloc_uint64_t memAttrValue = 0;
     int ret = hwloc_memattr_get_value(topology, hwlocMemAttrType, dstNumaNode,
                                       &initiator, 0, &memAttrValue);
+    if (ret && errno == EINVAL) {
+        // HMAT is unavailable - measure the value ourselves
+        LOG_PDEBUG("Getting an attribute value from HWLOC failed, using the "
+                   "measured value");
+        return umfMemattrCalibratedGet(
+            ((struct numa_memtarget_t *)srcMemoryTarget)->physical_id,
+            ((struct numa_memtarget_t *)dstMemoryTarget)->physical_id, type,
+            value);
+    }
+
     if (ret) {
         LOG_PERR("Getting an attribute value for a specific target NUMA node "
                  "failed");
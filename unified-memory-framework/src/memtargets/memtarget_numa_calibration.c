@@ -0,0 +1,378 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memtarget_numa_calibration.h"
+
+#ifdef _WIN32
+
+umf_result_t umfMemattrCalibratedGet(unsigned srcNode, unsigned dstNode,
+                                     memattr_type_t type, size_t *value) {
+    (void)srcNode; // unused
+    (void)dstNode; // unused
+    (void)type;    // unused
+    (void)value;   // unused
+
+    // not supported
+    return UMF_RESULT_ERROR_NOT_SUPPORTED;
+}
+
+#else /* !_WIN32 */
+
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "topology.h"
+#include "utils_common.h"
+#include "utils_concurrency.h"
+#include "utils_log.h"
+
+#define CALIBRATION_MAX_NODES 64
+// the buffer is at least CALIBRATION_BUFFER_LLC_FACTOR times larger than
+// the last level caches, so the timed loops do not run from the cache
+#define CALIBRATION_BUFFER_MIN_SIZE (256ull * 1024 * 1024)
+#define CALIBRATION_BUFFER_LLC_FACTOR 4
+#define CALIBRATION_LINE_SIZE 64
+#define CALIBRATION_CHASE_STEPS (1 << 20)
+#define CALIBRATION_STREAM_PASSES 4
+
+// version of the cache file format
+#define CALIBRATION_CACHE_VERSION 3
+#define CALIBRATION_CACHE_HEADER_SIZE 256
+
+#define CALIBRATION_CACHE_ENV "UMF_MEMATTR_CACHE"
+#define CALIBRATION_CACHE_DEFAULT "/.cache/umf_memattr"
+
+// measured values indexed by the OS indexes of the nodes
+// (0 - not measured yet)
+static size_t latency_matrix[CALIBRATION_MAX_NODES][CALIBRATION_MAX_NODES];
+static size_t bandwidth_matrix[CALIBRATION_MAX_NODES][CALIBRATION_MAX_NODES];
+
+// the cache file is valid only on the same machine since the same boot
+// (see umfGetSystemId()) with the same number of nodes and PUs
+static char cache_header[CALIBRATION_CACHE_HEADER_SIZE];
+
+static char cache_path[PATH_MAX];
+static utils_mutex_t calibration_lock;
+static UTIL_ONCE_FLAG calibration_initialized = UTIL_ONCE_FLAG_INIT;
+
+static uint64_t calibration_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void calibration_cache_load(void) {
+    FILE *file = fopen(cache_path, "r");
+    if (!file) {
+        return;
+    }
+
+    char file_header[CALIBRATION_CACHE_HEADER_SIZE];
+    if (!fgets(file_header, sizeof(file_header), file) ||
+        strcmp(file_header, cache_header) != 0) {
+        LOG_INFO("ignoring the stale memory attributes cache: %s", cache_path);
+        fclose(file);
+        return;
+    }
+
+    unsigned src, dst;
+    size_t latency, bandwidth;
+    while (fscanf(file, "%u %u %zu %zu", &src, &dst, &latency, &bandwidth) ==
+           4) {
+        if (src < CALIBRATION_MAX_NODES && dst < CALIBRATION_MAX_NODES) {
+            latency_matrix[src][dst] = latency;
+            bandwidth_matrix[src][dst] = bandwidth;
+        }
+    }
+
+    fclose(file);
+}
+
+// calibration_lock has to be held
+static void calibration_cache_store(void) {
+    if (cache_path[0] == '\0') {
+        return;
+    }
+
+    char tmp_path[PATH_MAX + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d", cache_path, (int)getpid());
+
+    FILE *file = fopen(tmp_path, "w");
+    if (!file) {
+        LOG_PDEBUG("cannot write the memory attributes cache: %s", tmp_path);
+        return;
+    }
+
+    fputs(cache_header, file);
+    for (unsigned src = 0; src < CALIBRATION_MAX_NODES; src++) {
+        for (unsigned dst = 0; dst < CALIBRATION_MAX_NODES; dst++) {
+            if (latency_matrix[src][dst] || bandwidth_matrix[src][dst]) {
+                fprintf(file, "%u %u %zu %zu\n", src, dst,
+                        latency_matrix[src][dst], bandwidth_matrix[src][dst]);
+            }
+        }
+    }
+
+    if (fclose(file) || rename(tmp_path, cache_path)) {
+        LOG_PDEBUG("cannot write the memory attributes cache: %s", cache_path);
+        unlink(tmp_path);
+    }
+}
+
+static void calibration_init(void) {
+    if (utils_mutex_init(&calibration_lock) == NULL) {
+        LOG_ERR("initializing the calibration lock failed");
+        return;
+    }
+
+    unsigned num_nodes = 0, num_pus = 0;
+    hwloc_topology_t topology = umfGetTopology();
+    if (topology) {
+        num_nodes = (unsigned)hwloc_get_nbobjs_by_type(topology,
+                                                       HWLOC_OBJ_NUMANODE);
+        num_pus =
+            (unsigned)hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_PU);
+    }
+
+    char system_id[UMF_SYSTEM_ID_SIZE];
+    umfGetSystemId(system_id, sizeof(system_id));
+    snprintf(cache_header, sizeof(cache_header), "umf-memattr %u %s %u %u\n",
+             CALIBRATION_CACHE_VERSION, system_id, num_nodes, num_pus);
+
+    const char *path = getenv(CALIBRATION_CACHE_ENV);
+    const char *home = getenv("HOME");
+    if (path) {
+        // an empty path disables the file cache
+        utils_copy_path(path, cache_path, sizeof(cache_path));
+    } else if (home) {
+        snprintf(cache_path, sizeof(cache_path), "%s%s", home,
+                 CALIBRATION_CACHE_DEFAULT);
+    }
+
+    if (cache_path[0] != '\0') {
+        calibration_cache_load();
+    }
+}
+
+// Pointer-chase through a random cyclic permutation of the cache lines
+// of the buffer, so that every load depends on the previous one
+// and the hardware prefetchers cannot help.
+static size_t calibration_measure_latency(char *buf, size_t size) {
+    size_t num_lines = size / CALIBRATION_LINE_SIZE;
+
+    // Sattolo's algorithm - a random cycle going through all lines
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < num_lines; i++) {
+        *(size_t *)(buf + i * CALIBRATION_LINE_SIZE) = i;
+    }
+    for (size_t i = num_lines - 1; i > 0; i--) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        size_t j = (size_t)(seed % i);
+        size_t *a = (size_t *)(buf + i * CALIBRATION_LINE_SIZE);
+        size_t *b = (size_t *)(buf + j * CALIBRATION_LINE_SIZE);
+        size_t tmp = *a;
+        *a = *b;
+        *b = tmp;
+    }
+
+    // convert line indexes into pointers
+    for (size_t i = 0; i < num_lines; i++) {
+        size_t *line = (size_t *)(buf + i * CALIBRATION_LINE_SIZE);
+        *(void **)line = buf + *line * CALIBRATION_LINE_SIZE;
+    }
+
+    void *volatile sink;
+    void **p = (void **)buf;
+    uint64_t start = calibration_now_ns();
+    for (size_t i = 0; i < CALIBRATION_CHASE_STEPS; i++) {
+        p = (void **)*p;
+    }
+    uint64_t elapsed = calibration_now_ns() - start;
+    sink = p;
+    (void)sink;
+
+    size_t latency = (size_t)(elapsed / CALIBRATION_CHASE_STEPS);
+    return latency ? latency : 1;
+}
+
+// Sequential read of the whole buffer - the best of a few passes.
+static size_t calibration_measure_bandwidth(char *buf, size_t size) {
+    uint64_t best = UINT64_MAX;
+    volatile uint64_t sink = 0;
+
+    for (int pass = 0; pass < CALIBRATION_STREAM_PASSES; pass++) {
+        const uint64_t *data = (const uint64_t *)buf;
+        uint64_t sum = 0;
+        uint64_t start = calibration_now_ns();
+        for (size_t i = 0; i < size / sizeof(*data); i++) {
+            sum += data[i];
+        }
+        uint64_t elapsed = calibration_now_ns() - start;
+        sink += sum;
+        if (elapsed && elapsed < best) {
+            best = elapsed;
+        }
+    }
+    (void)sink;
+
+    if (best == UINT64_MAX) {
+        return 1;
+    }
+
+    // MiB/s
+    return (size_t)(((double)size / (1024 * 1024)) / ((double)best / 1e9));
+}
+
+// Size of the calibration buffer: several times the total size of the last
+// level caches (L3, or L2 if there is no L3), but not more than half
+// of the memory of the destination node.
+static size_t calibration_buffer_size(hwloc_topology_t topology,
+                                      hwloc_obj_t dst) {
+    uint64_t llc_size = 0;
+    hwloc_obj_type_t types[] = {HWLOC_OBJ_L3CACHE, HWLOC_OBJ_L2CACHE};
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]) && !llc_size;
+         t++) {
+        hwloc_obj_t cache = NULL;
+        while ((cache = hwloc_get_next_obj_by_type(topology, types[t],
+                                                   cache)) != NULL) {
+            llc_size += cache->attr->cache.size;
+        }
+    }
+
+    uint64_t size = llc_size * CALIBRATION_BUFFER_LLC_FACTOR;
+    if (size < CALIBRATION_BUFFER_MIN_SIZE) {
+        size = CALIBRATION_BUFFER_MIN_SIZE;
+    }
+
+    uint64_t node_memory = dst->attr->numanode.local_memory;
+    if (node_memory && size > node_memory / 2) {
+        size = node_memory / 2;
+    }
+
+    return ALIGN_DOWN((size_t)size, utils_get_page_size());
+}
+
+// calibration_lock has to be held
+static umf_result_t calibration_measure(unsigned srcNode, unsigned dstNode) {
+    hwloc_topology_t topology = umfGetTopology();
+    if (!topology) {
+        LOG_ERR("Retrieving cached topology failed");
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    hwloc_obj_t src = hwloc_get_numanode_obj_by_os_index(topology, srcNode);
+    hwloc_obj_t dst = hwloc_get_numanode_obj_by_os_index(topology, dstNode);
+    if (!src || !dst) {
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (hwloc_bitmap_iszero(src->cpuset)) {
+        // there is no CPU to run the measurement on
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    hwloc_bitmap_t old_cpuset = hwloc_bitmap_alloc();
+    if (!old_cpuset) {
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    umf_result_t ret = UMF_RESULT_SUCCESS;
+
+    // the thread has to get its binding back after the measurement
+    if (hwloc_get_cpubind(topology, old_cpuset, HWLOC_CPUBIND_THREAD)) {
+        LOG_PERR("getting the binding of the calibration thread failed");
+        ret = UMF_RESULT_ERROR_NOT_SUPPORTED;
+        goto err_free_cpuset;
+    }
+
+    if (hwloc_set_cpubind(topology, src->cpuset, HWLOC_CPUBIND_THREAD)) {
+        LOG_PERR("binding the calibration thread to node %u failed", srcNode);
+        ret = UMF_RESULT_ERROR_UNKNOWN;
+        goto err_free_cpuset;
+    }
+
+    size_t buf_size = calibration_buffer_size(topology, dst);
+    char *buf = hwloc_alloc_membind(
+        topology, buf_size, dst->nodeset, HWLOC_MEMBIND_BIND,
+        HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_STRICT);
+    if (!buf) {
+        LOG_PERR("allocating the calibration buffer on node %u failed",
+                 dstNode);
+        ret = UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+        goto err_restore_cpubind;
+    }
+
+    memset(buf, 1, buf_size);
+
+    bandwidth_matrix[srcNode][dstNode] =
+        calibration_measure_bandwidth(buf, buf_size);
+    latency_matrix[srcNode][dstNode] =
+        calibration_measure_latency(buf, buf_size);
+
+    LOG_INFO("measured node %u -> node %u: latency %zu ns, bandwidth %zu MiB/s",
+             srcNode, dstNode, latency_matrix[srcNode][dstNode],
+             bandwidth_matrix[srcNode][dstNode]);
+
+    hwloc_free(topology, buf, buf_size);
+
+err_restore_cpubind:
+    if (hwloc_set_cpubind(topology, old_cpuset, HWLOC_CPUBIND_THREAD)) {
+        LOG_PERR("restoring the binding of the calibration thread failed");
+    }
+err_free_cpuset:
+    hwloc_bitmap_free(old_cpuset);
+    return ret;
+}
+
+umf_result_t umfMemattrCalibratedGet(unsigned srcNode, unsigned dstNode,
+                                     memattr_type_t type, size_t *value) {
+    if (!value) {
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    utils_init_once(&calibration_initialized, calibration_init);
+
+    if (srcNode >= CALIBRATION_MAX_NODES || dstNode >= CALIBRATION_MAX_NODES) {
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    if (utils_mutex_lock(&calibration_lock) != 0) {
+        LOG_ERR("locking the calibration lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    umf_result_t ret = UMF_RESULT_SUCCESS;
+    if (latency_matrix[srcNode][dstNode] == 0) {
+        ret = calibration_measure(srcNode, dstNode);
+        if (ret == UMF_RESULT_SUCCESS) {
+            calibration_cache_store();
+        }
+    }
+
+    if (ret == UMF_RESULT_SUCCESS) {
+        *value = (type == MEMATTR_TYPE_LATENCY)
+                     ? latency_matrix[srcNode][dstNode]
+                     : bandwidth_matrix[srcNode][dstNode];
+    }
+
+    utils_mutex_unlock(&calibration_lock);
+
+    return ret;
+}
+
+#endif /* !_WIN32 */
@@ -0,0 +1,41 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ */
+
+#ifndef UMF_MEMTARGET_NUMA_CALIBRATION_H
+#define UMF_MEMTARGET_NUMA_CALIBRATION_H 1
+
+#include <stddef.h>
+
+#include <umf/base.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum memattr_type_t {
+    MEMATTR_TYPE_BANDWIDTH,
+    MEMATTR_TYPE_LATENCY
+} memattr_type_t;
+
+// Returns the latency [ns] or the bandwidth [MiB/s] of accesses from the CPUs
+// of the srcNode to the memory of the dstNode (OS indexes of the nodes)
+// measured by a short built-in pointer-chase (latency) or stream (bandwidth)
+// run. It is the fallback used when HWLOC cannot provide the value (no HMAT).
+// Measured values are cached in the file given by the UMF_MEMATTR_CACHE
+// environment variable (default: ~/.cache/umf_memattr), so every node pair
+// is measured only once per machine and boot. An empty UMF_MEMATTR_CACHE
+// disables the file cache.
+umf_result_t umfMemattrCalibratedGet(unsigned srcNode, unsigned dstNode,
+                                     memattr_type_t type, size_t *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UMF_MEMTARGET_NUMA_CALIBRATION_H */
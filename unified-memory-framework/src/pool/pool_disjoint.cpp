@@ -22,9 +22,12 @@
 // TODO: replace with logger?
 #include <iostream>
 
+#include <umf/pools/pool_local_node.h>
+
 #include "provider/provider_tracking.h"
 
 #include "../cpp_helpers.hpp"
+#include "critnib.h"
 #include "pool_disjoint.h"
 #include "umf.h"
 #include "utils_log.h"
@@ -170,6 +173,9 @@ class Slab {
     // Hints where to start search for free chunk in a slab
     size_t FirstFreeChunkIdx = 0;
 
+    // Whether the slab is registered in the slab index of the pool
+    bool Indexed = false;
+
     // Return the index of the first available chunk, SIZE_MAX otherwise
     size_t FindFirstAvailableChunkIdx() const;
 
@@ -331,6 +337,15 @@ class DisjointPool::AllocImpl {
     std::unordered_multimap<void *, Slab &> KnownSlabs;
     std::shared_timed_mutex KnownSlabsMapLock;
 
+    struct CritnibDeleter {
+        void operator()(critnib *c) { critnib_delete(c); }
+    };
+
+    // The chunked slabs aligned to SlabMinSize, indexed by their address,
+    // so the slab of a chunk is found without locking the map (nullptr if
+    // SlabMinSize is not a power of 2). Destroyed after the buckets too.
+    std::unique_ptr<critnib, CritnibDeleter> SlabIndex;
+
     // Handle to the memory provider
     umf_memory_provider_handle_t MemHandle;
 
@@ -356,6 +371,10 @@ class DisjointPool::AllocImpl {
 
         VALGRIND_DO_CREATE_MEMPOOL(this, 0, 0);
 
+        if ((this->params.SlabMinSize & (this->params.SlabMinSize - 1)) == 0) {
+            SlabIndex.reset(critnib_new());
+        }
+
         // Generate buckets sized such as: 64, 96, 128, 192, ..., CutOff.
         // Powers of 2 and the value halfway between the powers of 2.
         auto Size1 = this->params.MinBucketSize;
@@ -384,6 +403,7 @@ class DisjointPool::AllocImpl {
     void *allocate(size_t Size, size_t Alignment, bool &FromPool);
     void *allocate(size_t Size, bool &FromPool);
     void deallocate(void *Ptr, bool &ToPool);
+    size_t getUsableSize(void *Ptr);
 
     umf_memory_provider_handle_t getMemHandle() { return MemHandle; }
 
@@ -394,6 +414,8 @@ class DisjointPool::AllocImpl {
         return KnownSlabs;
     }
 
+    critnib *getSlabIndex() { return SlabIndex.get(); }
+
     size_t SlabMinSize() { return params.SlabMinSize; };
 
     umf_disjoint_pool_params_t &getParams() { return params; }
@@ -412,6 +434,8 @@ class DisjointPool::AllocImpl {
   private:
     Bucket &findBucket(size_t Size);
     std::size_t sizeToIdx(size_t Size);
+    Slab *findSlab(void *Ptr);
+    Slab *findIndexedSlab(void *Ptr);
 };
 
 static void *memoryProviderAlloc(umf_memory_provider_handle_t hProvider,
@@ -459,7 +483,21 @@ Slab::Slab(Bucket &Bkt)
       Chunks(Bkt.SlabMinSize() / Bkt.getSize()), NumAllocated{0},
       bucket(Bkt), SlabListIter{}, FirstFreeChunkIdx{0} {
     auto SlabSize = Bkt.SlabAllocSize();
-    MemPtr = memoryProviderAlloc(Bkt.getMemHandle(), SlabSize);
+    MemPtr = nullptr;
+    if (Bkt.getSize() <= Bkt.ChunkCutOff() && Bkt.getAllocCtx().getSlabIndex()) {
+        // A chunked slab is SlabMinSize bytes long - aligned to its size,
+        // it is found by the address of any of its chunks.
+        try {
+            MemPtr = memoryProviderAlloc(Bkt.getMemHandle(), SlabSize,
+                                         Bkt.SlabMinSize());
+            Indexed = true;
+        } catch (MemoryProviderError &) {
+            // the provider does not support such an alignment
+        }
+    }
+    if (!MemPtr) {
+        MemPtr = memoryProviderAlloc(Bkt.getMemHandle(), SlabSize);
+    }
     regSlab(*this);
 }
 
@@ -562,12 +600,25 @@ void Slab::regSlab(Slab &Slab) {
 
     regSlabByAddr(StartAddr, Slab);
     regSlabByAddr(EndAddr, Slab);
+
+    if (Slab.Indexed &&
+        critnib_insert(bucket.getAllocCtx().getSlabIndex(),
+                       reinterpret_cast<uintptr_t>(Slab.getPtr()), &Slab,
+                       0 /* update */)) {
+        // found by the map only
+        Slab.Indexed = false;
+    }
 }
 
 void Slab::unregSlab(Slab &Slab) {
     void *StartAddr = AlignPtrDown(Slab.getPtr(), bucket.SlabMinSize());
     void *EndAddr = static_cast<char *>(StartAddr) + bucket.SlabMinSize();
 
+    if (Slab.Indexed) {
+        critnib_remove(bucket.getAllocCtx().getSlabIndex(),
+                       reinterpret_cast<uintptr_t>(Slab.getPtr()));
+    }
+
     unregSlabByAddr(StartAddr, Slab);
     unregSlabByAddr(EndAddr, Slab);
 }
@@ -596,7 +647,7 @@ void Slab::freeChunk(void *Ptr) {
 }
 
 void *Slab::getEnd() const {
-    return static_cast<char *>(getPtr()) + bucket.SlabMinSize();
+    return static_cast<char *>(getPtr()) + bucket.SlabAllocSize();
 }
 
 bool Slab::hasAvail() { return NumAllocated != getNumChunks(); }
@@ -953,51 +1004,119 @@ Bucket &DisjointPool::AllocImpl::findBucket(size_t Size) {
     return *(Buckets[calculatedIdx]);
 }
 
-void DisjointPool::AllocImpl::deallocate(void *Ptr, bool &ToPool) {
+// Returns the slab containing Ptr or nullptr if Ptr was allocated
+// directly from the memory provider. The map must be locked on read.
+Slab *DisjointPool::AllocImpl::findSlab(void *Ptr) {
     auto *SlabPtr = AlignPtrDown(Ptr, SlabMinSize());
 
-    // Lock the map on read
-    std::shared_lock<std::shared_timed_mutex> Lk(getKnownSlabsMapLock());
+    for (int Attempt = 0; Attempt < 2; Attempt++) {
+        auto Slabs = getKnownSlabs().equal_range(SlabPtr);
+        for (auto It = Slabs.first; It != Slabs.second; ++It) {
+            // The slab object won't be deleted until it's removed from the map
+            // which is protected by the lock, so it's safe to access it here.
+            auto &Slab = It->second;
+            if (Ptr >= Slab.getPtr() && Ptr < Slab.getEnd()) {
+                return &Slab;
+            }
+        }
+
+        // A slab larger than SlabMinSize is registered only by its beginning,
+        // but an aligned allocation may start further inside it - look it up
+        // by the base address of the provider's allocation.
+        umf_alloc_info_t allocInfo = {NULL, 0, NULL};
+        if (Attempt > 0 || Ptr == nullptr ||
+            umfMemoryTrackerGetAllocInfo(Ptr, &allocInfo) !=
+                UMF_RESULT_SUCCESS) {
+            break;
+        }
+
+        void *BasePtr = AlignPtrDown(allocInfo.base, SlabMinSize());
+        if (BasePtr == SlabPtr) {
+            break;
+        }
+        SlabPtr = BasePtr;
+    }
+
+    // There is a rare case when we have a pointer from system allocation next
+    // to some slab with an entry in the map. So we find a slab
+    // but the range checks fail.
+    return nullptr;
+}
+
+// Returns the chunked slab containing Ptr if it is in the slab index,
+// nullptr otherwise. The map does not have to be locked - the slab of
+// an allocated chunk is not removed from the index until the chunk is freed.
+Slab *DisjointPool::AllocImpl::findIndexedSlab(void *Ptr) {
+    if (!SlabIndex) {
+        return nullptr;
+    }
+
+    return static_cast<Slab *>(
+        critnib_get(SlabIndex.get(), reinterpret_cast<uintptr_t>(
+                                         AlignPtrDown(Ptr, SlabMinSize()))));
+}
 
+void DisjointPool::AllocImpl::deallocate(void *Ptr, bool &ToPool) {
     ToPool = false;
-    auto Slabs = getKnownSlabs().equal_range(SlabPtr);
-    if (Slabs.first == Slabs.second) {
-        Lk.unlock();
+    auto *SlabP = findIndexedSlab(Ptr);
+
+    if (!SlabP) {
+        // Lock the map on read, it is unlocked before freeing the chunk,
+        // as it may be locked on write there
+        std::shared_lock<std::shared_timed_mutex> Lk(getKnownSlabsMapLock());
+        SlabP = findSlab(Ptr);
+    }
+
+    if (!SlabP) {
         memoryProviderFree(getMemHandle(), Ptr);
         return;
     }
 
-    for (auto It = Slabs.first; It != Slabs.second; ++It) {
-        // The slab object won't be deleted until it's removed from the map which is
-        // protected by the lock, so it's safe to access it here.
-        auto &Slab = It->second;
-        if (Ptr >= Slab.getPtr() && Ptr < Slab.getEnd()) {
-            // Unlock the map before freeing the chunk, it may be locked on write
-            // there
-            Lk.unlock();
-            auto &Bucket = Slab.getBucket();
-
-            if (getParams().PoolTrace > 1) {
-                Bucket.countFree();
-            }
+    auto &Bucket = SlabP->getBucket();
 
-            VALGRIND_DO_MEMPOOL_FREE(this, Ptr);
-            annotate_memory_inaccessible(Ptr, Bucket.getSize());
-            if (Bucket.getSize() <= Bucket.ChunkCutOff()) {
-                Bucket.freeChunk(Ptr, Slab, ToPool);
-            } else {
-                Bucket.freeSlab(Slab, ToPool);
-            }
+    if (getParams().PoolTrace > 1) {
+        Bucket.countFree();
+    }
 
-            return;
-        }
+    VALGRIND_DO_MEMPOOL_FREE(this, Ptr);
+    annotate_memory_inaccessible(Ptr, Bucket.getSize());
+    if (Bucket.getSize() <= Bucket.ChunkCutOff()) {
+        Bucket.freeChunk(Ptr, *SlabP, ToPool);
+    } else {
+        Bucket.freeSlab(*SlabP, ToPool);
     }
+}
 
-    Lk.unlock();
-    // There is a rare case when we have a pointer from system allocation next
-    // to some slab with an entry in the map. So we find a slab
-    // but the range checks fail.
-    memoryProviderFree(getMemHandle(), Ptr);
+size_t DisjointPool::AllocImpl::getUsableSize(void *Ptr) {
+    auto *SlabP = findIndexedSlab(Ptr);
+
+    // Lock the map on read, unless the slab is found in the index
+    std::shared_lock<std::shared_timed_mutex> Lk(getKnownSlabsMapLock(),
+                                                 std::defer_lock);
+    if (!SlabP) {
+        Lk.lock();
+        SlabP = findSlab(Ptr);
+    }
+
+    if (SlabP) {
+        // the pointer may be aligned up within its chunk
+        size_t Offset =
+            static_cast<char *>(Ptr) - static_cast<char *>(SlabP->getPtr());
+        return SlabP->getChunkSize() - Offset % SlabP->getChunkSize();
+    }
+
+    if (Lk.owns_lock()) {
+        Lk.unlock();
+    }
+
+    // not pooled - an allocation of the provider
+    umf_alloc_info_t allocInfo = {NULL, 0, NULL};
+    if (umfMemoryTrackerGetAllocInfo(Ptr, &allocInfo) != UMF_RESULT_SUCCESS) {
+        return 0;
+    }
+
+    return allocInfo.baseSize - (static_cast<char *>(Ptr) -
+                                 static_cast<char *>(allocInfo.base));
 }
 
 void DisjointPool::AllocImpl::printStats(bool &TitlePrinted,
@@ -1071,9 +1190,12 @@ void *DisjointPool::aligned_malloc(size_t size, size_t alignment) {
     return Ptr;
 }
 
-size_t DisjointPool::malloc_usable_size(void *) {
-    // Not supported
-    return 0;
+size_t DisjointPool::malloc_usable_size(void *ptr) {
+    if (!ptr) {
+        return 0;
+    }
+
+    return impl->getUsableSize(ptr);
 }
 
 umf_result_t DisjointPool::free(void *ptr) try {
@@ -1105,7 +1227,7 @@ DisjointPool::~DisjointPool() {
     bool TitlePrinted = false;
     size_t HighBucketSize;
     size_t HighPeakSlabsInUse;
-    if (impl->getParams().PoolTrace > 1) {
+    if (impl && impl->getParams().PoolTrace > 1) {
         auto name = impl->getParams().Name;
         try { // cannot throw in destructor
             impl->printStats(TitlePrinted, HighBucketSize, HighPeakSlabsInUse,
@@ -1129,3 +1251,316 @@ static umf_memory_pool_ops_t UMF_DISJOINT_POOL_OPS =
 umf_memory_pool_ops_t *umfDisjointPoolOps(void) {
     return &UMF_DISJOINT_POOL_OPS;
 }
+
+// The NUMA-aware variant is a local node pool (see pool_local_node.h) of
+// Disjoint Pools, one per NUMA node. The chunks of the small size classes
+// freed by a thread are kept in a per-thread cache (of the thread's current
+// node) and reused without any lock.
+
+class NumaDisjointPool {
+  public:
+    umf_result_t initialize(umf_memory_provider_handle_t provider,
+                            umf_numa_disjoint_pool_params_t *parameters);
+    void *malloc(size_t size);
+    void *calloc(size_t, size_t);
+    void *realloc(void *, size_t);
+    void *aligned_malloc(size_t size, size_t alignment);
+    size_t malloc_usable_size(void *);
+    umf_result_t free(void *ptr);
+    umf_result_t get_last_allocation_error();
+
+    NumaDisjointPool() {}
+    ~NumaDisjointPool();
+
+    // Free chunks cached by one thread, per size class. The chunks belong to
+    // 'NodePool', the pool of the node 'Node'. 'Pool' is reset when the thread
+    // exits or the pool is destroyed, whichever comes first (under 'Lock').
+    struct ThreadCache {
+        std::atomic<NumaDisjointPool *> Pool;
+        std::mutex Lock;
+        int Node = -1;
+        umf_memory_pool_handle_t NodePool = nullptr;
+        std::vector<std::vector<void *>> Bins;
+    };
+
+  private:
+    bool sizeToClass(size_t Size, size_t &Class);
+
+    ThreadCache *getThreadCache();
+    void drainThreadCache(ThreadCache &Cache);
+    friend struct NumaThreadCaches;
+
+    umf_numa_disjoint_pool_params_t params;
+
+    // the local node pool of the Disjoint Pools of the NUMA nodes
+    umf_memory_pool_handle_t LocalPool = nullptr;
+
+    // sizes of the cached size classes (the bucket sizes)
+    std::vector<size_t> ClassSizes;
+
+    // caches of all threads which have used the pool
+    std::mutex ThreadCachesLock;
+    std::vector<std::shared_ptr<ThreadCache>> ThreadCaches;
+};
+
+// Thread caches of all the NUMA-aware pools used by the thread,
+// returned to their pools when the thread exits.
+struct NumaThreadCaches {
+    std::vector<std::shared_ptr<NumaDisjointPool::ThreadCache>> Caches;
+    NumaDisjointPool::ThreadCache *Last = nullptr;
+
+    ~NumaThreadCaches() {
+        for (auto &Cache : Caches) {
+            std::lock_guard<std::mutex> Lg(Cache->Lock);
+            auto *Pool = Cache->Pool.load(std::memory_order_relaxed);
+            if (Pool) {
+                Pool->drainThreadCache(*Cache);
+                Cache->Pool.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+static thread_local NumaThreadCaches TLS_numaThreadCaches;
+
+umf_result_t
+NumaDisjointPool::initialize(umf_memory_provider_handle_t provider,
+                             umf_numa_disjoint_pool_params_t *parameters) {
+    if (!parameters) {
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    params = *parameters;
+
+    umf_local_node_pool_params_t localParams =
+        umfLocalNodePoolParamsDefault(umfDisjointPoolOps(), &params.NodeParams);
+    umf_result_t ret =
+        umfPoolCreate(umfLocalNodePoolOps(), provider, &localParams,
+                      UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &LocalPool);
+    if (ret != UMF_RESULT_SUCCESS) {
+        LOG_ERR("NumaDisjointPool: creating the local node pool failed");
+        return ret;
+    }
+
+    // Cache only the chunks of the bucket sizes (MinBucketSize * 2^n and
+    // 1.5 * MinBucketSize * 2^n), so any cached chunk fits any allocation
+    // of its class. They are chunks of slabs (not whole slabs), so free()
+    // finds their size in the slab index of the node pool, without a lock.
+    size_t MaxSize = std::min({params.ThreadCacheMaxSize,
+                               params.NodeParams.MaxPoolableSize,
+                               params.NodeParams.SlabMinSize / 2});
+    size_t Size = std::max(params.NodeParams.MinBucketSize,
+                           UMF_DISJOINT_POOL_MIN_BUCKET_DEFAULT_SIZE);
+    for (; Size <= MaxSize; Size *= 2) {
+        ClassSizes.push_back(Size);
+        if (Size + Size / 2 <= MaxSize) {
+            ClassSizes.push_back(Size + Size / 2);
+        }
+    }
+
+    return UMF_RESULT_SUCCESS;
+}
+
+NumaDisjointPool::~NumaDisjointPool() {
+    // the pool is not used by any thread any more
+    for (auto &Cache : ThreadCaches) {
+        std::lock_guard<std::mutex> Lg(Cache->Lock);
+        if (Cache->Pool.load(std::memory_order_relaxed) == this) {
+            drainThreadCache(*Cache);
+            Cache->Pool.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    if (LocalPool) {
+        umfPoolDestroy(LocalPool);
+    }
+}
+
+// the smallest cached size class >= Size
+bool NumaDisjointPool::sizeToClass(size_t Size, size_t &Class) {
+    auto It = std::lower_bound(ClassSizes.begin(), ClassSizes.end(), Size);
+    if (Size == 0 || It == ClassSizes.end()) {
+        return false;
+    }
+
+    Class = It - ClassSizes.begin();
+    return true;
+}
+
+NumaDisjointPool::ThreadCache *NumaDisjointPool::getThreadCache() try {
+    auto &TlsCaches = TLS_numaThreadCaches;
+    if (TlsCaches.Last &&
+        TlsCaches.Last->Pool.load(std::memory_order_relaxed) == this) {
+        return TlsCaches.Last;
+    }
+
+    for (auto &Cache : TlsCaches.Caches) {
+        if (Cache->Pool.load(std::memory_order_relaxed) == this) {
+            TlsCaches.Last = Cache.get();
+            return TlsCaches.Last;
+        }
+    }
+
+    auto Cache = std::make_shared<ThreadCache>();
+    Cache->Pool.store(this, std::memory_order_relaxed);
+    Cache->Bins.resize(ClassSizes.size());
+    for (auto &Bin : Cache->Bins) {
+        Bin.reserve(params.ThreadCacheSize);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lg(ThreadCachesLock);
+        // forget the caches of the threads which have exited
+        ThreadCaches.erase(
+            std::remove_if(ThreadCaches.begin(), ThreadCaches.end(),
+                           [](auto &C) { return C->Pool.load() == nullptr; }),
+            ThreadCaches.end());
+        ThreadCaches.push_back(Cache);
+    }
+
+    // forget the caches of the pools which have been destroyed
+    TlsCaches.Caches.erase(
+        std::remove_if(TlsCaches.Caches.begin(), TlsCaches.Caches.end(),
+                       [](auto &C) { return C->Pool.load() == nullptr; }),
+        TlsCaches.Caches.end());
+    TlsCaches.Caches.push_back(Cache);
+    TlsCaches.Last = Cache.get();
+
+    return TlsCaches.Last;
+} catch (...) {
+    return nullptr;
+}
+
+void NumaDisjointPool::drainThreadCache(ThreadCache &Cache) {
+    for (auto &Bin : Cache.Bins) {
+        for (auto *Ptr : Bin) {
+            umfPoolFree(Cache.NodePool, Ptr);
+        }
+        Bin.clear();
+    }
+}
+
+void *NumaDisjointPool::malloc(size_t size) {
+    umf_memory_pool_handle_t hPool = nullptr;
+    int Node = umfLocalNodePoolGetLocalNode(LocalPool, &hPool);
+
+    size_t Class;
+    ThreadCache *Cache = nullptr;
+    if (Node >= 0 && params.ThreadCacheSize && sizeToClass(size, Class)) {
+        Cache = getThreadCache();
+    }
+
+    if (Cache) {
+        if (Cache->Node != Node) {
+            // the thread has been migrated
+            drainThreadCache(*Cache);
+            Cache->Node = Node;
+            Cache->NodePool = hPool;
+        }
+
+        auto &Bin = Cache->Bins[Class];
+        if (Bin.empty()) {
+            // refill a half of the cache
+            size_t Refill = std::max(params.ThreadCacheSize / 2, (size_t)1);
+            for (size_t i = 0; i < Refill; i++) {
+                void *Ptr = umfPoolMalloc(hPool, ClassSizes[Class]);
+                if (!Ptr) {
+                    break;
+                }
+                Bin.push_back(Ptr);
+            }
+        }
+
+        if (!Bin.empty()) {
+            void *Ptr = Bin.back();
+            Bin.pop_back();
+            return Ptr;
+        }
+    }
+
+    void *Ptr = umfPoolMalloc(hPool, size);
+    if (!Ptr) {
+        umf::getPoolLastStatusRef<NumaDisjointPool>() =
+            umfPoolGetLastAllocationError(hPool);
+    }
+
+    return Ptr;
+}
+
+void *NumaDisjointPool::calloc(size_t, size_t) {
+    // Not supported
+    umf::getPoolLastStatusRef<NumaDisjointPool>() =
+        UMF_RESULT_ERROR_NOT_SUPPORTED;
+    return NULL;
+}
+
+void *NumaDisjointPool::realloc(void *, size_t) {
+    // Not supported
+    umf::getPoolLastStatusRef<NumaDisjointPool>() =
+        UMF_RESULT_ERROR_NOT_SUPPORTED;
+    return NULL;
+}
+
+void *NumaDisjointPool::aligned_malloc(size_t size, size_t alignment) {
+    void *Ptr = umfPoolAlignedMalloc(LocalPool, size, alignment);
+    if (!Ptr) {
+        umf::getPoolLastStatusRef<NumaDisjointPool>() =
+            umfPoolGetLastAllocationError(LocalPool);
+    }
+
+    return Ptr;
+}
+
+size_t NumaDisjointPool::malloc_usable_size(void *ptr) {
+    return umfPoolMallocUsableSize(LocalPool, ptr);
+}
+
+umf_result_t NumaDisjointPool::free(void *ptr) {
+    if (!ptr) {
+        return UMF_RESULT_SUCCESS;
+    }
+
+    umf_memory_pool_handle_t hPool = nullptr;
+    int Node = umfLocalNodePoolGetNodeOf(LocalPool, ptr, &hPool);
+    if (Node < 0) {
+        return umfPoolFree(hPool, ptr);
+    }
+
+    ThreadCache *Cache = nullptr;
+    if (params.ThreadCacheSize) {
+        Cache = getThreadCache();
+    }
+
+    // only the chunks of the thread's node are cached,
+    // so the thread keeps allocating the local memory
+    if (Cache && Cache->Node == Node) {
+        size_t Size = umfPoolMallocUsableSize(hPool, ptr);
+        size_t Class;
+        if (sizeToClass(Size, Class) && ClassSizes[Class] == Size) {
+            auto &Bin = Cache->Bins[Class];
+            if (Bin.size() >= params.ThreadCacheSize) {
+                // return the older half to the pool
+                size_t Flush = std::max(Bin.size() / 2, (size_t)1);
+                for (size_t i = 0; i < Flush; i++) {
+                    umfPoolFree(hPool, Bin[i]);
+                }
+                Bin.erase(Bin.begin(), Bin.begin() + Flush);
+            }
+            Bin.push_back(ptr);
+            return UMF_RESULT_SUCCESS;
+        }
+    }
+
+    return umfPoolFree(hPool, ptr);
+}
+
+umf_result_t NumaDisjointPool::get_last_allocation_error() {
+    return umf::getPoolLastStatusRef<NumaDisjointPool>();
+}
+
+static umf_memory_pool_ops_t UMF_NUMA_DISJOINT_POOL_OPS =
+    umf::poolMakeCOps<NumaDisjointPool, umf_numa_disjoint_pool_params_t>();
+
+umf_memory_pool_ops_t *umfNumaDisjointPoolOps(void) {
+    return &UMF_NUMA_DISJOINT_POOL_OPS;
+}
@@ -411,6 +411,52 @@ static void *op_aligned_alloc(void *pool, size_t size, size_t alignment) {
     return ptr;
 }
 
+// Allocates the pool struct from the provider, so that it is placed on
+// the node of the pool's memory (the base allocator places it wherever
+// the creating thread runs). Falls back to the base allocator.
+static jemalloc_memory_pool_t *
+jemalloc_pool_metadata_alloc(umf_memory_provider_handle_t provider) {
+    size_t size =
+        ALIGN_UP(sizeof(jemalloc_memory_pool_t), utils_get_page_size());
+    void *ptr = NULL;
+
+    umf_result_t ret = umfMemoryProviderAlloc(provider, size, 0, &ptr);
+    if (ret == UMF_RESULT_SUCCESS && ptr &&
+        IS_ALIGNED((uintptr_t)ptr, JEMALLOC_POOL_CACHE_LINE_SIZE)) {
+        jemalloc_memory_pool_t *pool = ptr;
+        utils_annotate_memory_defined(pool, sizeof(*pool));
+        memset(pool, 0, sizeof(*pool));
+        pool->metadata_size = size;
+        return pool;
+    }
+
+    if (ret == UMF_RESULT_SUCCESS && ptr) {
+        umfMemoryProviderFree(provider, ptr, size);
+    }
+
+    LOG_DEBUG("cannot allocate the pool metadata from the memory provider, "
+              "using the base allocator");
+
+    jemalloc_memory_pool_t *pool = umf_ba_global_aligned_alloc(
+        sizeof(jemalloc_memory_pool_t), JEMALLOC_POOL_CACHE_LINE_SIZE);
+    if (pool) {
+        pool->metadata_size = 0;
+    }
+
+    return pool;
+}
+
+static void jemalloc_pool_metadata_free(jemalloc_memory_pool_t *pool) {
+    if (pool->metadata_size == 0) {
+        umf_ba_global_free(pool);
+        return;
+    }
+
+    if (!pool->disable_provider_free) {
+        umfMemoryProviderFree(pool->provider, pool, pool->metadata_size);
+    }
+}
+
 static umf_result_t op_initialize(umf_memory_provider_handle_t provider,
                                   void *params, void **out_pool) {
     assert(provider);
@@ -423,8 +469,7 @@ static umf_result_t op_initialize(umf_memory_provider_handle_t provider,
     size_t unsigned_size = sizeof(unsigned);
     int err;
 
-    jemalloc_memory_pool_t *pool =
-        umf_ba_global_alloc(sizeof(jemalloc_memory_pool_t));
+    jemalloc_memory_pool_t *pool = jemalloc_pool_metadata_alloc(provider);
     if (!pool) {
         return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
     }
@@ -482,7 +527,7 @@ static umf_result_t op_initialize(umf_memory_provider_handle_t provider,
 err_free_pool:
 	assert(false && "Failed to create a pool, error checking not implemented");
 	exit(-1);
-    umf_ba_global_free(pool);
+    jemalloc_pool_metadata_free(pool);
     return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
 }
 
@@ -501,9 +546,9 @@ static void op_finalize(void *pool) {
 		je_mallctl("tcache.destroy",NULL,0,&tcache,sz);
 	}
 	
-    umf_ba_global_free(je_pool);
-
     VALGRIND_DO_DESTROY_MEMPOOL(pool);
+
+    jemalloc_pool_metadata_free(je_pool);
 }
 
 static size_t op_malloc_usable_size(void *pool, void *ptr) {
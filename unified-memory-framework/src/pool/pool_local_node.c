@@ -0,0 +1,352 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ */
+
+#include <umf/memory_pool_ops.h>
+#include <umf/memspace.h>
+#include <umf/memtarget.h>
+#include <umf/pools/pool_local_node.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include "base_alloc_global.h"
+#include "memory_pool_internal.h"
+#include "utils_common.h"
+#include "utils_log.h"
+
+static __TLS umf_result_t TLS_last_allocation_error;
+
+// The node of the calling thread is cached (and shared by all the local
+// node pools) - it is read again every node_refresh_period allocations.
+static __TLS int TLS_numa_node = -1;
+static __TLS unsigned TLS_numa_node_countdown = 0;
+
+struct local_node_memory_pool {
+    // pools indexed by the NUMA node ID (NULL if there is no such node)
+    umf_memory_pool_handle_t *node_pools;
+    size_t node_pools_len;
+
+    // the pool on the provider given at creation - used if the node
+    // of the calling thread is unknown. It is not tracked on its own
+    // (the provider is tracked already unless the local node pool
+    // was created with UMF_POOL_CREATE_FLAG_DISABLE_TRACKING).
+    umf_memory_pool_handle_t default_pool;
+
+    unsigned node_refresh_period;
+};
+
+static void local_node_destroy_pools(struct local_node_memory_pool *pool) {
+    for (size_t i = 0; i < pool->node_pools_len; i++) {
+        if (pool->node_pools[i]) {
+            umfPoolDestroy(pool->node_pools[i]);
+        }
+    }
+
+    if (pool->node_pools) {
+        umf_ba_global_free(pool->node_pools);
+    }
+}
+
+// creates a pool bound to every NUMA node of the host
+static umf_result_t
+local_node_create_pools(struct local_node_memory_pool *pool,
+                        umf_local_node_pool_params_t *params) {
+    umf_const_memspace_handle_t hostAll = umfMemspaceHostAllGet();
+    size_t n_nodes = hostAll ? umfMemspaceMemtargetNum(hostAll) : 0;
+    if (n_nodes == 0 || umfOsMemoryProviderOps() == NULL) {
+        LOG_INFO("cannot get the NUMA nodes of the host, the local node pool "
+                 "uses only the pool of the given memory provider");
+        return UMF_RESULT_SUCCESS;
+    }
+
+    unsigned max_node = 0;
+    for (size_t i = 0; i < n_nodes; i++) {
+        unsigned node = 0;
+        umfMemtargetGetId(umfMemspaceMemtargetGet(hostAll, (unsigned)i),
+                          &node);
+        if (node > max_node) {
+            max_node = node;
+        }
+    }
+
+    pool->node_pools_len = (size_t)max_node + 1;
+    pool->node_pools = umf_ba_global_alloc(pool->node_pools_len *
+                                           sizeof(umf_memory_pool_handle_t));
+    if (!pool->node_pools) {
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memset(pool->node_pools, 0,
+           pool->node_pools_len * sizeof(umf_memory_pool_handle_t));
+
+    umf_os_memory_provider_params_t os_params =
+        params->node_provider_params ? *params->node_provider_params
+                                     : umfOsMemoryProviderParamsDefault();
+    os_params.numa_mode = UMF_NUMA_MODE_BIND;
+    os_params.numa_list_len = 1;
+
+    for (size_t i = 0; i < n_nodes; i++) {
+        unsigned node = 0;
+        umfMemtargetGetId(umfMemspaceMemtargetGet(hostAll, (unsigned)i),
+                          &node);
+        os_params.numa_list = &node;
+
+        umf_memory_provider_handle_t hProvider = NULL;
+        umf_result_t ret = umfMemoryProviderCreate(umfOsMemoryProviderOps(),
+                                                   &os_params, &hProvider);
+        if (ret != UMF_RESULT_SUCCESS) {
+            LOG_ERR("creating the memory provider of NUMA node %u failed",
+                    node);
+            goto err_destroy_pools;
+        }
+
+        // the pools are tracked - free() finds the owner of a pointer
+        ret = umfPoolCreate(params->node_pool_ops, hProvider,
+                            params->node_pool_params,
+                            UMF_POOL_CREATE_FLAG_OWN_PROVIDER,
+                            &pool->node_pools[node]);
+        if (ret != UMF_RESULT_SUCCESS) {
+            LOG_ERR("creating the pool of NUMA node %u failed", node);
+            umfMemoryProviderDestroy(hProvider);
+            goto err_destroy_pools;
+        }
+    }
+
+    return UMF_RESULT_SUCCESS;
+
+err_destroy_pools:
+    local_node_destroy_pools(pool);
+    pool->node_pools = NULL;
+    pool->node_pools_len = 0;
+    return UMF_RESULT_ERROR_UNKNOWN;
+}
+
+static umf_result_t
+local_node_pool_initialize(umf_memory_provider_handle_t hProvider,
+                           void *params, void **ppPool) {
+    umf_local_node_pool_params_t *in_params =
+        (umf_local_node_pool_params_t *)params;
+    if (!in_params || !in_params->node_pool_ops) {
+        LOG_ERR("the ops of the node pools are not set");
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    struct local_node_memory_pool *pool =
+        umf_ba_global_alloc(sizeof(struct local_node_memory_pool));
+    if (!pool) {
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    pool->node_refresh_period = in_params->node_refresh_period;
+
+    umf_result_t ret = umfPoolCreate(
+        in_params->node_pool_ops, hProvider, in_params->node_pool_params,
+        UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &pool->default_pool);
+    if (ret != UMF_RESULT_SUCCESS) {
+        LOG_ERR("creating the default pool failed");
+        goto err_free_pool;
+    }
+
+    ret = local_node_create_pools(pool, in_params);
+    if (ret != UMF_RESULT_SUCCESS) {
+        goto err_destroy_default_pool;
+    }
+
+    *ppPool = (void *)pool;
+
+    return UMF_RESULT_SUCCESS;
+
+err_destroy_default_pool:
+    umfPoolDestroy(pool->default_pool);
+err_free_pool:
+    umf_ba_global_free(pool);
+    return ret;
+}
+
+static void local_node_pool_finalize(void *pool) {
+    struct local_node_memory_pool *hPool =
+        (struct local_node_memory_pool *)pool;
+
+    local_node_destroy_pools(hPool);
+    umfPoolDestroy(hPool->default_pool);
+    umf_ba_global_free(hPool);
+}
+
+// the node of the calling thread if the pool has a pool on it, -1 otherwise
+static inline int local_node_current(struct local_node_memory_pool *pool) {
+    if (TLS_numa_node_countdown == 0) {
+        TLS_numa_node_countdown = pool->node_refresh_period;
+        TLS_numa_node = utils_get_current_numa_node();
+    } else {
+        TLS_numa_node_countdown--;
+    }
+
+    if (TLS_numa_node >= 0 && (size_t)TLS_numa_node < pool->node_pools_len &&
+        pool->node_pools[TLS_numa_node]) {
+        return TLS_numa_node;
+    }
+
+    return -1;
+}
+
+// the pool to allocate from
+static inline umf_memory_pool_handle_t
+local_node_pool_alloc(struct local_node_memory_pool *pool) {
+    int node = local_node_current(pool);
+    return node < 0 ? pool->default_pool : pool->node_pools[node];
+}
+
+// the node whose pool owns the given pointer (the node pools are tracked),
+// -1 if it is the default pool
+static int local_node_of_ptr(struct local_node_memory_pool *pool,
+                             const void *ptr) {
+    umf_memory_pool_handle_t owner = umfPoolByPtr(ptr);
+    if (owner) {
+        for (size_t i = 0; i < pool->node_pools_len; i++) {
+            if (owner == pool->node_pools[i]) {
+                return (int)i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+// the pool owning the given pointer
+static umf_memory_pool_handle_t
+local_node_pool_of_ptr(struct local_node_memory_pool *pool, void *ptr) {
+    int node = local_node_of_ptr(pool, ptr);
+    return node < 0 ? pool->default_pool : pool->node_pools[node];
+}
+
+static inline void *local_node_result(umf_memory_pool_handle_t hPool,
+                                      void *ptr) {
+    TLS_last_allocation_error = ptr ? UMF_RESULT_SUCCESS
+                                    : umfPoolGetLastAllocationError(hPool);
+    return ptr;
+}
+
+static void *local_node_malloc(void *pool, size_t size) {
+    assert(pool);
+
+    umf_memory_pool_handle_t hPool =
+        local_node_pool_alloc((struct local_node_memory_pool *)pool);
+    return local_node_result(hPool, umfPoolMalloc(hPool, size));
+}
+
+static void *local_node_calloc(void *pool, size_t num, size_t size) {
+    assert(pool);
+
+    umf_memory_pool_handle_t hPool =
+        local_node_pool_alloc((struct local_node_memory_pool *)pool);
+    return local_node_result(hPool, umfPoolCalloc(hPool, num, size));
+}
+
+static void *local_node_aligned_malloc(void *pool, size_t size,
+                                       size_t alignment) {
+    assert(pool);
+
+    umf_memory_pool_handle_t hPool =
+        local_node_pool_alloc((struct local_node_memory_pool *)pool);
+    return local_node_result(hPool,
+                             umfPoolAlignedMalloc(hPool, size, alignment));
+}
+
+// The memory stays on the node it was allocated on.
+static void *local_node_realloc(void *pool, void *ptr, size_t size) {
+    assert(pool);
+
+    if (!ptr) {
+        return local_node_malloc(pool, size);
+    }
+
+    umf_memory_pool_handle_t hPool =
+        local_node_pool_of_ptr((struct local_node_memory_pool *)pool, ptr);
+    return local_node_result(hPool, umfPoolRealloc(hPool, ptr, size));
+}
+
+static size_t local_node_malloc_usable_size(void *pool, void *ptr) {
+    assert(pool);
+
+    umf_memory_pool_handle_t hPool =
+        local_node_pool_of_ptr((struct local_node_memory_pool *)pool, ptr);
+    return umfPoolMallocUsableSize(hPool, ptr);
+}
+
+static umf_result_t local_node_free(void *pool, void *ptr) {
+    assert(pool);
+
+    if (!ptr) {
+        return UMF_RESULT_SUCCESS;
+    }
+
+    umf_memory_pool_handle_t hPool =
+        local_node_pool_of_ptr((struct local_node_memory_pool *)pool, ptr);
+    return umfPoolFree(hPool, ptr);
+}
+
+static umf_result_t local_node_get_last_allocation_error(void *pool) {
+    (void)pool; // not used
+    return TLS_last_allocation_error;
+}
+
+static umf_memory_pool_ops_t UMF_LOCAL_NODE_POOL_OPS = {
+    .version = UMF_VERSION_CURRENT,
+    .initialize = local_node_pool_initialize,
+    .finalize = local_node_pool_finalize,
+    .malloc = local_node_malloc,
+    .calloc = local_node_calloc,
+    .realloc = local_node_realloc,
+    .aligned_malloc = local_node_aligned_malloc,
+    .malloc_usable_size = local_node_malloc_usable_size,
+    .free = local_node_free,
+    .get_last_allocation_error = local_node_get_last_allocation_error};
+
+umf_memory_pool_ops_t *umfLocalNodePoolOps(void) {
+    return &UMF_LOCAL_NODE_POOL_OPS;
+}
+
+static struct local_node_memory_pool *
+local_node_pool_priv(umf_memory_pool_handle_t hPool) {
+    if (!hPool || hPool->ops.initialize != local_node_pool_initialize) {
+        return NULL;
+    }
+
+    return (struct local_node_memory_pool *)hPool->pool_priv;
+}
+
+int umfLocalNodePoolGetLocalNode(umf_memory_pool_handle_t hPool,
+                                 umf_memory_pool_handle_t *hNodePool) {
+    struct local_node_memory_pool *pool = local_node_pool_priv(hPool);
+    if (!pool) {
+        return -1;
+    }
+
+    int node = local_node_current(pool);
+    if (hNodePool) {
+        *hNodePool = node < 0 ? pool->default_pool : pool->node_pools[node];
+    }
+
+    return node;
+}
+
+int umfLocalNodePoolGetNodeOf(umf_memory_pool_handle_t hPool, const void *ptr,
+                              umf_memory_pool_handle_t *hNodePool) {
+    struct local_node_memory_pool *pool = local_node_pool_priv(hPool);
+    if (!pool) {
+        return -1;
+    }
+
+    int node = local_node_of_ptr(pool, ptr);
+    if (hNodePool) {
+        *hNodePool = node < 0 ? pool->default_pool : pool->node_pools[node];
+    }
+
+    return node;
+}
@@ -28,6 +28,49 @@
      ((uintptr_t)(block)->data + (block)->size <=                              \
       (uintptr_t)(origin)->data + (origin)->size))
 
+// number of size-class bins of a shard (one bin per power of two)
+#define COARSE_SHARD_NUM_BINS 64
+
+// maximum number of blocks cached in one size-class bin of a shard
+#define COARSE_SHARD_BIN_CAPACITY 8
+
+// A block freed by the user and cached in a shard.
+// It is still marked as used in the all_blocks tree.
+typedef struct coarse_cached_block_t {
+    void *data;
+    size_t size;
+} coarse_cached_block_t;
+
+// An allocated block in the live block table of a shard (data == 0 - empty).
+typedef struct coarse_live_block_t {
+    uintptr_t data;
+    size_t size;
+} coarse_live_block_t;
+
+// Size-class bin of a shard - a LIFO of cached blocks
+// of sizes in the range [2^i, 2^(i+1)).
+typedef struct coarse_shard_bin_t {
+    size_t count;
+    coarse_cached_block_t blocks[COARSE_SHARD_BIN_CAPACITY];
+} coarse_shard_bin_t;
+
+// Shard - segregated free lists of blocks freed by a subset of threads,
+// waiting to be reused or coalesced in the central trees (deferred coalescing).
+//
+// A shard also owns the table of the allocated blocks whose address maps to it
+// (see coarse_shard_of()), so a free is validated under the lock of a single
+// shard. A used block of the all_blocks tree without an entry in the table
+// is cached in a shard (or is just being taken out of it).
+typedef struct coarse_shard_t {
+    utils_mutex_t lock;
+    coarse_shard_bin_t bins[COARSE_SHARD_NUM_BINS];
+
+    // open addressing hash table (linear probing), at most half full
+    coarse_live_block_t *live;
+    size_t live_capacity; // a power of 2 or 0
+    size_t live_count;
+} coarse_shard_t;
+
 typedef struct coarse_memory_provider_t {
     umf_memory_provider_handle_t upstream_memory_provider;
 
@@ -55,6 +98,11 @@ typedef struct coarse_memory_provider_t {
 
     struct utils_mutex_t lock;
 
+    // shards caching freed blocks (NULL if num_shards == 0),
+    // lock ordering: coarse_provider->lock before shard->lock
+    coarse_shard_t **shards;
+    size_t num_shards;
+
     // Name of the provider with the upstream provider:
     // "coarse (<name_of_upstream_provider>)"
     // for example: "coarse (L0)"
@@ -796,14 +844,194 @@ static bool debug_check(coarse_memory_provider_t *provider) {
 }
 #endif /* NDEBUG */ // end of DEBUG code
 
+static coarse_shard_t *coarse_shard_of(coarse_memory_provider_t *coarse_provider,
+                                       const void *ptr) {
+    // Fibonacci hashing - the low bits of the addresses are mostly zeros
+    uint64_t hash = (uint64_t)(uintptr_t)ptr * 11400714819323198485ull;
+    return coarse_provider->shards[(hash >> 48) % coarse_provider->num_shards];
+}
+
+static inline size_t coarse_live_slot(uintptr_t data, size_t capacity) {
+    // other bits of the hash than the ones picking the shard
+    uint64_t hash = (uint64_t)data * 11400714819323198485ull;
+    return (size_t)(hash >> 16) & (capacity - 1);
+}
+
+// coarse_live_find - the entry of the block or NULL.
+// The shard->lock has to be held.
+static coarse_live_block_t *coarse_live_find(coarse_shard_t *shard,
+                                             uintptr_t data) {
+    if (shard->live_capacity == 0) {
+        return NULL;
+    }
+
+    size_t mask = shard->live_capacity - 1;
+    for (size_t i = coarse_live_slot(data, shard->live_capacity);
+         shard->live[i].data != 0; i = (i + 1) & mask) {
+        if (shard->live[i].data == data) {
+            return &shard->live[i];
+        }
+    }
+
+    return NULL;
+}
+
+// coarse_live_put - put a block which is not in the table yet into a free slot
+static void coarse_live_put(coarse_live_block_t *live, size_t capacity,
+                            uintptr_t data, size_t size) {
+    size_t i = coarse_live_slot(data, capacity);
+    while (live[i].data != 0) {
+        i = (i + 1) & (capacity - 1);
+    }
+    live[i].data = data;
+    live[i].size = size;
+}
+
+// coarse_live_insert - add the block to the table or update its size.
+// The shard->lock has to be held.
+static umf_result_t coarse_live_insert(coarse_shard_t *shard, uintptr_t data,
+                                       size_t size) {
+    coarse_live_block_t *entry = coarse_live_find(shard, data);
+    if (entry) {
+        entry->size = size;
+        return UMF_RESULT_SUCCESS;
+    }
+
+    if (2 * (shard->live_count + 1) > shard->live_capacity) {
+        size_t capacity = shard->live_capacity ? 2 * shard->live_capacity : 64;
+        coarse_live_block_t *live =
+            umf_ba_global_alloc(capacity * sizeof(*live));
+        if (live == NULL) {
+            return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        memset(live, 0, capacity * sizeof(*live));
+
+        for (size_t i = 0; i < shard->live_capacity; i++) {
+            if (shard->live[i].data != 0) {
+                coarse_live_put(live, capacity, shard->live[i].data,
+                                shard->live[i].size);
+            }
+        }
+
+        umf_ba_global_free(shard->live);
+        shard->live = live;
+        shard->live_capacity = capacity;
+    }
+
+    coarse_live_put(shard->live, shard->live_capacity, data, size);
+    shard->live_count++;
+
+    return UMF_RESULT_SUCCESS;
+}
+
+// coarse_live_erase - remove the entry (backward shift deletion).
+// The shard->lock has to be held.
+static void coarse_live_erase(coarse_shard_t *shard,
+                              coarse_live_block_t *entry) {
+    size_t mask = shard->live_capacity - 1;
+    size_t i = (size_t)(entry - shard->live);
+    size_t j = i;
+
+    for (;;) {
+        j = (j + 1) & mask;
+        if (shard->live[j].data == 0) {
+            break;
+        }
+
+        // move the entry of slot j to the hole at i unless its home
+        // slot k lies cyclically in (i, j]
+        size_t k = coarse_live_slot(shard->live[j].data, shard->live_capacity);
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            shard->live[i] = shard->live[j];
+            i = j;
+        }
+    }
+
+    shard->live[i].data = 0;
+    shard->live[i].size = 0;
+    shard->live_count--;
+}
+
+// coarse_live_add - record the allocated block in the table of its shard
+// (or update its size)
+static umf_result_t coarse_live_add(coarse_memory_provider_t *coarse_provider,
+                                    void *ptr, size_t size) {
+    if (coarse_provider->num_shards == 0) {
+        return UMF_RESULT_SUCCESS;
+    }
+
+    coarse_shard_t *shard = coarse_shard_of(coarse_provider, ptr);
+    if (utils_mutex_lock(&shard->lock) != 0) {
+        LOG_ERR("locking the shard lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    umf_result_t umf_result = coarse_live_insert(shard, (uintptr_t)ptr, size);
+
+    utils_mutex_unlock(&shard->lock);
+
+    return umf_result;
+}
+
+// coarse_live_remove - remove the block from the table of its shard,
+// false if it was not there (the block is cached in a shard)
+static bool coarse_live_remove(coarse_memory_provider_t *coarse_provider,
+                               void *ptr) {
+    if (coarse_provider->num_shards == 0) {
+        return true;
+    }
+
+    coarse_shard_t *shard = coarse_shard_of(coarse_provider, ptr);
+    if (utils_mutex_lock(&shard->lock) != 0) {
+        LOG_ERR("locking the shard lock failed");
+        return false;
+    }
+
+    coarse_live_block_t *entry = coarse_live_find(shard, (uintptr_t)ptr);
+    if (entry) {
+        coarse_live_erase(shard, entry);
+    }
+
+    utils_mutex_unlock(&shard->lock);
+
+    return entry != NULL;
+}
+
+// coarse_live_contains - false if the used block is cached in a shard
+static bool coarse_live_contains(coarse_memory_provider_t *coarse_provider,
+                                 void *ptr) {
+    if (coarse_provider->num_shards == 0) {
+        return true;
+    }
+
+    coarse_shard_t *shard = coarse_shard_of(coarse_provider, ptr);
+    if (utils_mutex_lock(&shard->lock) != 0) {
+        LOG_ERR("locking the shard lock failed");
+        return false;
+    }
+
+    bool found = coarse_live_find(shard, (uintptr_t)ptr) != NULL;
+
+    utils_mutex_unlock(&shard->lock);
+
+    return found;
+}
+
 static umf_result_t
 coarse_add_upstream_block(coarse_memory_provider_t *coarse_provider, void *addr,
                           size_t size) {
     ravl_node_t *alloc_node = NULL;
 
+    umf_result_t umf_result = coarse_live_add(coarse_provider, addr, size);
+    if (umf_result != UMF_RESULT_SUCCESS) {
+        return umf_result;
+    }
+
     block_t *alloc = coarse_ravl_add_new(coarse_provider->upstream_blocks, addr,
                                          size, &alloc_node);
     if (alloc == NULL) {
+        coarse_live_remove(coarse_provider, addr);
         return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
     }
 
@@ -811,6 +1039,7 @@ coarse_add_upstream_block(coarse_memory_provider_t *coarse_provider, void *addr,
         coarse_ravl_add_new(coarse_provider->all_blocks, addr, size, NULL);
     if (new_block == NULL) {
         coarse_ravl_rm(coarse_provider->upstream_blocks, addr);
+        coarse_live_remove(coarse_provider, addr);
         return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
     }
 
@@ -861,6 +1090,71 @@ static umf_result_t coarse_memory_provider_alloc(void *provider, size_t size,
 static umf_result_t coarse_memory_provider_free(void *provider, void *ptr,
                                                 size_t bytes);
 
+// needed for coarse_memory_provider_alloc()
+static void *coarse_shard_alloc(coarse_memory_provider_t *coarse_provider,
+                                size_t size, size_t alignment);
+
+// needed for coarse_memory_provider_alloc()
+static void coarse_drain_shards(coarse_memory_provider_t *coarse_provider);
+
+// needed for coarse_memory_provider_alloc()
+static umf_result_t coarse_free_block(coarse_memory_provider_t *coarse_provider,
+                                      void *ptr, size_t bytes);
+
+static umf_result_t
+coarse_shards_create(coarse_memory_provider_t *coarse_provider,
+                     size_t num_shards) {
+    coarse_provider->shards =
+        umf_ba_global_alloc(num_shards * sizeof(*coarse_provider->shards));
+    if (coarse_provider->shards == NULL) {
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    for (size_t i = 0; i < num_shards; i++) {
+        // each shard is allocated separately to not share cache lines
+        coarse_shard_t *shard = umf_ba_global_alloc(sizeof(*shard));
+        if (shard == NULL) {
+            goto err_free_shards;
+        }
+
+        memset(shard, 0, sizeof(*shard));
+        if (utils_mutex_init(&shard->lock) == NULL) {
+            umf_ba_global_free(shard);
+            goto err_free_shards;
+        }
+
+        coarse_provider->shards[i] = shard;
+        coarse_provider->num_shards = i + 1;
+    }
+
+    return UMF_RESULT_SUCCESS;
+
+err_free_shards:
+    LOG_ERR("shard initialization failed");
+    for (size_t i = 0; i < coarse_provider->num_shards; i++) {
+        utils_mutex_destroy_not_free(&coarse_provider->shards[i]->lock);
+        umf_ba_global_free(coarse_provider->shards[i]->live);
+        umf_ba_global_free(coarse_provider->shards[i]);
+    }
+    umf_ba_global_free(coarse_provider->shards);
+    coarse_provider->shards = NULL;
+    coarse_provider->num_shards = 0;
+    return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+}
+
+// coarse_shards_destroy - the shards have to be drained before
+static void coarse_shards_destroy(coarse_memory_provider_t *coarse_provider) {
+    for (size_t i = 0; i < coarse_provider->num_shards; i++) {
+        utils_mutex_destroy_not_free(&coarse_provider->shards[i]->lock);
+        umf_ba_global_free(coarse_provider->shards[i]->live);
+        umf_ba_global_free(coarse_provider->shards[i]);
+    }
+
+    umf_ba_global_free(coarse_provider->shards);
+    coarse_provider->shards = NULL;
+    coarse_provider->num_shards = 0;
+}
+
 static umf_result_t coarse_memory_provider_initialize(void *params,
                                                       void **provider) {
     umf_result_t umf_result = UMF_RESULT_ERROR_UNKNOWN;
@@ -969,6 +1263,14 @@ static umf_result_t coarse_memory_provider_initialize(void *params,
         goto err_delete_ravl_all_blocks;
     }
 
+    if (coarse_params->num_shards > 0) {
+        umf_result =
+            coarse_shards_create(coarse_provider, coarse_params->num_shards);
+        if (umf_result != UMF_RESULT_SUCCESS) {
+            goto err_destroy_mutex;
+        }
+    }
+
     if (coarse_params->upstream_memory_provider &&
         coarse_params->immediate_init_from_upstream) {
         // allocate and immediately deallocate memory using the upstream provider
@@ -977,7 +1279,7 @@ static umf_result_t coarse_memory_provider_initialize(void *params,
             coarse_provider, coarse_params->init_buffer_size, 0, &init_buffer);
         if (init_buffer == NULL) {
             umf_result = UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
-            goto err_destroy_mutex;
+            goto err_destroy_shards;
         }
 
         coarse_memory_provider_free(coarse_provider, init_buffer,
@@ -988,7 +1290,7 @@ static umf_result_t coarse_memory_provider_initialize(void *params,
                                                coarse_provider->init_buffer,
                                                coarse_params->init_buffer_size);
         if (umf_result != UMF_RESULT_SUCCESS) {
-            goto err_destroy_mutex;
+            goto err_destroy_shards;
         }
 
         LOG_DEBUG("coarse_ALLOC (init_buffer) %zu used %zu alloc %zu",
@@ -1000,6 +1302,9 @@ static umf_result_t coarse_memory_provider_initialize(void *params,
                                     coarse_params->init_buffer_size);
     }
 
+    // the init buffer could have been cached in a shard
+    coarse_drain_shards(coarse_provider);
+
     assert(coarse_provider->used_size == 0);
     assert(coarse_provider->alloc_size == coarse_params->init_buffer_size);
     assert(debug_check(coarse_provider));
@@ -1008,6 +1313,8 @@ static umf_result_t coarse_memory_provider_initialize(void *params,
 
     return UMF_RESULT_SUCCESS;
 
+err_destroy_shards:
+    coarse_shards_destroy(coarse_provider);
 err_destroy_mutex:
     utils_mutex_destroy_not_free(&coarse_provider->lock);
 err_delete_ravl_all_blocks:
@@ -1077,6 +1384,9 @@ static void coarse_memory_provider_finalize(void *provider) {
     coarse_memory_provider_t *coarse_provider =
         (struct coarse_memory_provider_t *)provider;
 
+    coarse_drain_shards(coarse_provider);
+    coarse_shards_destroy(coarse_provider);
+
     utils_mutex_destroy_not_free(&coarse_provider->lock);
 
     ravl_foreach(coarse_provider->all_blocks, coarse_ravl_cb_rm_all_blocks_node,
@@ -1222,6 +1532,15 @@ static umf_result_t coarse_memory_provider_alloc(void *provider, size_t size,
     coarse_memory_provider_t *coarse_provider =
         (struct coarse_memory_provider_t *)provider;
 
+    // Reuse a block of exactly this size cached in the shard
+    // of the calling thread without taking the global lock.
+    if (coarse_provider->num_shards > 0 && size > 0) {
+        *resultPtr = coarse_shard_alloc(coarse_provider, size, alignment);
+        if (*resultPtr) {
+            return UMF_RESULT_SUCCESS;
+        }
+    }
+
     if (utils_mutex_lock(&coarse_provider->lock) != 0) {
         LOG_ERR("locking the lock failed");
         return UMF_RESULT_ERROR_UNKNOWN;
@@ -1234,6 +1553,14 @@ static umf_result_t coarse_memory_provider_alloc(void *provider, size_t size,
         find_free_block(coarse_provider->free_blocks, size, alignment,
                         coarse_provider->allocation_strategy);
 
+    if (curr == NULL && coarse_provider->num_shards > 0) {
+        // Coalesce the blocks cached in the shards and try again
+        // before asking the upstream provider for more memory.
+        coarse_drain_shards(coarse_provider);
+        curr = find_free_block(coarse_provider->free_blocks, size, alignment,
+                               coarse_provider->allocation_strategy);
+    }
+
     // If the block that we want to reuse has a greater size, split it.
     // Try to merge the split part with the successor if it is not used.
     enum { ACTION_NONE = 0, ACTION_USE, ACTION_SPLIT } action = ACTION_NONE;
@@ -1283,6 +1610,13 @@ static umf_result_t coarse_memory_provider_alloc(void *provider, size_t size,
         *resultPtr = curr->data;
         coarse_provider->used_size += size;
 
+        umf_result = coarse_live_add(coarse_provider, curr->data, size);
+        if (umf_result != UMF_RESULT_SUCCESS) {
+            coarse_free_block(coarse_provider, curr->data, size);
+            *resultPtr = NULL;
+            goto err_unlock;
+        }
+
         assert(debug_check(coarse_provider));
 
         if (utils_mutex_unlock(&coarse_provider->lock) != 0) {
@@ -1338,26 +1672,15 @@ err_unlock:
     return umf_result;
 }
 
-static umf_result_t coarse_memory_provider_free(void *provider, void *ptr,
-                                                size_t bytes) {
-    if (provider == NULL) {
-        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
-    }
-
-    coarse_memory_provider_t *coarse_provider =
-        (struct coarse_memory_provider_t *)provider;
-
-    if (utils_mutex_lock(&coarse_provider->lock) != 0) {
-        LOG_ERR("locking the lock failed");
-        return UMF_RESULT_ERROR_UNKNOWN;
-    }
-
+// coarse_free_block - return the used block to the free blocks
+// and merge it with its neighbours. The coarse_provider->lock has to be held.
+static umf_result_t coarse_free_block(coarse_memory_provider_t *coarse_provider,
+                                      void *ptr, size_t bytes) {
     assert(debug_check(coarse_provider));
 
     ravl_node_t *node = coarse_ravl_find_node(coarse_provider->all_blocks, ptr);
     if (node == NULL) {
         // the block was not found
-        utils_mutex_unlock(&coarse_provider->lock);
         LOG_ERR("memory block not found (ptr = %p, size = %zu)", ptr, bytes);
         return UMF_RESULT_ERROR_UNKNOWN;
     }
@@ -1365,14 +1688,12 @@ static umf_result_t coarse_memory_provider_free(void *provider, void *ptr,
     block_t *block = get_node_block(node);
     if (!block->used) {
         // the block is already free
-        utils_mutex_unlock(&coarse_provider->lock);
         LOG_ERR("the block is already free");
         return UMF_RESULT_ERROR_INVALID_ARGUMENT;
     }
 
     if (bytes > 0 && bytes != block->size) {
         // wrong size of allocation
-        utils_mutex_unlock(&coarse_provider->lock);
         LOG_ERR("wrong size of allocation");
         return UMF_RESULT_ERROR_INVALID_ARGUMENT;
     }
@@ -1393,18 +1714,255 @@ static umf_result_t coarse_memory_provider_free(void *provider, void *ptr,
     int rv =
         free_blocks_add(coarse_provider->free_blocks, get_node_block(node));
     if (rv) {
-        utils_mutex_unlock(&coarse_provider->lock);
         return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
     }
 
     assert(debug_check(coarse_provider));
 
+    return UMF_RESULT_SUCCESS;
+}
+
+// coarse_drain_shards - coalesce all blocks cached in the shards.
+// The coarse_provider->lock has to be held.
+static void coarse_drain_shards(coarse_memory_provider_t *coarse_provider) {
+    for (size_t i = 0; i < coarse_provider->num_shards; i++) {
+        coarse_shard_t *shard = coarse_provider->shards[i];
+
+        if (utils_mutex_lock(&shard->lock) != 0) {
+            LOG_ERR("locking the shard lock failed");
+            continue;
+        }
+
+        for (size_t b = 0; b < COARSE_SHARD_NUM_BINS; b++) {
+            coarse_shard_bin_t *bin = &shard->bins[b];
+            for (size_t j = 0; j < bin->count; j++) {
+                // the blocks were validated in coarse_shard_free()
+                coarse_free_block(coarse_provider, bin->blocks[j].data,
+                                  bin->blocks[j].size);
+            }
+            bin->count = 0;
+        }
+
+        utils_mutex_unlock(&shard->lock);
+    }
+}
+
+static coarse_shard_t *
+coarse_get_shard(coarse_memory_provider_t *coarse_provider) {
+    static uint64_t thread_counter = 0;
+    static __TLS uint64_t thread_id = 0; // 0 means "not assigned yet"
+
+    if (thread_id == 0) {
+        thread_id = utils_fetch_and_add64(&thread_counter, 1) + 1;
+    }
+
+    return coarse_provider
+        ->shards[(thread_id - 1) % coarse_provider->num_shards];
+}
+
+// coarse_shard_alloc - take a cached block of exactly the given size
+// and alignment from the shard of the calling thread
+static void *coarse_shard_alloc(coarse_memory_provider_t *coarse_provider,
+                                size_t size, size_t alignment) {
+    coarse_shard_t *shard = coarse_get_shard(coarse_provider);
+    coarse_shard_bin_t *bin = &shard->bins[utils_mssb_index(size)];
+    void *ptr = NULL;
+
+    if (utils_mutex_lock(&shard->lock) != 0) {
+        LOG_ERR("locking the shard lock failed");
+        return NULL;
+    }
+
+    for (size_t i = bin->count; i > 0; i--) {
+        coarse_cached_block_t *cached = &bin->blocks[i - 1];
+        if (cached->size == size &&
+            IS_ALIGNED((uintptr_t)cached->data, alignment)) {
+            ptr = cached->data;
+            *cached = bin->blocks[--bin->count];
+            break;
+        }
+    }
+
+    utils_mutex_unlock(&shard->lock);
+
+    if (ptr && coarse_live_add(coarse_provider, ptr, size) !=
+                   UMF_RESULT_SUCCESS) {
+        // coalesce the block, the caller falls back to the central trees
+        if (utils_mutex_lock(&coarse_provider->lock) != 0) {
+            LOG_ERR("locking the lock failed");
+            return NULL;
+        }
+        coarse_free_block(coarse_provider, ptr, size);
+        utils_mutex_unlock(&coarse_provider->lock);
+        ptr = NULL;
+    }
+
+    return ptr;
+}
+
+// coarse_free_user_block - coarse_free_block() of a block freed by the user,
+// which also rejects the blocks cached in the shards.
+// The coarse_provider->lock has to be held.
+static umf_result_t
+coarse_free_user_block(coarse_memory_provider_t *coarse_provider, void *ptr,
+                       size_t bytes) {
+    if (coarse_provider->num_shards == 0) {
+        return coarse_free_block(coarse_provider, ptr, bytes);
+    }
+
+    ravl_node_t *node = coarse_ravl_find_node(coarse_provider->all_blocks, ptr);
+    if (node == NULL) {
+        // the block was not found
+        LOG_ERR("memory block not found (ptr = %p, size = %zu)", ptr, bytes);
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    block_t *block = get_node_block(node);
+    if (!block->used) {
+        // the block is already free
+        LOG_ERR("the block is already free");
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (bytes > 0 && bytes != block->size) {
+        // wrong size of allocation
+        LOG_ERR("wrong size of allocation");
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!coarse_live_remove(coarse_provider, ptr)) {
+        // the block is already free (cached in a shard)
+        LOG_ERR("the block is already free");
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    return coarse_free_block(coarse_provider, ptr, bytes);
+}
+
+// coarse_shard_free - cache the freed block in the shard of the calling thread.
+// The block is validated under the lock of the shard owning its address only,
+// the global lock is taken just to coalesce the older half of a full bin
+// (or to report an invalid free).
+static umf_result_t coarse_shard_free(coarse_memory_provider_t *coarse_provider,
+                                      void *ptr, size_t bytes) {
+    coarse_shard_t *shard = coarse_get_shard(coarse_provider);
+    coarse_shard_bin_t *bin = &shard->bins[utils_mssb_index(bytes)];
+    coarse_cached_block_t evicted[COARSE_SHARD_BIN_CAPACITY / 2];
+    size_t num_evicted = 0;
+    umf_result_t umf_result = UMF_RESULT_SUCCESS;
+
+    coarse_shard_t *owner = coarse_shard_of(coarse_provider, ptr);
+    if (utils_mutex_lock(&owner->lock) != 0) {
+        LOG_ERR("locking the shard lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    coarse_live_block_t *entry = coarse_live_find(owner, (uintptr_t)ptr);
+    if (entry && entry->size != bytes) {
+        utils_mutex_unlock(&owner->lock);
+        // wrong size of allocation
+        LOG_ERR("wrong size of allocation");
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (entry) {
+        coarse_live_erase(owner, entry);
+    }
+
+    utils_mutex_unlock(&owner->lock);
+
+    if (entry == NULL) {
+        // not an allocated block - report it the same way as without shards
+        if (utils_mutex_lock(&coarse_provider->lock) != 0) {
+            LOG_ERR("locking the lock failed");
+            return UMF_RESULT_ERROR_UNKNOWN;
+        }
+
+        umf_result = coarse_free_user_block(coarse_provider, ptr, bytes);
+
+        if (utils_mutex_unlock(&coarse_provider->lock) != 0) {
+            LOG_ERR("unlocking the lock failed");
+            return UMF_RESULT_ERROR_UNKNOWN;
+        }
+
+        return umf_result;
+    }
+
+    if (utils_mutex_lock(&shard->lock) != 0) {
+        LOG_ERR("locking the shard lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    if (bin->count == COARSE_SHARD_BIN_CAPACITY) {
+        num_evicted = COARSE_SHARD_BIN_CAPACITY / 2;
+        memcpy(evicted, bin->blocks, sizeof(evicted));
+        memmove(bin->blocks, bin->blocks + num_evicted,
+                (bin->count - num_evicted) * sizeof(bin->blocks[0]));
+        bin->count -= num_evicted;
+    }
+
+    bin->blocks[bin->count].data = ptr;
+    bin->blocks[bin->count].size = bytes;
+    bin->count++;
+
+    utils_mutex_unlock(&shard->lock);
+
+    if (num_evicted == 0) {
+        return UMF_RESULT_SUCCESS;
+    }
+
+    if (utils_mutex_lock(&coarse_provider->lock) != 0) {
+        LOG_ERR("locking the lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    for (size_t i = 0; i < num_evicted; i++) {
+        umf_result_t ret = coarse_free_block(coarse_provider, evicted[i].data,
+                                             evicted[i].size);
+        if (ret != UMF_RESULT_SUCCESS) {
+            umf_result = ret;
+        }
+    }
+
     if (utils_mutex_unlock(&coarse_provider->lock) != 0) {
         LOG_ERR("unlocking the lock failed");
         return UMF_RESULT_ERROR_UNKNOWN;
     }
 
-    return UMF_RESULT_SUCCESS;
+    return umf_result;
+}
+
+static umf_result_t coarse_memory_provider_free(void *provider, void *ptr,
+                                                size_t bytes) {
+    if (provider == NULL) {
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    coarse_memory_provider_t *coarse_provider =
+        (struct coarse_memory_provider_t *)provider;
+
+    // Blocks freed with a known size are validated and only parked in a shard -
+    // they are coalesced later, under the global lock.
+    if (coarse_provider->num_shards > 0 && ptr != NULL && bytes > 0) {
+        return coarse_shard_free(coarse_provider, ptr, bytes);
+    }
+
+    if (utils_mutex_lock(&coarse_provider->lock) != 0) {
+        LOG_ERR("locking the lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    umf_result_t umf_result =
+        coarse_free_user_block(coarse_provider, ptr, bytes);
+
+    if (utils_mutex_unlock(&coarse_provider->lock) != 0) {
+        LOG_ERR("unlocking the lock failed");
+        if (umf_result == UMF_RESULT_SUCCESS) {
+            umf_result = UMF_RESULT_ERROR_UNKNOWN;
+        }
+    }
+
+    return umf_result;
 }
 
 static void coarse_memory_provider_get_last_native_error(void *provider,
@@ -1605,16 +2163,23 @@ static umf_result_t coarse_memory_provider_allocation_split(void *provider,
         goto err_mutex_unlock;
     }
 
-    if (!block->used) {
+    if (!block->used || !coarse_live_contains(coarse_provider, ptr)) {
         LOG_ERR("block is not allocated");
         umf_result = UMF_RESULT_ERROR_INVALID_ARGUMENT;
         goto err_mutex_unlock;
     }
 
+    umf_result = coarse_live_add(coarse_provider, block->data + firstSize,
+                                 block->size - firstSize);
+    if (umf_result != UMF_RESULT_SUCCESS) {
+        goto err_mutex_unlock;
+    }
+
     block_t *new_block = coarse_ravl_add_new(coarse_provider->all_blocks,
                                              block->data + firstSize,
                                              block->size - firstSize, NULL);
     if (new_block == NULL) {
+        coarse_live_remove(coarse_provider, block->data + firstSize);
         umf_result = UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
         goto err_mutex_unlock;
     }
@@ -1622,6 +2187,9 @@ static umf_result_t coarse_memory_provider_allocation_split(void *provider,
     block->size = firstSize;
     new_block->used = true;
 
+    // updating the size of an existing entry does not fail
+    coarse_live_add(coarse_provider, ptr, firstSize);
+
     assert(new_block->size == (totalSize - firstSize));
 
     umf_result = UMF_RESULT_SUCCESS;
@@ -1670,7 +2238,7 @@ static umf_result_t coarse_memory_provider_allocation_merge(void *provider,
     }
 
     block_t *low_block = get_node_block(low_node);
-    if (!low_block->used) {
+    if (!low_block->used || !coarse_live_contains(coarse_provider, lowPtr)) {
         LOG_ERR("the lowPtr block is not allocated");
         umf_result = UMF_RESULT_ERROR_INVALID_ARGUMENT;
         goto err_mutex_unlock;
@@ -1685,7 +2253,8 @@ static umf_result_t coarse_memory_provider_allocation_merge(void *provider,
     }
 
     block_t *high_block = get_node_block(high_node);
-    if (!high_block->used) {
+    if (!high_block->used ||
+        !coarse_live_contains(coarse_provider, highPtr)) {
         LOG_ERR("the highPtr block is not allocated");
         umf_result = UMF_RESULT_ERROR_INVALID_ARGUMENT;
         goto err_mutex_unlock;
@@ -1727,6 +2296,10 @@ static umf_result_t coarse_memory_provider_allocation_merge(void *provider,
     assert(merged_node == low_node);
     assert(low_block->size == totalSize);
 
+    coarse_live_remove(coarse_provider, highPtr);
+    // updating the size of an existing entry does not fail
+    coarse_live_add(coarse_provider, lowPtr, totalSize);
+
     umf_result = UMF_RESULT_SUCCESS;
 
 err_mutex_unlock:
@@ -1789,6 +2362,9 @@ umfCoarseMemoryProviderGetStats(umf_memory_provider_handle_t provider) {
         return stats;
     }
 
+    // report the cached blocks as free ones
+    coarse_drain_shards(coarse_provider);
+
     coarse_memory_provider_get_stats(priv, &stats);
 
     utils_mutex_unlock(&coarse_provider->lock);
@@ -27,14 +27,21 @@ umf_memory_provider_ops_t *umfFileMemoryProviderOps(void) {
 
 #else // !defined(_WIN32) && !defined(UMF_NO_HWLOC)
 
+#include <sys/mman.h>
+
 #include "base_alloc_global.h"
 #include "critnib.h"
+#include "topology.h"
 #include "utils_common.h"
 #include "utils_concurrency.h"
 #include "utils_log.h"
 
 #define TLS_MSG_BUF_LEN 1024
 
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0 // the address is checked after mmap() anyway
+#endif
+
 typedef struct file_memory_provider_t {
     utils_mutex_t lock; // lock for file parameters (size and offsets)
 
@@ -51,6 +58,10 @@ typedef struct file_memory_provider_t {
     unsigned visibility; // memory visibility mode
     size_t page_size;    // minimum page size
 
+    // size of the single, whole-file mapping created at initialization
+    // (0 - the file is grown and mapped on demand)
+    size_t size_fixed;
+
     // IPC is enabled only for UMF_MEM_MAP_SHARED or UMF_MEM_MAP_SYNC visibility
     bool IPC_enabled;
 
@@ -121,6 +132,102 @@ file_translate_params(umf_file_memory_provider_params_t *in_params,
     return UMF_RESULT_SUCCESS;
 }
 
+static int file_bind_to_node(void *addr, size_t size, int numa_node) {
+    hwloc_topology_t topology = umfGetTopology();
+    if (!topology) {
+        LOG_ERR("cannot get the topology");
+        return -1;
+    }
+
+    hwloc_nodeset_t nodeset = hwloc_bitmap_alloc();
+    if (!nodeset) {
+        LOG_ERR("allocating a nodeset failed");
+        return -1;
+    }
+
+    hwloc_bitmap_only(nodeset, (unsigned)numa_node);
+
+    // MIGRATE moves the pages the file already has (e.g. in the page cache)
+    int ret = hwloc_set_area_membind(
+        topology, addr, size, nodeset, HWLOC_MEMBIND_BIND,
+        HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_STRICT | HWLOC_MEMBIND_MIGRATE);
+    if (ret) {
+        LOG_PERR("binding the mapping (addr=%p, size=%zu) to the node %i "
+                 "failed",
+                 addr, size, numa_node);
+    }
+
+    hwloc_bitmap_free(nodeset);
+
+    return ret;
+}
+
+// map the whole file of the in_params->size size (at in_params->base_addr)
+// keeping its content
+static umf_result_t file_map_whole(file_memory_provider_t *file_provider,
+                                   umf_file_memory_provider_params_t *in_params) {
+    size_t size = in_params->size;
+    void *base_addr = in_params->base_addr;
+    size_t page_size = file_provider->page_size;
+
+    if (IS_NOT_ALIGNED(size, page_size) ||
+        IS_NOT_ALIGNED((uintptr_t)base_addr, page_size)) {
+        LOG_ERR("size (%zu) and base address (%p) have to be page-aligned",
+                size, base_addr);
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t size_fd;
+    if (utils_get_file_size(file_provider->fd, &size_fd)) {
+        LOG_ERR("cannot get size of the file: %s", in_params->path);
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    // ftruncate() (not fallocate()) keeps the file sparse,
+    // so only the pages actually used take memory on tmpfs
+    if (size_fd < size && utils_set_file_size(file_provider->fd, size)) {
+        LOG_ERR("cannot set size of the file: %s", in_params->path);
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    int flag = (int)file_provider->visibility;
+    if (base_addr) {
+        flag |= MAP_FIXED_NOREPLACE;
+    }
+
+    void *ptr = utils_mmap_file(base_addr, size, file_provider->protection,
+                                flag, file_provider->fd, 0);
+    if (ptr == NULL) {
+        LOG_PERR("memory mapping of the file %s failed", in_params->path);
+        return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+    }
+
+    if (base_addr && ptr != base_addr) {
+        LOG_ERR("cannot map the file %s at the address %p (got: %p)",
+                in_params->path, base_addr, ptr);
+        utils_munmap(ptr, size);
+        return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+    }
+
+    if (in_params->numa_node >= 0 &&
+        file_bind_to_node(ptr, size, in_params->numa_node)) {
+        utils_munmap(ptr, size);
+        return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+    }
+
+    LOG_DEBUG("file %s mapped as a whole (addr=%p, size=%zu)", in_params->path,
+              ptr, size);
+
+    file_provider->size_fixed = size;
+    file_provider->size_fd = (size_fd > size) ? size_fd : size;
+    file_provider->offset_fd = 0;
+    file_provider->base_mmap = ptr;
+    file_provider->size_mmap = size;
+    file_provider->offset_mmap = 0;
+
+    return UMF_RESULT_SUCCESS;
+}
+
 static umf_result_t file_initialize(void *params, void **provider) {
     umf_result_t ret;
 
@@ -164,13 +271,21 @@ static umf_result_t file_initialize(void *params, void **provider) {
         goto err_free_file_provider;
     }
 
-    if (utils_set_file_size(file_provider->fd, page_size)) {
-        LOG_ERR("cannot set size of the file: %s", in_params->path);
-        ret = UMF_RESULT_ERROR_UNKNOWN;
-        goto err_close_fd;
-    }
+    if (in_params->size) {
+        // keep the content of the file
+        ret = file_map_whole(file_provider, in_params);
+        if (ret != UMF_RESULT_SUCCESS) {
+            goto err_close_fd;
+        }
+    } else {
+        if (utils_set_file_size(file_provider->fd, page_size)) {
+            LOG_ERR("cannot set size of the file: %s", in_params->path);
+            ret = UMF_RESULT_ERROR_UNKNOWN;
+            goto err_close_fd;
+        }
 
-    file_provider->size_fd = page_size;
+        file_provider->size_fd = page_size;
+    }
 
     LOG_DEBUG("size of the file %s is: %zu", in_params->path,
               file_provider->size_fd);
@@ -178,7 +293,7 @@ static umf_result_t file_initialize(void *params, void **provider) {
     if (utils_mutex_init(&file_provider->lock) == NULL) {
         LOG_ERR("lock init failed");
         ret = UMF_RESULT_ERROR_UNKNOWN;
-        goto err_close_fd;
+        goto err_munmap;
     }
 
     file_provider->fd_offset_map = critnib_new();
@@ -195,14 +310,33 @@ static umf_result_t file_initialize(void *params, void **provider) {
         goto err_delete_fd_offset_map;
     }
 
+    if (file_provider->size_fixed) {
+        if (critnib_insert(file_provider->mmaps,
+                           (uintptr_t)file_provider->base_mmap,
+                           (void *)(uintptr_t)file_provider->size_mmap,
+                           0 /* update */)) {
+            LOG_ERR("inserting a value to the map of memory mapping failed "
+                    "(addr=%p, size=%zu)",
+                    file_provider->base_mmap, file_provider->size_mmap);
+            ret = UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+            goto err_delete_mmaps;
+        }
+    }
+
     *provider = file_provider;
 
     return UMF_RESULT_SUCCESS;
 
+err_delete_mmaps:
+    critnib_delete(file_provider->mmaps);
 err_delete_fd_offset_map:
     critnib_delete(file_provider->fd_offset_map);
 err_mutex_destroy_not_free:
     utils_mutex_destroy_not_free(&file_provider->lock);
+err_munmap:
+    if (file_provider->size_fixed) {
+        utils_munmap(file_provider->base_mmap, file_provider->size_mmap);
+    }
 err_close_fd:
     utils_close_fd(file_provider->fd);
 err_free_file_provider:
@@ -246,6 +380,12 @@ static umf_result_t file_mmap_aligned(file_memory_provider_t *file_provider,
 
     assert(fd > 0);
 
+    if (file_provider->size_fixed) {
+        LOG_ERR("the whole mapping of the file (%zu bytes) is used up",
+                file_provider->size_fixed);
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
     // We have to increase size by alignment to be able to "cut out"
     // the correctly aligned part of the memory
     size_t extended_size = size + alignment;
@@ -59,6 +59,10 @@ static __TLS os_last_native_error_t TLS_last_native_error;
     (UMF_OS_RESULT_ERROR_PURGE_FORCE_FAILED - UMF_OS_RESULT_SUCCESS)
 #define _UMF_OS_RESULT_ERROR_TOPO_DISCOVERY_FAILED                             \
     (UMF_OS_RESULT_ERROR_TOPO_DISCOVERY_FAILED - UMF_OS_RESULT_SUCCESS)
+#define _UMF_OS_RESULT_ERROR_POPULATE_FAILED                                   \
+    (UMF_OS_RESULT_ERROR_POPULATE_FAILED - UMF_OS_RESULT_SUCCESS)
+#define _UMF_OS_RESULT_ERROR_MIGRATE_FAILED                                    \
+    (UMF_OS_RESULT_ERROR_MIGRATE_FAILED - UMF_OS_RESULT_SUCCESS)
 
 static const char *Native_error_str[] = {
     [_UMF_OS_RESULT_SUCCESS] = "success",
@@ -71,6 +75,9 @@ static const char *Native_error_str[] = {
     [_UMF_OS_RESULT_ERROR_PURGE_FORCE_FAILED] = "force purging failed",
     [_UMF_OS_RESULT_ERROR_TOPO_DISCOVERY_FAILED] =
         "HWLOC topology discovery failed",
+    [_UMF_OS_RESULT_ERROR_POPULATE_FAILED] = "pre-faulting pages failed",
+    [_UMF_OS_RESULT_ERROR_MIGRATE_FAILED] =
+        "moving pages to NUMA node failed",
 };
 
 static void os_store_last_native_error(int32_t native_error, int errno_value) {
@@ -195,7 +202,8 @@ static hwloc_membind_policy_t translate_numa_mode(umf_numa_mode_t mode,
 //return 0 if umf will just set numa memory policy, and kernel will decide where to allocate memory
 static int dedicated_node_bind(umf_os_memory_provider_params_t *in_params) {
     if (in_params->numa_mode == UMF_NUMA_MODE_INTERLEAVE) {
-        return in_params->part_size > 0;
+        // weighted interleaving is always done manually
+        return in_params->part_size > 0 || in_params->partitions_len > 0;
     }
     if (in_params->numa_mode == UMF_NUMA_MODE_SPLIT) {
         return 1;
@@ -351,7 +359,9 @@ static void free_bitmaps(os_memory_provider_t *provider) {
 static umf_result_t
 initializePartitions(os_memory_provider_t *provider,
                      umf_os_memory_provider_params_t *in_params) {
-    if (provider->mode != UMF_NUMA_MODE_SPLIT) {
+    if (provider->mode != UMF_NUMA_MODE_SPLIT &&
+        !(provider->mode == UMF_NUMA_MODE_INTERLEAVE &&
+          in_params->partitions_len > 0)) {
         return UMF_RESULT_SUCCESS;
     }
 
@@ -437,6 +447,11 @@ static umf_result_t translate_params(umf_os_memory_provider_params_t *in_params,
         getHwlocMembindFlags(in_params->numa_mode, is_dedicated_node_bind);
     provider->mode = in_params->numa_mode;
     provider->part_size = in_params->part_size;
+    if (provider->mode == UMF_NUMA_MODE_INTERLEAVE &&
+        in_params->partitions_len > 0 && provider->part_size == 0) {
+        // interleave by pages by default
+        provider->part_size = utils_get_page_size();
+    }
 
     result =
         initialize_nodeset(provider, in_params->numa_list,
@@ -446,11 +461,26 @@ static umf_result_t translate_params(umf_os_memory_provider_params_t *in_params,
         return result;
     }
 
-    initializePartitions(provider, in_params);
+    result = initializePartitions(provider, in_params);
+    if (result != UMF_RESULT_SUCCESS) {
+        free_bitmaps(provider);
+        return result;
+    }
+
+    provider->populate = in_params->populate;
+    if (provider->populate &&
+        !(in_params->protection & UMF_PROTECTION_WRITE)) {
+        LOG_WARN("pre-faulting pages requires UMF_PROTECTION_WRITE, "
+                 "the populate option is ignored");
+        provider->populate = false;
+    }
 
     return UMF_RESULT_SUCCESS;
 }
 
+static umf_result_t os_reserve(os_memory_provider_t *os_provider,
+                               size_t size);
+
 static umf_result_t os_initialize(void *params, void **provider) {
     umf_result_t ret;
 
@@ -469,6 +499,13 @@ static umf_result_t os_initialize(void *params, void **provider) {
         return UMF_RESULT_ERROR_NOT_SUPPORTED;
     }
 
+    if (in_params->visibility == UMF_MEM_MAP_SHARED &&
+        in_params->reserve_size > 0) {
+        LOG_ERR("Memory reservation is not supported for the "
+                "UMF_MEM_MAP_SHARED memory visibility mode");
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
     os_memory_provider_t *os_provider =
         umf_ba_global_alloc(sizeof(os_memory_provider_t));
     if (!os_provider) {
@@ -532,10 +569,27 @@ static umf_result_t os_initialize(void *params, void **provider) {
         }
     }
 
+    if (in_params->reserve_size > 0) {
+        ret = os_reserve(os_provider, in_params->reserve_size);
+        if (ret != UMF_RESULT_SUCCESS) {
+            goto err_free_str_buf;
+        }
+    }
+
     *provider = os_provider;
 
     return UMF_RESULT_SUCCESS;
 
+err_free_str_buf:
+    if (os_provider->nodeset_str_buf) {
+        umf_ba_global_free(os_provider->nodeset_str_buf);
+    }
+    if (os_provider->fd > 0) {
+        utils_mutex_destroy_not_free(&os_provider->lock_fd);
+    }
+    if (os_provider->partitions) {
+        umf_ba_global_free(os_provider->partitions);
+    }
 err_destroy_bitmaps:
     free_bitmaps(os_provider);
 err_destroy_critnib:
@@ -559,6 +613,26 @@ static void os_finalize(void *provider) {
         utils_mutex_destroy_not_free(&os_provider->lock_fd);
     }
 
+    if (os_provider->reserve_base) {
+        // ranges still allocated from the reservation stay mapped,
+        // the free ones and the never used tail are unmapped
+        for (size_t i = 0; i < os_provider->reserve_free_len; i++) {
+            (void)utils_munmap(os_provider->reserve_base +
+                                   os_provider->reserve_free[i].offset,
+                               os_provider->reserve_free[i].size);
+        }
+        if (os_provider->reserve_used < os_provider->reserve_size) {
+            (void)utils_munmap(os_provider->reserve_base +
+                                   os_provider->reserve_used,
+                               os_provider->reserve_size -
+                                   os_provider->reserve_used);
+        }
+        if (os_provider->reserve_free) {
+            umf_ba_global_free(os_provider->reserve_free);
+        }
+        utils_mutex_destroy_not_free(&os_provider->lock_reserve);
+    }
+
     critnib_delete(os_provider->fd_offset_map);
 
     free_bitmaps(os_provider);
@@ -806,6 +880,33 @@ static void nextBind(os_memory_provider_t *provider, membind_t *membind) {
     }
 }
 
+/// Number of parts after which the manual interleave pattern repeats
+static size_t interleavePeriod(os_memory_provider_t *provider) {
+    return provider->partitions_len ? provider->partitions_weight_sum
+                                    : provider->nodeset_len;
+}
+
+/// Returns the nodeset of the given part in the manual interleave mode:
+/// round-robin over the nodes or, if partitions are set,
+/// weighted round-robin over the partitions.
+static hwloc_bitmap_t interleaveBitmap(os_memory_provider_t *provider,
+                                       size_t part) {
+    if (provider->partitions_len == 0) {
+        return provider->nodeset[part % provider->nodeset_len];
+    }
+
+    size_t slot = part % provider->partitions_weight_sum;
+    for (unsigned i = 0; i < provider->partitions_len; i++) {
+        if (slot < provider->partitions[i].weight) {
+            return provider->partitions[i].target;
+        }
+        slot -= provider->partitions[i].weight;
+    }
+
+    assert(0); // Should not be reachable
+    return provider->partitions[0].target;
+}
+
 /// Initialize membind iterator
 static membind_t membindFirst(os_memory_provider_t *provider, void *addr,
                               size_t size, size_t page_size) {
@@ -826,8 +927,9 @@ static membind_t membindFirst(os_memory_provider_t *provider, void *addr,
     if (provider->mode == UMF_NUMA_MODE_INTERLEAVE) {
         assert(provider->part_size != 0);
         size_t s = utils_fetch_and_add64(&provider->alloc_sum, size);
-        membind.node = (s / provider->part_size) % provider->nodeset_len;
-        membind.bitmap = provider->nodeset[membind.node];
+        membind.node =
+            (unsigned)((s / provider->part_size) % interleavePeriod(provider));
+        membind.bitmap = interleaveBitmap(provider, membind.node);
         membind.bind_size = ALIGN_UP(provider->part_size, membind.page_size);
         if (membind.bind_size > membind.alloc_size) {
             membind.bind_size = membind.alloc_size;
@@ -862,8 +964,8 @@ static membind_t membindNext(os_memory_provider_t *provider,
 
     if (provider->mode == UMF_NUMA_MODE_INTERLEAVE) {
         membind.node++;
-        membind.node %= provider->nodeset_len;
-        membind.bitmap = provider->nodeset[membind.node];
+        membind.node %= interleavePeriod(provider);
+        membind.bitmap = interleaveBitmap(provider, membind.node);
         membind.bind_size = ALIGN_UP(provider->part_size, membind.page_size);
         if (membind.bind_size > membind.alloc_size) {
             membind.bind_size = membind.alloc_size;
@@ -875,6 +977,349 @@ static membind_t membindNext(os_memory_provider_t *provider,
     return membind;
 }
 
+// Binds the memory range to a single NUMA node,
+// moving the pages already faulted in if migrate is set.
+static umf_result_t os_bind_to_node(os_memory_provider_t *os_provider,
+                                    void *addr, size_t size, unsigned node,
+                                    bool migrate) {
+    hwloc_nodeset_t nodeset = hwloc_bitmap_alloc();
+    if (!nodeset) {
+        LOG_ERR("allocating a nodeset failed");
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    hwloc_bitmap_only(nodeset, node);
+
+    int flags = HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_STRICT;
+    if (migrate) {
+        flags |= HWLOC_MEMBIND_MIGRATE;
+    }
+
+    errno = 0;
+    int ret = hwloc_set_area_membind(os_provider->topo, addr, size, nodeset,
+                                     HWLOC_MEMBIND_BIND, flags);
+    hwloc_bitmap_free(nodeset);
+    if (ret == 0) {
+        return UMF_RESULT_SUCCESS;
+    }
+
+    os_store_last_native_error(migrate ? UMF_OS_RESULT_ERROR_MIGRATE_FAILED
+                                       : UMF_OS_RESULT_ERROR_BIND_FAILED,
+                               errno);
+    LOG_PERR("binding memory (addr=%p, size=%zu) to NUMA node %u failed",
+             addr, size, node);
+    if (errno == ENOSYS) {
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+}
+
+// Binds the memory range to NUMA nodes (if numa_policy is other than DEFAULT
+// or the provider was migrated) and pre-faults its pages if the populate
+// option is set.
+static umf_result_t os_bind_and_populate(os_memory_provider_t *os_provider,
+                                         void *addr, size_t size,
+                                         size_t page_size) {
+    int ret;
+
+    uint64_t migrated_to;
+    utils_atomic_load_acquire(&os_provider->migrated_to, &migrated_to);
+
+    if (migrated_to) {
+        umf_result_t umf_ret =
+            os_bind_to_node(os_provider, addr, ALIGN_UP(size, page_size),
+                            (unsigned)(migrated_to - 1), false);
+        if (umf_ret != UMF_RESULT_SUCCESS) {
+            return umf_ret;
+        }
+    } else if (os_provider->numa_policy != HWLOC_MEMBIND_DEFAULT) {
+        membind_t membind = membindFirst(os_provider, addr, size, page_size);
+        if (membind.bitmap == NULL) {
+            return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+        }
+
+        do {
+            errno = 0;
+            ret = hwloc_set_area_membind(os_provider->topo, membind.addr,
+                                         membind.bind_size, membind.bitmap,
+                                         os_provider->numa_policy,
+                                         os_provider->numa_flags);
+
+            if (ret) {
+                os_store_last_native_error(UMF_OS_RESULT_ERROR_BIND_FAILED,
+                                           errno);
+                LOG_PERR("binding memory to NUMA node failed");
+                // TODO: (errno == 0) when hwloc_set_area_membind() fails on Windows,
+                // ignore this temporarily
+                if (errno != ENOSYS &&
+                    errno != 0) { // ENOSYS - Function not implemented
+                    // Do not error out if memory binding is not implemented at all
+                    // (like in case of WSL on Windows).
+                    return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+                }
+            }
+            membind = membindNext(os_provider, membind);
+        } while (membind.alloc_size > 0);
+    }
+
+    // Populate only after binding - pages faulted in before mbind()
+    // would land on the node of the calling thread (MAP_POPULATE cannot
+    // be used for that reason).
+    if (os_provider->populate) {
+        errno = 0;
+        if (utils_populate(addr, ALIGN_UP(size, page_size))) {
+            os_store_last_native_error(UMF_OS_RESULT_ERROR_POPULATE_FAILED,
+                                       errno);
+            LOG_PERR("pre-faulting pages failed");
+            return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+        }
+    }
+
+    return UMF_RESULT_SUCCESS;
+}
+
+// Maps, binds and (optionally) populates the reservation.
+static umf_result_t os_reserve(os_memory_provider_t *os_provider,
+                               size_t size) {
+    size_t page_size = utils_get_page_size();
+    size = ALIGN_UP(size, page_size);
+
+    errno = 0;
+    void *addr = utils_mmap(NULL, size, os_provider->protection,
+                            os_provider->visibility, -1, 0);
+    if (addr == NULL) {
+        os_store_last_native_error(UMF_OS_RESULT_ERROR_ALLOC_FAILED, errno);
+        LOG_PERR("reserving %zu bytes of memory failed", size);
+        return UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC;
+    }
+
+    umf_result_t ret =
+        os_bind_and_populate(os_provider, addr, size, page_size);
+    if (ret != UMF_RESULT_SUCCESS) {
+        (void)utils_munmap(addr, size);
+        return ret;
+    }
+
+    if (utils_mutex_init(&os_provider->lock_reserve) == NULL) {
+        LOG_ERR("initializing the reservation lock failed");
+        (void)utils_munmap(addr, size);
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
+    os_provider->reserve_base = addr;
+    os_provider->reserve_size = size;
+    os_provider->reserve_used = 0;
+
+    LOG_INFO("reserved %zu bytes of memory at %p (populate: %i)", size, addr,
+             os_provider->populate);
+
+    return UMF_RESULT_SUCCESS;
+}
+
+// Makes room for one more free range of the reservation.
+// lock_reserve has to be held.
+static bool os_reserve_free_grow(os_memory_provider_t *os_provider) {
+    if (os_provider->reserve_free_len < os_provider->reserve_free_cap) {
+        return true;
+    }
+
+    size_t new_cap =
+        os_provider->reserve_free_cap ? 2 * os_provider->reserve_free_cap : 16;
+    struct os_reserve_range_t *new_free =
+        umf_ba_global_alloc(new_cap * sizeof(*new_free));
+    if (!new_free) {
+        return false;
+    }
+
+    if (os_provider->reserve_free) {
+        memcpy(new_free, os_provider->reserve_free,
+               os_provider->reserve_free_len * sizeof(*new_free));
+        umf_ba_global_free(os_provider->reserve_free);
+    }
+
+    os_provider->reserve_free = new_free;
+    os_provider->reserve_free_cap = new_cap;
+
+    return true;
+}
+
+// Inserts a free range at the given index. lock_reserve has to be held.
+static bool os_reserve_free_insert(os_memory_provider_t *os_provider,
+                                   size_t i, size_t offset, size_t size) {
+    if (!os_reserve_free_grow(os_provider)) {
+        return false;
+    }
+
+    struct os_reserve_range_t *ranges = os_provider->reserve_free;
+    memmove(&ranges[i + 1], &ranges[i],
+            (os_provider->reserve_free_len - i) * sizeof(*ranges));
+    ranges[i].offset = offset;
+    ranges[i].size = size;
+    os_provider->reserve_free_len++;
+
+    return true;
+}
+
+// Removes the free range at the given index. lock_reserve has to be held.
+static void os_reserve_free_remove(os_memory_provider_t *os_provider,
+                                   size_t i) {
+    struct os_reserve_range_t *ranges = os_provider->reserve_free;
+    memmove(&ranges[i], &ranges[i + 1],
+            (os_provider->reserve_free_len - i - 1) * sizeof(*ranges));
+    os_provider->reserve_free_len--;
+}
+
+// Carves an aligned range out of the reservation - the first free range
+// large enough or the never used tail.
+// Returns NULL if the reservation is exhausted.
+static void *os_reserve_alloc(os_memory_provider_t *os_provider, size_t size,
+                              size_t alignment, size_t page_size) {
+    void *addr = NULL;
+
+    size = ALIGN_UP(size, page_size);
+    if (alignment < page_size) {
+        alignment = page_size;
+    }
+
+    if (utils_mutex_lock(&os_provider->lock_reserve)) {
+        LOG_ERR("locking the reservation failed");
+        return NULL;
+    }
+
+    uintptr_t base = (uintptr_t)os_provider->reserve_base;
+
+    for (size_t i = 0; i < os_provider->reserve_free_len; i++) {
+        struct os_reserve_range_t *range = &os_provider->reserve_free[i];
+        uintptr_t start = base + range->offset;
+        uintptr_t rest_of_div = start % alignment;
+        if (rest_of_div) {
+            start += alignment - rest_of_div;
+        }
+
+        uintptr_t range_end = base + range->offset + range->size;
+        if (start + size > range_end) {
+            continue;
+        }
+
+        size_t head = start - (base + range->offset);
+        size_t tail = range_end - (start + size);
+        if (head && tail) {
+            // the range is split in two
+            if (!os_reserve_free_insert(os_provider, i + 1,
+                                        start + size - base, tail)) {
+                continue;
+            }
+            os_provider->reserve_free[i].size = head;
+        } else if (head) {
+            range->size = head;
+        } else if (tail) {
+            range->offset += size;
+            range->size = tail;
+        } else {
+            os_reserve_free_remove(os_provider, i);
+        }
+
+        addr = (void *)start;
+        goto unlock;
+    }
+
+    uintptr_t start = base + os_provider->reserve_used;
+    uintptr_t rest_of_div = start % alignment;
+    if (rest_of_div) {
+        start += alignment - rest_of_div;
+    }
+
+    uintptr_t end = base + os_provider->reserve_size;
+    if (start + size <= end) {
+        // the alignment gap is a free range too
+        if (start > base + os_provider->reserve_used &&
+            !os_reserve_free_insert(os_provider, os_provider->reserve_free_len,
+                                    os_provider->reserve_used,
+                                    start - base - os_provider->reserve_used)) {
+            goto unlock;
+        }
+        addr = (void *)start;
+        os_provider->reserve_used = start + size - base;
+    }
+
+unlock:
+    utils_mutex_unlock(&os_provider->lock_reserve);
+
+    return addr;
+}
+
+// Returns true if the range belongs to the reservation and was given back
+// to it (it stays mapped and bound, so it is never unmapped by os_free()).
+static bool os_reserve_free(os_memory_provider_t *os_provider, void *ptr,
+                            size_t size) {
+    if (os_provider->reserve_base == NULL ||
+        (char *)ptr < os_provider->reserve_base ||
+        (char *)ptr >=
+            os_provider->reserve_base + os_provider->reserve_size) {
+        return false;
+    }
+
+    size_t offset = (size_t)((char *)ptr - os_provider->reserve_base);
+    size = ALIGN_UP(size, utils_get_page_size());
+
+    if (utils_mutex_lock(&os_provider->lock_reserve)) {
+        LOG_ERR("locking the reservation failed");
+        // do not unmap a part of the reservation
+        return true;
+    }
+
+    struct os_reserve_range_t *ranges = os_provider->reserve_free;
+    size_t len = os_provider->reserve_free_len;
+
+    if (offset + size == os_provider->reserve_used) {
+        // the topmost range - rewind the cursor over it
+        // and over the free ranges just below it
+        os_provider->reserve_used = offset;
+        while (len && ranges[len - 1].offset + ranges[len - 1].size ==
+                          os_provider->reserve_used) {
+            os_provider->reserve_used = ranges[len - 1].offset;
+            len--;
+        }
+        os_provider->reserve_free_len = len;
+        goto unlock;
+    }
+
+    // the index of the first free range above the freed one
+    size_t lo = 0, hi = len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ranges[mid].offset < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    bool merge_prev = lo > 0 && ranges[lo - 1].offset + ranges[lo - 1].size ==
+                                    offset;
+    bool merge_next = lo < len && offset + size == ranges[lo].offset;
+
+    if (merge_prev && merge_next) {
+        ranges[lo - 1].size += size + ranges[lo].size;
+        os_reserve_free_remove(os_provider, lo);
+    } else if (merge_prev) {
+        ranges[lo - 1].size += size;
+    } else if (merge_next) {
+        ranges[lo].offset = offset;
+        ranges[lo].size += size;
+    } else if (!os_reserve_free_insert(os_provider, lo, offset, size)) {
+        LOG_ERR("cannot record a free range of the reservation, "
+                "%zu bytes at %p are lost",
+                size, ptr);
+    }
+
+unlock:
+    utils_mutex_unlock(&os_provider->lock_reserve);
+
+    return true;
+}
+
 static umf_result_t os_alloc(void *provider, size_t size, size_t alignment,
                              void **resultPtr) {
     int ret;
@@ -899,6 +1344,16 @@ static umf_result_t os_alloc(void *provider, size_t size, size_t alignment,
         return UMF_RESULT_ERROR_INVALID_ARGUMENT;
     }
 
+    if (os_provider->reserve_base) {
+        void *addr =
+            os_reserve_alloc(os_provider, size, alignment, page_size);
+        if (addr) {
+            // already bound and populated in os_reserve()
+            *resultPtr = addr;
+            return UMF_RESULT_SUCCESS;
+        }
+    }
+
     size_t fd_offset; // needed for critnib_insert()
 
     void *addr = NULL;
@@ -922,35 +1377,10 @@ static umf_result_t os_alloc(void *provider, size_t size, size_t alignment,
         goto err_unmap;
     }
 
-    // Bind memory to NUMA nodes if numa_policy is other than DEFAULT
-    if (os_provider->numa_policy != HWLOC_MEMBIND_DEFAULT) {
-        membind_t membind = membindFirst(os_provider, addr, size, page_size);
-        if (membind.bitmap == NULL) {
-            goto err_unmap;
-        }
-
-        do {
-            errno = 0;
-            ret = hwloc_set_area_membind(os_provider->topo, membind.addr,
-                                         membind.bind_size, membind.bitmap,
-                                         os_provider->numa_policy,
-                                         os_provider->numa_flags);
-
-            if (ret) {
-                os_store_last_native_error(UMF_OS_RESULT_ERROR_BIND_FAILED,
-                                           errno);
-                LOG_PERR("binding memory to NUMA node failed");
-                // TODO: (errno == 0) when hwloc_set_area_membind() fails on Windows,
-                // ignore this temporarily
-                if (errno != ENOSYS &&
-                    errno != 0) { // ENOSYS - Function not implemented
-                    // Do not error out if memory binding is not implemented at all
-                    // (like in case of WSL on Windows).
-                    goto err_unmap;
-                }
-            }
-            membind = membindNext(os_provider, membind);
-        } while (membind.alloc_size > 0);
+    // Bind memory to NUMA nodes and pre-fault it if requested
+    result = os_bind_and_populate(os_provider, addr, size, page_size);
+    if (result != UMF_RESULT_SUCCESS) {
+        goto err_unmap;
     }
 
     if (os_provider->fd > 0) {
@@ -985,6 +1415,10 @@ static umf_result_t os_free(void *provider, void *ptr, size_t size) {
 
     os_memory_provider_t *os_provider = (os_memory_provider_t *)provider;
 
+    if (os_reserve_free(os_provider, ptr, size)) {
+        return UMF_RESULT_SUCCESS;
+    }
+
     if (os_provider->fd > 0) {
         critnib_remove(os_provider->fd_offset_map, (uintptr_t)ptr);
     }
@@ -1148,6 +1582,81 @@ static umf_result_t os_allocation_merge(void *provider, void *lowPtr,
     return UMF_RESULT_SUCCESS;
 }
 
+static umf_result_t os_migrate(void *provider, void *ptr, size_t size,
+                               unsigned target_node) {
+    if (provider == NULL) {
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    os_memory_provider_t *os_provider = (os_memory_provider_t *)provider;
+
+    if (hwloc_get_numanode_obj_by_os_index(os_provider->topo, target_node) ==
+        NULL) {
+        LOG_ERR("NUMA node %u does not exist", target_node);
+        return UMF_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (os_provider->IPC_enabled) {
+        // shared visibility - the pages may be mapped by other processes too
+        LOG_ERR("migration is not supported for the UMF_MEM_MAP_SHARED "
+                "memory visibility mode");
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    size_t page_size = utils_get_page_size();
+
+    if (ptr) {
+        if (IS_NOT_ALIGNED((uintptr_t)ptr, page_size)) {
+            return UMF_RESULT_ERROR_INVALID_ALIGNMENT;
+        }
+
+        return os_bind_to_node(os_provider, ptr, ALIGN_UP(size, page_size),
+                               target_node, true);
+    }
+
+    // The placement of the new memory: the ranges mapped from now on are
+    // bound in os_bind_and_populate(), the reservation - here, as it is
+    // mapped already.
+    utils_atomic_store_release(&os_provider->migrated_to,
+                               (uint64_t)target_node + 1);
+
+    umf_result_t ret = UMF_RESULT_SUCCESS;
+    if (os_provider->reserve_base) {
+        if (utils_mutex_lock(&os_provider->lock_reserve)) {
+            LOG_ERR("locking the reservation failed");
+            return UMF_RESULT_ERROR_UNKNOWN;
+        }
+
+        for (size_t i = 0;
+             i < os_provider->reserve_free_len && ret == UMF_RESULT_SUCCESS;
+             i++) {
+            ret = os_bind_to_node(os_provider,
+                                  os_provider->reserve_base +
+                                      os_provider->reserve_free[i].offset,
+                                  os_provider->reserve_free[i].size,
+                                  target_node, true);
+        }
+
+        if (ret == UMF_RESULT_SUCCESS &&
+            os_provider->reserve_used < os_provider->reserve_size) {
+            ret = os_bind_to_node(
+                os_provider,
+                os_provider->reserve_base + os_provider->reserve_used,
+                os_provider->reserve_size - os_provider->reserve_used,
+                target_node, true);
+        }
+
+        utils_mutex_unlock(&os_provider->lock_reserve);
+    }
+
+    if (ret == UMF_RESULT_SUCCESS) {
+        LOG_INFO("new memory of the provider is placed on NUMA node %u",
+                 target_node);
+    }
+
+    return ret;
+}
+
 typedef struct os_ipc_data_t {
     int pid;
     int fd;
@@ -1330,6 +1839,7 @@ static umf_memory_provider_ops_t UMF_OS_MEMORY_PROVIDER_OPS = {
     .ext.purge_force = os_purge_force,
     .ext.allocation_merge = os_allocation_merge,
     .ext.allocation_split = os_allocation_split,
+    .ext.migrate = os_migrate,
     .ipc.get_ipc_handle_size = os_get_ipc_handle_size,
     .ipc.get_ipc_handle = os_get_ipc_handle,
     .ipc.put_ipc_handle = os_put_ipc_handle,
@@ -67,6 +67,27 @@ typedef struct os_memory_provider_t {
     unsigned partitions_len;
     size_t partitions_weight_sum;
 
+    bool populate; // pre-fault pages after binding them
+
+    // 1 + the NUMA node set by os_migrate(NULL, 0, node), 0 if not set -
+    // it overrides the NUMA config for the memory mapped from then on
+    uint64_t migrated_to;
+
+    // memory reserved (mapped, bound and optionally populated)
+    // in os_initialize(), allocations are carved out of it first
+    char *reserve_base;
+    size_t reserve_size;
+    size_t reserve_used; // offset of the first never used byte
+    // ranges below reserve_used given back by os_free(), they stay mapped
+    // and are reused first (sorted by the offset, adjacent ones coalesced)
+    struct os_reserve_range_t {
+        size_t offset;
+        size_t size;
+    } *reserve_free;
+    size_t reserve_free_len;
+    size_t reserve_free_cap;
+    utils_mutex_t lock_reserve; // lock for updating the fields above
+
     hwloc_topology_t topo;
 } os_memory_provider_t;
 
@@ -11,6 +11,7 @@
 #include "base_alloc_global.h"
 #include "critnib.h"
 #include "ipc_internal.h"
+#include "memory_provider_internal.h"
 #include "utils_common.h"
 #include "utils_concurrency.h"
 #include "utils_log.h"
@@ -133,6 +134,38 @@ umf_result_t umfMemoryTrackerGetAllocInfo(const void *ptr,
     return UMF_RESULT_SUCCESS;
 }
 
+typedef struct tracker_range_t {
+    void *ptr;
+    size_t size;
+} tracker_range_t;
+
+typedef struct tracker_pool_ranges_t {
+    umf_memory_pool_handle_t pool;
+    tracker_range_t *ranges; // NULL - only count the ranges
+    size_t capacity;
+    size_t count;
+} tracker_pool_ranges_t;
+
+static int get_pool_ranges_cb(uintptr_t key, void *value, void *privdata) {
+    tracker_pool_ranges_t *pr = privdata;
+    tracker_value_t *v = value;
+
+    if (v->pool != pr->pool) {
+        return 0;
+    }
+
+    if (pr->ranges) {
+        if (pr->count == pr->capacity) {
+            return 1; // stop the iteration
+        }
+        pr->ranges[pr->count].ptr = (void *)key;
+        pr->ranges[pr->count].size = v->size;
+    }
+    pr->count++;
+
+    return 0;
+}
+
 // Cache entry structure to store provider-specific IPC data.
 // providerIpcData is a Flexible Array Member because its size varies
 // depending on the provider.
@@ -149,10 +182,99 @@ typedef struct umf_tracking_memory_provider_t {
 
     // the upstream provider does not support the free() operation
     bool upstreamDoesNotFree;
+
+    // held by frees and by the migration of a range of the pool,
+    // so a range is not freed (and reused) while it is being migrated
+    utils_mutex_t free_lock;
 } umf_tracking_memory_provider_t;
 
 typedef struct umf_tracking_memory_provider_t umf_tracking_memory_provider_t;
 
+// true if [ptr, ptr + size) is still tracked for the pool
+static bool tracker_range_is_tracked(umf_memory_pool_handle_t hPool,
+                                     void *ptr, size_t size) {
+    tracker_value_t *value = critnib_get(TRACKER->map, (uintptr_t)ptr);
+    return value && value->pool == hPool && value->size == size;
+}
+
+umf_result_t
+umfMemoryTrackerMigratePool(umf_memory_pool_handle_t hPool,
+                            umf_memory_provider_handle_t hTrackingProvider,
+                            unsigned target_node) {
+    assert(hPool);
+    assert(hTrackingProvider);
+
+    umf_tracking_memory_provider_t *p =
+        umfMemoryProviderGetPriv(hTrackingProvider);
+
+    if (TRACKER == NULL || TRACKER->map == NULL) {
+        LOG_ERR("tracker is not created");
+        return UMF_RESULT_ERROR_NOT_SUPPORTED;
+    }
+
+    // Copy the ranges first - migrating pages takes long and the critnib
+    // lock would block all the tracked allocations meanwhile.
+    tracker_pool_ranges_t pr = {hPool, NULL, 0, 0};
+    critnib_iter(TRACKER->map, 0, UINTPTR_MAX, get_pool_ranges_cb, &pr);
+    if (pr.count == 0) {
+        return UMF_RESULT_SUCCESS;
+    }
+
+    pr.ranges = umf_ba_global_alloc(pr.count * sizeof(tracker_range_t));
+    if (pr.ranges == NULL) {
+        return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pr.capacity = pr.count;
+    pr.count = 0;
+    critnib_iter(TRACKER->map, 0, UINTPTR_MAX, get_pool_ranges_cb, &pr);
+
+    umf_result_t ret = UMF_RESULT_SUCCESS;
+    size_t skipped = 0;
+    for (size_t i = 0; i < pr.count; i++) {
+        // the frees of the pool wait until the range is migrated
+        if (utils_mutex_lock(&p->free_lock)) {
+            LOG_ERR("locking the free lock of pool %p failed", (void *)hPool);
+            ret = UMF_RESULT_ERROR_UNKNOWN;
+            break;
+        }
+
+        // the value of a range can be replaced by a split or a merge
+        bool tracked = false;
+        if (utils_mutex_lock(&TRACKER->splitMergeMutex) == 0) {
+            tracked = tracker_range_is_tracked(hPool, pr.ranges[i].ptr,
+                                               pr.ranges[i].size);
+            utils_mutex_unlock(&TRACKER->splitMergeMutex);
+        }
+
+        if (!tracked) {
+            // the range was freed (or split or merged) after it was copied
+            utils_mutex_unlock(&p->free_lock);
+            skipped++;
+            continue;
+        }
+
+        ret = umfMemoryProviderMigrate(p->hUpstream, pr.ranges[i].ptr,
+                                       pr.ranges[i].size, target_node);
+        utils_mutex_unlock(&p->free_lock);
+        if (ret != UMF_RESULT_SUCCESS) {
+            LOG_ERR("migrating %p (size=%zu) of pool %p to node %u failed",
+                    pr.ranges[i].ptr, pr.ranges[i].size, (void *)hPool,
+                    target_node);
+            break;
+        }
+    }
+
+    if (ret == UMF_RESULT_SUCCESS) {
+        LOG_DEBUG("migrated %zu ranges of pool %p to node %u (%zu changed "
+                  "meanwhile)",
+                  pr.count - skipped, (void *)hPool, target_node, skipped);
+    }
+
+    umf_ba_global_free(pr.ranges);
+
+    return ret;
+}
+
 static umf_result_t trackingAlloc(void *hProvider, size_t size,
                                   size_t alignment, void **ptr) {
     umf_tracking_memory_provider_t *p =
@@ -341,6 +463,12 @@ static umf_result_t trackingFree(void *hProvider, void *ptr, size_t size) {
     umf_tracking_memory_provider_t *p =
         (umf_tracking_memory_provider_t *)hProvider;
 
+    // wait for the migration of the range (see umfMemoryTrackerMigratePool())
+    if (utils_mutex_lock(&p->free_lock)) {
+        LOG_ERR("locking the free lock failed");
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
     // umfMemoryTrackerRemove should be called before umfMemoryProviderFree
     // to avoid a race condition. If the order would be different, other thread
     // could allocate the memory at address `ptr` before a call to umfMemoryTrackerRemove
@@ -374,19 +502,17 @@ static umf_result_t trackingFree(void *hProvider, void *ptr, size_t size) {
         LOG_ERR("upstream provider failed to free the memory");
         // Do not add memory back to the tracker,
         // if it had not been removed.
-        if (ret_remove != UMF_RESULT_SUCCESS) {
-            return ret;
-        }
-
-        if (umfMemoryTrackerAdd(p->hTracker, p->pool, ptr, size) !=
-            UMF_RESULT_SUCCESS) {
+        if (ret_remove == UMF_RESULT_SUCCESS &&
+            umfMemoryTrackerAdd(p->hTracker, p->pool, ptr, size) !=
+                UMF_RESULT_SUCCESS) {
             LOG_ERR(
                 "cannot add memory back to the tracker, ptr = %p, size = %zu",
                 ptr, size);
         }
-        return ret;
     }
 
+    utils_mutex_unlock(&p->free_lock);
+
     return ret;
 }
 
@@ -400,9 +526,16 @@ static umf_result_t trackingInitialize(void *params, void **ret) {
     *provider = *((umf_tracking_memory_provider_t *)params);
     if (provider->hUpstream == NULL || provider->hTracker == NULL ||
         provider->pool == NULL || provider->ipcCache == NULL) {
+        umf_ba_global_free(provider);
         return UMF_RESULT_ERROR_INVALID_ARGUMENT;
     }
 
+    if (utils_mutex_init(&provider->free_lock) == NULL) {
+        LOG_ERR("initializing the free lock failed");
+        umf_ba_global_free(provider);
+        return UMF_RESULT_ERROR_UNKNOWN;
+    }
+
     *ret = provider;
     return UMF_RESULT_SUCCESS;
 }
@@ -461,6 +594,7 @@ static void trackingFinalize(void *provider) {
         (umf_tracking_memory_provider_t *)provider;
 
     critnib_delete(p->ipcCache);
+    utils_mutex_destroy_not_free(&p->free_lock);
 
     // Do not clear the tracker if we are running in the proxy library,
     // because it may need those resources till
@@ -507,6 +641,13 @@ static umf_result_t trackingPurgeForce(void *provider, void *ptr, size_t size) {
     return umfMemoryProviderPurgeForce(p->hUpstream, ptr, size);
 }
 
+static umf_result_t trackingMigrate(void *provider, void *ptr, size_t size,
+                                    unsigned target_node) {
+    umf_tracking_memory_provider_t *p =
+        (umf_tracking_memory_provider_t *)provider;
+    return umfMemoryProviderMigrate(p->hUpstream, ptr, size, target_node);
+}
+
 static const char *trackingName(void *provider) {
     umf_tracking_memory_provider_t *p =
         (umf_tracking_memory_provider_t *)provider;
@@ -686,6 +827,7 @@ umf_memory_provider_ops_t UMF_TRACKING_MEMORY_PROVIDER_OPS = {
     .ext.purge_lazy = trackingPurgeLazy,
     .ext.allocation_split = trackingAllocationSplit,
     .ext.allocation_merge = trackingAllocationMerge,
+    .ext.migrate = trackingMigrate,
     .ipc.get_ipc_handle_size = trackingGetIpcHandleSize,
     .ipc.get_ipc_handle = trackingGetIpcHandle,
     .ipc.put_ipc_handle = trackingPutIpcHandle,
@@ -50,6 +50,17 @@ typedef struct umf_alloc_info_t {
 umf_result_t umfMemoryTrackerGetAllocInfo(const void *ptr,
                                           umf_alloc_info_t *pAllocInfo);
 
+// Migrates all the ranges tracked for hPool to target_node using the upstream
+// provider of hTrackingProvider (the tracking provider of hPool).
+// The ranges are copied first and migrated without the tracker's lock:
+// ranges added concurrently may be skipped. Each range is checked again right
+// before its migration, with the frees of the pool blocked meanwhile, so
+// a range freed (and maybe reused by another pool) is never migrated.
+umf_result_t
+umfMemoryTrackerMigratePool(umf_memory_pool_handle_t hPool,
+                            umf_memory_provider_handle_t hTrackingProvider,
+                            unsigned target_node);
+
 // Creates a memory provider that tracks each allocation/deallocation through umf_memory_tracker_handle_t and
 // forwards all requests to hUpstream memory Provider. hUpstream lifetime should be managed by the user of this function.
 umf_result_t umfTrackingMemoryProviderCreate(
@@ -25,6 +25,11 @@
  * - _aligned_offset_malloc()
  * - _aligned_offset_realloc()
  * - _aligned_offset_recalloc()
+ *
+ * If the UMF_PROXY environment variable contains "numa=local", the pool is
+ * a local node pool (see pool_local_node.h): allocations go to the pool
+ * of the node the calling thread runs on and frees to the pool owning
+ * the pointer.
  */
 
 #if (defined PROXY_LIB_USES_JEMALLOC_POOL)
@@ -43,6 +48,7 @@
 
 #include <umf/memory_pool.h>
 #include <umf/memory_provider.h>
+#include <umf/pools/pool_local_node.h>
 #include <umf/providers/provider_os_memory.h>
 
 #include "base_alloc_linear.h"
@@ -145,9 +151,21 @@ void proxy_lib_create_common(void) {
         exit(-1);
     }
 
-    umf_result =
-        umfPoolCreate(umfPoolManagerOps(), OS_memory_provider, NULL,
-                      UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &Proxy_pool);
+    if (utils_env_var_has_str("UMF_PROXY", "numa=local")) {
+        LOG_DEBUG("proxy_lib: using a pool per NUMA node");
+        // OS_memory_provider backs the pool of the threads
+        // whose NUMA node cannot be determined
+        umf_local_node_pool_params_t local_node_params =
+            umfLocalNodePoolParamsDefault(umfPoolManagerOps(), NULL);
+        local_node_params.node_provider_params = &os_params;
+        umf_result = umfPoolCreate(
+            umfLocalNodePoolOps(), OS_memory_provider, &local_node_params,
+            UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &Proxy_pool);
+    } else {
+        umf_result =
+            umfPoolCreate(umfPoolManagerOps(), OS_memory_provider, NULL,
+                          UMF_POOL_CREATE_FLAG_DISABLE_TRACKING, &Proxy_pool);
+    }
     if (umf_result != UMF_RESULT_SUCCESS) {
         LOG_ERR("creating UMF pool manager failed");
         exit(-1);
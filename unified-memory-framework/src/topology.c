@@ -7,7 +7,12 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "base_alloc_global.h"
+#include "topology.h"
 #include "umf_hwloc.h"
 #include "utils_concurrency.h"
 #include "utils_log.h"
@@ -26,7 +31,244 @@ void umfDestroyTopology(void) {
     }
 }
 
+#ifndef _WIN32
+
+// The full hwloc discovery (parsing sysfs, /proc/cpuinfo, ...) takes
+// milliseconds, so the discovered topology is cached in the file given by
+// the UMF_TOPOLOGY_CACHE environment variable (default:
+// ~/.cache/umf_topology.xml, an empty value disables the cache) as hwloc XML
+// preceded by a header line. The cache is valid only on the same machine
+// since the same boot (CPUs and memory can be replaced only with a reboot).
+// It holds the whole machine, including the CPUs and nodes disallowed for
+// the process which wrote it (cgroups, cpusets), and every process restricts
+// it to its own allowed CPUs and nodes read from the system.
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <hwloc/export.h>
+
+#include "utils_common.h"
+
+// version of the cache file format
+#define TOPOLOGY_CACHE_VERSION 2
+
+#define TOPOLOGY_CACHE_ENV "UMF_TOPOLOGY_CACHE"
+#define TOPOLOGY_CACHE_DEFAULT "/.cache/umf_topology.xml"
+
+#define TOPOLOGY_CACHE_ID_SIZE 64
+#define TOPOLOGY_CACHE_HEADER_SIZE 256
+
+// reads the first word of the file (an ID), "-" if it cannot be read
+static void topology_cache_read_id(const char *path, char *id, size_t size) {
+    strcpy(id, "-");
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return;
+    }
+
+    char buf[TOPOLOGY_CACHE_ID_SIZE];
+    if (fscanf(file, "%63s", buf) == 1) {
+        snprintf(id, size, "%s", buf);
+    }
+
+    fclose(file);
+}
+
+void umfGetSystemId(char *id, size_t size) {
+    char machine_id[TOPOLOGY_CACHE_ID_SIZE];
+    char boot_id[TOPOLOGY_CACHE_ID_SIZE];
+
+    topology_cache_read_id("/etc/machine-id", machine_id, sizeof(machine_id));
+    topology_cache_read_id("/proc/sys/kernel/random/boot_id", boot_id,
+                           sizeof(boot_id));
+
+    snprintf(id, size, "%s %s", machine_id, boot_id);
+}
+
+static void topology_cache_header(char *header, size_t size) {
+    char system_id[UMF_SYSTEM_ID_SIZE];
+    umfGetSystemId(system_id, sizeof(system_id));
+
+    snprintf(header, size, "umf-topology %u %x %s\n", TOPOLOGY_CACHE_VERSION,
+             (unsigned)HWLOC_API_VERSION, system_id);
+}
+
+static int topology_cache_get_path(char *path, size_t size) {
+    // the user asked hwloc explicitly for another topology
+    if (getenv("HWLOC_XMLFILE") || getenv("HWLOC_SYNTHETIC") ||
+        getenv("HWLOC_FSROOT") || getenv("HWLOC_COMPONENTS")) {
+        return -1;
+    }
+
+    const char *env = getenv(TOPOLOGY_CACHE_ENV);
+    const char *home = getenv("HOME");
+    if (env) {
+        // an empty path disables the file cache
+        utils_copy_path(env, path, size);
+    } else if (home) {
+        // ~/.cache may not exist yet
+        snprintf(path, size, "%s/.cache", home);
+        if (mkdir(path, 0700) && errno != EEXIST) {
+            LOG_PDEBUG("cannot create the cache directory: %s", path);
+        }
+        snprintf(path, size, "%s%s", home, TOPOLOGY_CACHE_DEFAULT);
+    } else {
+        path[0] = '\0';
+    }
+
+    return (path[0] == '\0') ? -1 : 0;
+}
+
+// Loads the topology from the XML (of the whole machine) restricted to the
+// resources allowed for this process. Returns 0 on success.
+static int topology_load_xml(const char *xml, size_t xml_size) {
+    if (hwloc_topology_init(&topology)) {
+        topology = NULL;
+        return -1;
+    }
+
+    // the binding functions are allowed only for "this system" and
+    // the allowed resources of this process are read from the system
+    // (the disallowed ones are removed, HWLOC_TOPOLOGY_FLAG_INCLUDE_DISALLOWED
+    // is not set)
+    if (hwloc_topology_set_flags(
+            topology, HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM |
+                          HWLOC_TOPOLOGY_FLAG_THISSYSTEM_ALLOWED_RESOURCES) ||
+        hwloc_topology_set_xmlbuffer(topology, xml, (int)xml_size + 1) ||
+        hwloc_topology_load(topology)) {
+        hwloc_topology_destroy(topology);
+        topology = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+// returns 0 if the topology was loaded from the cache
+static int topology_cache_load(const char *path, const char *header) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+
+    int ret = -1;
+    char *xml = NULL;
+
+    char file_header[TOPOLOGY_CACHE_HEADER_SIZE];
+    if (!fgets(file_header, sizeof(file_header), file) ||
+        strcmp(file_header, header) != 0) {
+        LOG_INFO("ignoring the stale topology cache: %s", path);
+        goto err_close;
+    }
+
+    long start = ftell(file);
+    if (start < 0 || fseek(file, 0, SEEK_END) != 0) {
+        goto err_close;
+    }
+
+    long end = ftell(file);
+    if (end <= start || end - start >= INT_MAX ||
+        fseek(file, start, SEEK_SET) != 0) {
+        goto err_close;
+    }
+
+    size_t xml_size = (size_t)(end - start);
+    xml = umf_ba_global_alloc(xml_size + 1);
+    if (!xml) {
+        goto err_close;
+    }
+
+    if (fread(xml, 1, xml_size, file) != xml_size) {
+        goto err_free_xml;
+    }
+    xml[xml_size] = '\0';
+
+    if (topology_load_xml(xml, xml_size)) {
+        LOG_INFO("ignoring the invalid topology cache: %s", path);
+        goto err_free_xml;
+    }
+
+    LOG_DEBUG("topology loaded from the cache: %s", path);
+    ret = 0;
+
+err_free_xml:
+    umf_ba_global_free(xml);
+err_close:
+    fclose(file);
+    return ret;
+}
+
+// Discovers the whole machine (including the resources disallowed for this
+// process), stores it in the cache and loads the topology of this process
+// from it. Returns 0 on success.
+static int topology_cache_create(const char *path, const char *header) {
+    hwloc_topology_t machine;
+    if (hwloc_topology_init(&machine)) {
+        return -1;
+    }
+
+    int ret = -1;
+    char *xml = NULL;
+    int xml_size = 0;
+    if (hwloc_topology_set_flags(machine,
+                                 HWLOC_TOPOLOGY_FLAG_INCLUDE_DISALLOWED) ||
+        hwloc_topology_load(machine) ||
+        hwloc_topology_export_xmlbuffer(machine, &xml, &xml_size, 0)) {
+        LOG_DEBUG("cannot export the topology to XML");
+        goto err_destroy_machine;
+    }
+
+    // xml_size includes the terminating null byte
+    if (topology_load_xml(xml, (size_t)xml_size - 1)) {
+        goto err_free_xml;
+    }
+    ret = 0;
+
+    char tmp_path[PATH_MAX + 16];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, (int)getpid());
+
+    FILE *file = fopen(tmp_path, "w");
+    if (!file) {
+        LOG_PDEBUG("cannot write the topology cache: %s", tmp_path);
+        goto err_free_xml;
+    }
+
+    fputs(header, file);
+    fwrite(xml, 1, (size_t)xml_size - 1, file);
+
+    if (fclose(file) || rename(tmp_path, path)) {
+        LOG_PDEBUG("cannot write the topology cache: %s", path);
+        unlink(tmp_path);
+    }
+
+err_free_xml:
+    hwloc_free_xmlbuffer(machine, xml);
+err_destroy_machine:
+    hwloc_topology_destroy(machine);
+    return ret;
+}
+
+#endif /* !_WIN32 */
+
 static void umfCreateTopology(void) {
+#ifndef _WIN32
+    char cache_path[PATH_MAX];
+    char header[TOPOLOGY_CACHE_HEADER_SIZE];
+    int use_cache =
+        (topology_cache_get_path(cache_path, sizeof(cache_path)) == 0);
+    if (use_cache) {
+        topology_cache_header(header, sizeof(header));
+        if (topology_cache_load(cache_path, header) == 0 ||
+            topology_cache_create(cache_path, header) == 0) {
+            return;
+        }
+    }
+#endif
+
     if (hwloc_topology_init(&topology)) {
         LOG_ERR("Failed to initialize topology");
         topology = NULL;
@@ -37,6 +279,7 @@ static void umfCreateTopology(void) {
         LOG_ERR("Failed to initialize topology");
         hwloc_topology_destroy(topology);
         topology = NULL;
+        return;
     }
 }
 
@@ -19,6 +19,15 @@ extern "C" {
 hwloc_topology_t umfGetTopology(void);
 void umfDestroyTopology(void);
 
+#ifndef _WIN32
+#define UMF_SYSTEM_ID_SIZE 160
+
+// Writes "<machine-id> <boot-id>" of this system to id ("-" for an ID which
+// cannot be read). Files caching data discovered from the system (the
+// topology, the measured memory attributes) are valid only for the same ID.
+void umfGetSystemId(char *id, size_t size);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
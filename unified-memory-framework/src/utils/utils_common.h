@@ -41,6 +41,8 @@ typedef enum umf_purge_advise_t {
     ((align != 0 && (((value) & ((align)-1)) != 0)))
 #define ALIGN_UP(value, align) (((value) + (align)-1) & ~((align)-1))
 #define ALIGN_DOWN(value, align) ((value) & ~((align)-1))
+
+#define UMF_CACHE_LINE_SIZE 64
 #define ASSERT_IS_ALIGNED(value, align)                                        \
     DO_WHILE_EXPRS(assert(IS_ALIGNED(value, align)))
 
@@ -138,6 +140,17 @@ int utils_munmap(void *addr, size_t length);
 
 int utils_purge(void *addr, size_t length, int advice);
 
+// pre-fault (write-populate) all pages of the given range
+int utils_populate(void *addr, size_t length);
+
+// get the NUMA node backing the page of the given address without faulting
+// it in; returns -1 if the page is not present or the node cannot be queried
+int utils_get_numa_node_of_addr(const void *addr);
+
+// get the NUMA node of the CPU the calling thread is running on;
+// returns -1 if it cannot be queried
+int utils_get_current_numa_node(void);
+
 void utils_strerror(int errnum, char *buf, size_t buflen);
 
 int utils_devdax_open(const char *path);
@@ -84,6 +84,10 @@ static __inline unsigned char utils_mssb_index(long long value) {
     InterlockedIncrement64((LONG64 volatile *)object)
 #define utils_fetch_and_add64(ptr, value)                                      \
     InterlockedExchangeAdd64((LONG64 *)(ptr), value)
+#define utils_compare_exchange_ptr(object, expected, desired)                  \
+    (InterlockedCompareExchangePointer((PVOID volatile *)(object),             \
+                                       (PVOID)(desired),                       \
+                                       (PVOID)(expected)) == (PVOID)(expected))
 #else
 #define utils_lssb_index(x) ((unsigned char)__builtin_ctzll(x))
 #define utils_mssb_index(x) ((unsigned char)(63 - __builtin_clzll(x)))
@@ -102,6 +106,8 @@ static __inline unsigned char utils_mssb_index(long long value) {
 #define utils_atomic_increment(object)                                         \
     __atomic_add_fetch(object, 1, __ATOMIC_ACQ_REL)
 #define utils_fetch_and_add64 __sync_fetch_and_add
+#define utils_compare_exchange_ptr(object, expected, desired)                  \
+    __sync_bool_compare_and_swap(object, expected, desired)
 #endif
 
 #ifdef __cplusplus
@@ -7,8 +7,11 @@
  *
  */
 
+#define _GNU_SOURCE 1
+
 #include <errno.h>
 #include <fcntl.h>
+#include <sched.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
@@ -232,3 +235,45 @@ int utils_create_anonymous_fd(void) {
 
     return fd;
 }
+
+int utils_get_numa_node_of_addr(const void *addr) {
+#ifdef __NR_move_pages
+    size_t page_size = utils_get_page_size();
+    void *page = (void *)((uintptr_t)addr & ~(page_size - 1));
+    int status = -1;
+
+    // move_pages() with nodes == NULL only queries the placement
+    // and - unlike get_mempolicy(MPOL_F_ADDR) - does not fault the page in
+    if (syscall(__NR_move_pages, 0, 1, &page, NULL, &status, 0) != 0) {
+        return -1;
+    }
+
+    return (status >= 0) ? status : -1;
+#else
+    (void)addr; // unused
+    return -1;
+#endif /* __NR_move_pages */
+}
+
+int utils_get_current_numa_node(void) {
+    unsigned cpu, node;
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    // the glibc wrapper uses the vDSO, so it does not enter the kernel
+    if (getcpu(&cpu, &node) != 0) {
+        return -1;
+    }
+
+    return (int)node;
+#elif defined(__NR_getcpu)
+    if (syscall(__NR_getcpu, &cpu, &node, NULL) != 0) {
+        return -1;
+    }
+
+    return (int)node;
+#else
+    (void)cpu;
+    (void)node;
+    return -1;
+#endif
+}
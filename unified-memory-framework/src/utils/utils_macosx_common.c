@@ -83,3 +83,12 @@ int utils_shm_unlink(const char *shm_name) {
 int utils_create_anonymous_fd(void) {
     return 0; // ignored on MacOSX
 }
+
+int utils_get_numa_node_of_addr(const void *addr) {
+    (void)addr; // unused
+    return -1;  // not supported on MacOSX
+}
+
+int utils_get_current_numa_node(void) {
+    return -1; // not supported on MacOSX
+}
@@ -187,6 +187,25 @@ int utils_purge(void *addr, size_t length, int advice) {
     return madvise(addr, length, utils_translate_purge_advise(advice));
 }
 
+int utils_populate(void *addr, size_t length) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(addr, length, MADV_POPULATE_WRITE) == 0) {
+        return 0;
+    }
+    // EINVAL means the kernel is older than 5.14 and does not know
+    // MADV_POPULATE_WRITE - fall back to touching the pages
+    if (errno != EINVAL) {
+        return -1;
+    }
+#endif
+    size_t page_size = utils_get_page_size();
+    for (size_t off = 0; off < length; off += page_size) {
+        ((volatile char *)addr)[off] = 0;
+    }
+
+    return 0;
+}
+
 void utils_strerror(int errnum, char *buf, size_t buflen) {
 // 'strerror_r' implementation is XSI-compliant (returns 0 on success)
 #if (_POSIX_C_SOURCE >= 200112L || _XOPEN_SOURCE >= 600) && !_GNU_SOURCE
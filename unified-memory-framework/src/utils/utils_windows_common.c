@@ -184,6 +184,15 @@ int utils_purge(void *addr, size_t length, int advice) {
 #endif // _MSC_VER
 }
 
+int utils_populate(void *addr, size_t length) {
+    size_t page_size = utils_get_page_size();
+    for (size_t off = 0; off < length; off += page_size) {
+        ((volatile char *)addr)[off] = 0;
+    }
+
+    return 0;
+}
+
 void utils_strerror(int errnum, char *buf, size_t buflen) {
     strerror_s(buf, buflen, errnum);
 }
@@ -216,3 +225,20 @@ int utils_fallocate(int fd, long offset, long len) {
 
     return -1;
 }
+
+int utils_get_numa_node_of_addr(const void *addr) {
+    (void)addr; // unused
+    return -1;  // not supported on Windows
+}
+
+int utils_get_current_numa_node(void) {
+    PROCESSOR_NUMBER proc;
+    USHORT node;
+
+    GetCurrentProcessorNumberEx(&proc);
+    if (!GetNumaProcessorNodeEx(&proc, &node)) {
+        return -1;
+    }
+
+    return (int)node;
+}
@@ -18,12 +18,14 @@
 #include <umf/proxy_lib_new_delete.h>
 #endif
 
+#include <algorithm>
 #include <array>
 #include <string>
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 using umf_test::test;
 using namespace umf_test;
@@ -178,6 +180,160 @@ TEST_F(test, BasicPoolByPtrTest) {
     ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
 }
 
+static umf_memory_pool_handle_t createUntrackedMallocPool() {
+    umf_memory_provider_handle_t provider;
+    umf_result_t ret =
+        umfMemoryProviderCreate(&MALLOC_PROVIDER_OPS, NULL, &provider);
+    if (ret != UMF_RESULT_SUCCESS) {
+        return nullptr;
+    }
+
+    return createPoolChecked(umfProxyPoolOps(), provider, nullptr,
+                             UMF_POOL_CREATE_FLAG_OWN_PROVIDER |
+                                 UMF_POOL_CREATE_FLAG_DISABLE_TRACKING);
+}
+
+TEST_F(test, poolSamplingEveryAllocation) {
+    constexpr size_t NUM_ALLOCS = 16;
+    auto pool = wrapPoolUnique(createUntrackedMallocPool());
+    ASSERT_NE(pool.get(), nullptr);
+
+    size_t count = 1;
+    auto ret = umfPoolGetSamples(pool.get(), nullptr, &count);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(count, 0);
+
+    ret = umfPoolSetSampling(pool.get(), 1, 0);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+
+    std::array<void *, NUM_ALLOCS> ptrs;
+    for (size_t i = 0; i < NUM_ALLOCS; i++) {
+        ptrs[i] = umfPoolMalloc(pool.get(), (i + 1) * 64);
+        ASSERT_NE(ptrs[i], nullptr);
+    }
+
+    ret = umfPoolGetSamples(pool.get(), nullptr, &count);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(count, NUM_ALLOCS);
+
+    std::array<umf_pool_sample_t, NUM_ALLOCS> samples;
+    ret = umfPoolGetSamples(pool.get(), samples.data(), &count);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(count, NUM_ALLOCS);
+
+    for (auto &sample : samples) {
+        auto it = std::find(ptrs.begin(), ptrs.end(), sample.ptr);
+        ASSERT_NE(it, ptrs.end());
+        size_t size = (size_t)(it - ptrs.begin() + 1) * 64;
+        EXPECT_EQ(sample.size, size);
+        EXPECT_EQ(sample.weight, size);
+        EXPECT_NE(sample.call_site, nullptr);
+    }
+
+    // the samples of the freed blocks are dropped
+    for (size_t i = 0; i < NUM_ALLOCS / 2; i++) {
+        ASSERT_EQ(umfPoolFree(pool.get(), ptrs[i]), UMF_RESULT_SUCCESS);
+    }
+
+    ret = umfPoolGetSamples(pool.get(), nullptr, &count);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(count, NUM_ALLOCS / 2);
+
+    for (size_t i = NUM_ALLOCS / 2; i < NUM_ALLOCS; i++) {
+        ASSERT_EQ(umfPoolFree(pool.get(), ptrs[i]), UMF_RESULT_SUCCESS);
+    }
+}
+
+TEST_F(test, poolSamplingRealloc) {
+    // the proxy pool has no realloc, this one calls ::realloc()
+    umf_memory_provider_handle_t provider;
+    ASSERT_EQ(
+        umfMemoryProviderCreate(&UMF_NULL_PROVIDER_OPS, nullptr, &provider),
+        UMF_RESULT_SUCCESS);
+    auto pool = wrapPoolUnique(
+        createPoolChecked(&MALLOC_POOL_OPS, provider, nullptr,
+                          UMF_POOL_CREATE_FLAG_OWN_PROVIDER |
+                              UMF_POOL_CREATE_FLAG_DISABLE_TRACKING));
+    ASSERT_NE(pool.get(), nullptr);
+
+    auto ret = umfPoolSetSampling(pool.get(), 1, 0);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+
+    void *ptr = umfPoolMalloc(pool.get(), 64);
+    ASSERT_NE(ptr, nullptr);
+
+    // a failed realloc keeps the block and its sample
+    ASSERT_EQ(umfPoolRealloc(pool.get(), ptr, SIZE_MAX / 2), nullptr);
+
+    size_t count = 1;
+    umf_pool_sample_t sample;
+    ret = umfPoolGetSamples(pool.get(), &sample, &count);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(count, 1);
+    EXPECT_EQ(sample.ptr, ptr);
+    EXPECT_EQ(sample.size, 64);
+
+    // a successful one replaces it with the sample of the new block
+    void *new_ptr = umfPoolRealloc(pool.get(), ptr, 4096);
+    ASSERT_NE(new_ptr, nullptr);
+
+    count = 1;
+    ret = umfPoolGetSamples(pool.get(), &sample, &count);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(count, 1);
+    EXPECT_EQ(sample.ptr, new_ptr);
+    EXPECT_EQ(sample.size, 4096);
+
+    ASSERT_EQ(umfPoolFree(pool.get(), new_ptr), UMF_RESULT_SUCCESS);
+}
+
+TEST_F(test, poolSamplingHeapEstimate) {
+    constexpr size_t NUM_ALLOCS = 20000;
+    constexpr size_t ALLOC_SIZE = 64;
+    constexpr size_t HEAP_SIZE = NUM_ALLOCS * ALLOC_SIZE;
+
+    for (auto period : {std::make_pair((size_t)16, (size_t)0),
+                        std::make_pair((size_t)0, (size_t)4096)}) {
+        auto pool = wrapPoolUnique(createUntrackedMallocPool());
+        ASSERT_NE(pool.get(), nullptr);
+
+        auto ret = umfPoolSetSampling(pool.get(), period.first, period.second);
+        ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+
+        std::vector<void *> ptrs(NUM_ALLOCS);
+        for (auto &ptr : ptrs) {
+            ptr = umfPoolMalloc(pool.get(), ALLOC_SIZE);
+            ASSERT_NE(ptr, nullptr);
+        }
+
+        size_t count = 0;
+        ret = umfPoolGetSamples(pool.get(), nullptr, &count);
+        ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+        ASSERT_GT(count, 0);
+
+        std::vector<umf_pool_sample_t> samples(count);
+        ret = umfPoolGetSamples(pool.get(), samples.data(), &count);
+        ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+
+        size_t estimate = 0;
+        for (size_t i = 0; i < count; i++) {
+            estimate += samples[i].weight;
+        }
+
+        // the weighted samples estimate the live heap size
+        EXPECT_GT(estimate, HEAP_SIZE / 2);
+        EXPECT_LT(estimate, HEAP_SIZE * 2);
+
+        for (auto ptr : ptrs) {
+            ASSERT_EQ(umfPoolFree(pool.get(), ptr), UMF_RESULT_SUCCESS);
+        }
+
+        ret = umfPoolGetSamples(pool.get(), nullptr, &count);
+        ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+        ASSERT_EQ(count, 0);
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     mallocPoolTest, umfPoolTest,
     ::testing::Values(poolCreateExtParams{&MALLOC_POOL_OPS, nullptr,
@@ -103,3 +103,15 @@ TEST_F(numaNodesTest, getIdInvalid) {
     ret = umfMemtargetGetId(hTarget, NULL);
     EXPECT_EQ(ret, UMF_RESULT_ERROR_INVALID_ARGUMENT);
 }
+
+TEST_F(test, memTargetLatencyBandwidthAvailable) {
+    // without HMAT the values are measured, so these memspaces
+    // have to be available on every machine
+    auto memspace = umfMemspaceLowestLatencyGet();
+    ASSERT_NE(memspace, nullptr);
+    EXPECT_GT(umfMemspaceMemtargetNum(memspace), 0);
+
+    memspace = umfMemspaceHighestBandwidthGet();
+    ASSERT_NE(memspace, nullptr);
+    EXPECT_GT(umfMemspaceMemtargetNum(memspace), 0);
+}
@@ -144,6 +144,83 @@ TEST_F(test, sharedLimits) {
     EXPECT_EQ(MaxSize / SlabMinSize * 2, numFrees);
 }
 
+TEST_F(test, alignedFreeInLargeSlab) {
+    umf_memory_provider_handle_t provider_handle = nullptr;
+    umf_result_t ret = umfMemoryProviderCreate(&MALLOC_PROVIDER_OPS, nullptr,
+                                               &provider_handle);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    auto providerUnique = wrapProviderUnique(provider_handle);
+
+    umf_disjoint_pool_params_t params = poolConfig();
+    params.MaxPoolableSize = 64 * 1024;
+
+    umf_memory_pool_handle_t pool = nullptr;
+    ret = umfPoolCreate(umfDisjointPoolOps(), provider_handle, &params, 0,
+                        &pool);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    auto poolHandle = umf_test::wrapPoolUnique(pool);
+
+    // the slabs of these allocations are larger than SlabMinSize and
+    // the aligned pointer may lie past the first SlabMinSize bytes
+    static constexpr size_t size = 4096;
+    for (size_t alignment = 8192; alignment <= 32768; alignment *= 2) {
+        void *ptr = umfPoolAlignedMalloc(pool, size, alignment);
+        ASSERT_NE(ptr, nullptr);
+        ASSERT_EQ((uintptr_t)ptr % alignment, 0);
+        memset(ptr, 0, size);
+
+        EXPECT_GE(umfPoolMallocUsableSize(pool, ptr), size);
+        EXPECT_EQ(umfPoolFree(pool, ptr), UMF_RESULT_SUCCESS);
+    }
+}
+
+TEST_F(test, numaDisjointPoolThreadCache) {
+    umf_memory_provider_handle_t provider_handle = nullptr;
+    umf_result_t ret = umfMemoryProviderCreate(&MALLOC_PROVIDER_OPS, nullptr,
+                                               &provider_handle);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    auto providerUnique = wrapProviderUnique(provider_handle);
+
+    umf_numa_disjoint_pool_params_t params = umfNumaDisjointPoolParamsDefault();
+
+    umf_memory_pool_handle_t pool = nullptr;
+    ret = umfPoolCreate(umfNumaDisjointPoolOps(), provider_handle, &params, 0,
+                        &pool);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    auto poolHandle = umf_test::wrapPoolUnique(pool);
+
+    static constexpr size_t size = 64;
+    void *ptr = umfPoolMalloc(pool, size);
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, 0, size);
+    EXPECT_EQ(umfPoolMallocUsableSize(pool, ptr), size);
+
+    if (umfPoolByPtr(ptr) == pool) {
+        // no NUMA node pool - served by the provider of the pool
+        umfPoolFree(pool, ptr);
+        GTEST_SKIP() << "NUMA nodes are not available";
+    }
+
+    // the chunk freed by the thread is reused by its next allocation
+    EXPECT_EQ(umfPoolFree(pool, ptr), UMF_RESULT_SUCCESS);
+    void *ptr2 = umfPoolMalloc(pool, size);
+    EXPECT_EQ(ptr2, ptr);
+
+    // the cache of a thread is returned to the pool when the thread exits
+    std::thread([&] {
+        std::vector<void *> ptrs;
+        for (size_t i = 0; i < 2 * params.ThreadCacheSize; i++) {
+            ptrs.push_back(umfPoolMalloc(pool, size));
+            ASSERT_NE(ptrs.back(), nullptr);
+        }
+        for (auto p : ptrs) {
+            umfPoolFree(pool, p);
+        }
+    }).join();
+
+    umfPoolFree(pool, ptr2);
+}
+
 auto defaultPoolConfig = poolConfig();
 INSTANTIATE_TEST_SUITE_P(disjointPoolTests, umfPoolTest,
                          ::testing::Values(poolCreateExtParams{
@@ -158,6 +235,13 @@ INSTANTIATE_TEST_SUITE_P(
                             (void *)&defaultPoolConfig.Capacity, nullptr},
         static_cast<int>(defaultPoolConfig.Capacity) / 2)));
 
+auto defaultNumaPoolConfig = umfNumaDisjointPoolParamsDefault();
+INSTANTIATE_TEST_SUITE_P(numaDisjointPoolTests, umfPoolTest,
+                         ::testing::Values(poolCreateExtParams{
+                             umfNumaDisjointPoolOps(),
+                             (void *)&defaultNumaPoolConfig,
+                             &MALLOC_PROVIDER_OPS, nullptr, nullptr}));
+
 INSTANTIATE_TEST_SUITE_P(disjointMultiPoolTests, umfMultiPoolTest,
                          ::testing::Values(poolCreateExtParams{
                              umfDisjointPoolOps(), (void *)&defaultPoolConfig,
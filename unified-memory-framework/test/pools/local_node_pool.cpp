@@ -0,0 +1,138 @@
+// Copyright (C) 2024 Intel Corporation
+// Under the Apache License v2.0 with LLVM Exceptions. See LICENSE.TXT.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "umf/pools/pool_local_node.h"
+#include "umf/pools/pool_proxy.h"
+#include "umf/providers/provider_os_memory.h"
+
+#include <numaif.h>
+
+#include "pool.hpp"
+#include "poolFixtures.hpp"
+
+using umf_test::test;
+
+auto defaultProviderParams = umfOsMemoryProviderParamsDefault();
+auto defaultPoolParams = umfLocalNodePoolParamsDefault(umfProxyPoolOps(),
+                                                       nullptr);
+
+INSTANTIATE_TEST_SUITE_P(localNodePoolTest, umfPoolTest,
+                         ::testing::Values(poolCreateExtParams{
+                             umfLocalNodePoolOps(), &defaultPoolParams,
+                             umfOsMemoryProviderOps(), &defaultProviderParams,
+                             nullptr}));
+
+struct localNodePoolTest : test {
+    void SetUp() override {
+        test::SetUp();
+
+        umf_result_t ret = umfMemoryProviderCreate(
+            umfOsMemoryProviderOps(), &defaultProviderParams, &hProvider);
+        ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    }
+
+    void TearDown() override {
+        if (hPool) {
+            umfPoolDestroy(hPool);
+        }
+        if (hProvider) {
+            umfMemoryProviderDestroy(hProvider);
+        }
+        test::TearDown();
+    }
+
+    void createPool(umf_local_node_pool_params_t *params) {
+        umf_result_t ret =
+            umfPoolCreate(umfLocalNodePoolOps(), hProvider, params, 0, &hPool);
+        ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+        ASSERT_NE(hPool, nullptr);
+    }
+
+    umf_memory_provider_handle_t hProvider = nullptr;
+    umf_memory_pool_handle_t hPool = nullptr;
+};
+
+TEST_F(localNodePoolTest, create_WRONG_PARAMS) {
+    umf_memory_pool_handle_t pool = nullptr;
+    umf_result_t ret = umfPoolCreate(umfLocalNodePoolOps(), hProvider,
+                                     nullptr, 0, &pool);
+    EXPECT_EQ(ret, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+
+    umf_local_node_pool_params_t params =
+        umfLocalNodePoolParamsDefault(nullptr, nullptr);
+    ret = umfPoolCreate(umfLocalNodePoolOps(), hProvider, &params, 0, &pool);
+    EXPECT_EQ(ret, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+}
+
+// every node refresh period is checked - also 0 (the node is read
+// on every allocation)
+TEST_F(localNodePoolTest, allocOnLocalNode) {
+    umf_local_node_pool_params_t params = defaultPoolParams;
+
+    for (unsigned period : {0u, 1u, 256u}) {
+        params.node_refresh_period = period;
+        createPool(&params);
+
+        for (int i = 0; i < 1000; i++) {
+            int mem_node = -1;
+            void *ptr = umfPoolMalloc(hPool, 4096);
+            ASSERT_NE(ptr, nullptr);
+            memset(ptr, 0xFF, 4096);
+
+            // the memory comes from the pool of one of the nodes
+            umf_memory_pool_handle_t owner = umfPoolByPtr(ptr);
+            ASSERT_NE(owner, nullptr);
+            EXPECT_NE(owner, hPool);
+
+            int ret = get_mempolicy(&mem_node, nullptr, 0, ptr,
+                                    MPOL_F_NODE | MPOL_F_ADDR);
+            EXPECT_EQ(ret, 0);
+            EXPECT_GE(mem_node, 0);
+
+            EXPECT_EQ(umfPoolFree(hPool, ptr), UMF_RESULT_SUCCESS);
+        }
+
+        umfPoolDestroy(hPool);
+        hPool = nullptr;
+    }
+}
+
+// the error of the node pool is returned by the local node pool
+TEST_F(localNodePoolTest, lastAllocationError) {
+    createPool(&defaultPoolParams);
+
+    void *ptr = umfPoolMalloc(hPool, 64);
+    ASSERT_NE(ptr, nullptr);
+
+    // the proxy pool does not support realloc
+    EXPECT_EQ(umfPoolRealloc(hPool, ptr, 8192), nullptr);
+    EXPECT_EQ(umfPoolGetLastAllocationError(hPool),
+              UMF_RESULT_ERROR_NOT_SUPPORTED);
+
+    EXPECT_EQ(umfPoolFree(hPool, ptr), UMF_RESULT_SUCCESS);
+}
+
+// the node pool of the calling thread owns its allocations
+TEST_F(localNodePoolTest, getNode) {
+    createPool(&defaultPoolParams);
+
+    umf_memory_pool_handle_t nodePool = nullptr;
+    int node = umfLocalNodePoolGetLocalNode(hPool, &nodePool);
+    ASSERT_GE(node, 0);
+    ASSERT_NE(nodePool, nullptr);
+
+    void *ptr = umfPoolMalloc(hPool, 4096);
+    ASSERT_NE(ptr, nullptr);
+
+    umf_memory_pool_handle_t owner = nullptr;
+    EXPECT_EQ(umfLocalNodePoolGetNodeOf(hPool, ptr, &owner), node);
+    EXPECT_EQ(owner, nodePool);
+    EXPECT_EQ(umfPoolByPtr(ptr), nodePool);
+
+    EXPECT_EQ(umfPoolFree(hPool, ptr), UMF_RESULT_SUCCESS);
+
+    // not a local node pool
+    EXPECT_EQ(umfLocalNodePoolGetLocalNode(nodePool, nullptr), -1);
+    EXPECT_EQ(umfLocalNodePoolGetNodeOf(nodePool, ptr, nullptr), -1);
+}
@@ -6,6 +6,8 @@
 */
 
 #include <random>
+#include <thread>
+#include <vector>
 
 #include "provider.hpp"
 
@@ -631,3 +633,299 @@ TEST_P(CoarseWithMemoryStrategyTest, coarseProvider_purge_with_upstream) {
     umfMemoryProviderDestroy(coarse_memory_provider);
     umfMemoryProviderDestroy(malloc_memory_provider);
 }
+
+TEST_P(CoarseWithMemoryStrategyTest, coarseProvider_shards_no_upstream) {
+    umf_result_t umf_result;
+
+    const size_t init_buffer_size = 20 * MB;
+
+    // preallocate some memory and initialize the vector with zeros
+    std::vector<char> buffer(init_buffer_size, 0);
+    void *buf = (void *)buffer.data();
+    ASSERT_NE(buf, nullptr);
+
+    coarse_memory_provider_params_t coarse_memory_provider_params;
+    // make sure there are no undefined members - prevent a UB
+    memset(&coarse_memory_provider_params, 0,
+           sizeof(coarse_memory_provider_params));
+    coarse_memory_provider_params.allocation_strategy = allocation_strategy;
+    coarse_memory_provider_params.upstream_memory_provider = nullptr;
+    coarse_memory_provider_params.immediate_init_from_upstream = false;
+    coarse_memory_provider_params.init_buffer = buf;
+    coarse_memory_provider_params.init_buffer_size = init_buffer_size;
+    coarse_memory_provider_params.num_shards = 4;
+
+    umf_memory_provider_handle_t coarse_memory_provider;
+    umf_result = umfMemoryProviderCreate(umfCoarseMemoryProviderOps(),
+                                         &coarse_memory_provider_params,
+                                         &coarse_memory_provider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(coarse_memory_provider, nullptr);
+
+    umf_memory_provider_handle_t cp = coarse_memory_provider;
+    ASSERT_EQ(GetStats(cp).used_size, 0);
+    ASSERT_EQ(GetStats(cp).num_all_blocks, 1);
+
+    // use up the whole init buffer in small blocks
+    const size_t block_size = 64 * KB;
+    std::vector<void *> ptrs(init_buffer_size / block_size);
+    for (auto &ptr : ptrs) {
+        umf_result = umfMemoryProviderAlloc(cp, block_size, 0, &ptr);
+        ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+        ASSERT_NE(ptr, nullptr);
+    }
+
+    // a freed block is reused by the next allocation of the same size
+    void *ptr = ptrs.back();
+    umf_result = umfMemoryProviderFree(cp, ptr, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderAlloc(cp, block_size, 0, &ptrs.back());
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(ptrs.back(), ptr);
+
+    for (auto &ptr : ptrs) {
+        umf_result = umfMemoryProviderFree(cp, ptr, block_size);
+        ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    }
+
+    // the blocks cached in the shards have to be coalesced
+    // to satisfy an allocation of the whole init buffer
+    umf_result = umfMemoryProviderAlloc(cp, init_buffer_size, 0, &ptr);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(ptr, buf);
+    ASSERT_EQ(GetStats(cp).used_size, init_buffer_size);
+
+    umf_result = umfMemoryProviderFree(cp, ptr, init_buffer_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(GetStats(cp).used_size, 0);
+    ASSERT_EQ(GetStats(cp).num_all_blocks, 1);
+
+    umfMemoryProviderDestroy(coarse_memory_provider);
+}
+
+TEST_P(CoarseWithMemoryStrategyTest, coarseProvider_shards_multithreaded) {
+    umf_memory_provider_handle_t malloc_memory_provider;
+    umf_result_t umf_result;
+
+    umf_result = umfMemoryProviderCreate(&UMF_MALLOC_MEMORY_PROVIDER_OPS, NULL,
+                                         &malloc_memory_provider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(malloc_memory_provider, nullptr);
+
+    const size_t init_buffer_size = 20 * MB;
+    const size_t num_threads = 8;
+
+    coarse_memory_provider_params_t coarse_memory_provider_params;
+    // make sure there are no undefined members - prevent a UB
+    memset(&coarse_memory_provider_params, 0,
+           sizeof(coarse_memory_provider_params));
+    coarse_memory_provider_params.allocation_strategy = allocation_strategy;
+    coarse_memory_provider_params.upstream_memory_provider =
+        malloc_memory_provider;
+    coarse_memory_provider_params.immediate_init_from_upstream = true;
+    coarse_memory_provider_params.init_buffer = NULL;
+    coarse_memory_provider_params.init_buffer_size = init_buffer_size;
+    coarse_memory_provider_params.num_shards = num_threads / 2;
+
+    umf_memory_provider_handle_t coarse_memory_provider;
+    umf_result = umfMemoryProviderCreate(umfCoarseMemoryProviderOps(),
+                                         &coarse_memory_provider_params,
+                                         &coarse_memory_provider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(coarse_memory_provider, nullptr);
+
+    umf_memory_provider_handle_t cp = coarse_memory_provider;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([cp, t]() {
+            std::mt19937 rng(t);
+            std::uniform_int_distribution<size_t> dist(1, 16);
+            std::vector<std::pair<void *, size_t>> allocs;
+            for (int i = 0; i < 2000; i++) {
+                if (allocs.size() < 32 && (rng() % 2 || allocs.empty())) {
+                    size_t size = dist(rng) * 4 * KB;
+                    void *ptr = nullptr;
+                    umfMemoryProviderAlloc(cp, size, 0, &ptr);
+                    if (ptr) {
+                        memset(ptr, (int)t, size);
+                        allocs.emplace_back(ptr, size);
+                    }
+                } else {
+                    size_t idx = rng() % allocs.size();
+                    umfMemoryProviderFree(cp, allocs[idx].first,
+                                          allocs[idx].second);
+                    allocs[idx] = allocs.back();
+                    allocs.pop_back();
+                }
+            }
+            for (auto &alloc : allocs) {
+                umfMemoryProviderFree(cp, alloc.first, alloc.second);
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // all cached blocks are coalesced before the stats are read
+    coarse_memory_provider_stats_t stats = GetStats(cp);
+    ASSERT_EQ(stats.used_size, 0);
+    ASSERT_EQ(stats.num_all_blocks, stats.num_upstream_blocks);
+
+    umfMemoryProviderDestroy(coarse_memory_provider);
+    umfMemoryProviderDestroy(malloc_memory_provider);
+}
+
+TEST_P(CoarseWithMemoryStrategyTest, coarseProvider_shards_wrong_free) {
+    umf_result_t umf_result;
+
+    const size_t init_buffer_size = 20 * MB;
+
+    // preallocate some memory and initialize the vector with zeros
+    std::vector<char> buffer(init_buffer_size, 0);
+    void *buf = (void *)buffer.data();
+    ASSERT_NE(buf, nullptr);
+
+    coarse_memory_provider_params_t coarse_memory_provider_params;
+    // make sure there are no undefined members - prevent a UB
+    memset(&coarse_memory_provider_params, 0,
+           sizeof(coarse_memory_provider_params));
+    coarse_memory_provider_params.allocation_strategy = allocation_strategy;
+    coarse_memory_provider_params.upstream_memory_provider = nullptr;
+    coarse_memory_provider_params.immediate_init_from_upstream = false;
+    coarse_memory_provider_params.init_buffer = buf;
+    coarse_memory_provider_params.init_buffer_size = init_buffer_size;
+    coarse_memory_provider_params.num_shards = 4;
+
+    umf_memory_provider_handle_t coarse_memory_provider;
+    umf_result = umfMemoryProviderCreate(umfCoarseMemoryProviderOps(),
+                                         &coarse_memory_provider_params,
+                                         &coarse_memory_provider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(coarse_memory_provider, nullptr);
+
+    umf_memory_provider_handle_t cp = coarse_memory_provider;
+
+    const size_t block_size = 64 * KB;
+    void *ptr1 = nullptr;
+    void *ptr2 = nullptr;
+    umf_result = umfMemoryProviderAlloc(cp, block_size, 0, &ptr1);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderAlloc(cp, block_size, 0, &ptr2);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    // wrong size of the block
+    umf_result = umfMemoryProviderFree(cp, ptr1, block_size / 2);
+    ASSERT_EQ(umf_result, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+
+    // double free of a block cached in a shard
+    umf_result = umfMemoryProviderFree(cp, ptr1, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderFree(cp, ptr1, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+
+    // not a block of the provider
+    umf_result = umfMemoryProviderFree(cp, (char *)ptr2 + 1, block_size);
+    ASSERT_NE(umf_result, UMF_RESULT_SUCCESS);
+
+    // the cached block is handed out only once
+    void *ptr3 = nullptr;
+    void *ptr4 = nullptr;
+    umf_result = umfMemoryProviderAlloc(cp, block_size, 0, &ptr3);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(ptr3, ptr1);
+    umf_result = umfMemoryProviderAlloc(cp, block_size, 0, &ptr4);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(ptr4, ptr3);
+
+    umf_result = umfMemoryProviderFree(cp, ptr2, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderFree(cp, ptr3, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderFree(cp, ptr4, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(GetStats(cp).used_size, 0);
+    ASSERT_EQ(GetStats(cp).num_all_blocks, 1);
+
+    umfMemoryProviderDestroy(coarse_memory_provider);
+}
+
+// frees of many blocks from several threads are validated in the shards
+TEST_P(CoarseWithMemoryStrategyTest, coarseProvider_shards_many_frees) {
+    umf_result_t umf_result;
+
+    const size_t init_buffer_size = 20 * MB;
+
+    // preallocate some memory and initialize the vector with zeros
+    std::vector<char> buffer(init_buffer_size, 0);
+    void *buf = (void *)buffer.data();
+    ASSERT_NE(buf, nullptr);
+
+    coarse_memory_provider_params_t coarse_memory_provider_params;
+    // make sure there are no undefined members - prevent a UB
+    memset(&coarse_memory_provider_params, 0,
+           sizeof(coarse_memory_provider_params));
+    coarse_memory_provider_params.allocation_strategy = allocation_strategy;
+    coarse_memory_provider_params.upstream_memory_provider = nullptr;
+    coarse_memory_provider_params.immediate_init_from_upstream = false;
+    coarse_memory_provider_params.init_buffer = buf;
+    coarse_memory_provider_params.init_buffer_size = init_buffer_size;
+    coarse_memory_provider_params.num_shards = 4;
+
+    umf_memory_provider_handle_t coarse_memory_provider;
+    umf_result = umfMemoryProviderCreate(umfCoarseMemoryProviderOps(),
+                                         &coarse_memory_provider_params,
+                                         &coarse_memory_provider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(coarse_memory_provider, nullptr);
+
+    umf_memory_provider_handle_t cp = coarse_memory_provider;
+
+    const size_t nthreads = 4;
+    const size_t nblocks = 500;
+    const size_t block_size = 4 * KB;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nthreads; t++) {
+        threads.emplace_back([&] {
+            std::vector<void *> ptrs(nblocks);
+            for (int round = 0; round < 3; round++) {
+                for (auto &ptr : ptrs) {
+                    ASSERT_EQ(umfMemoryProviderAlloc(cp, block_size, 0, &ptr),
+                              UMF_RESULT_SUCCESS);
+                }
+                for (auto &ptr : ptrs) {
+                    ASSERT_EQ(umfMemoryProviderFree(cp, ptr, block_size),
+                              UMF_RESULT_SUCCESS);
+                    // a double free is caught
+                    ASSERT_EQ(umfMemoryProviderFree(cp, ptr, block_size),
+                              UMF_RESULT_ERROR_INVALID_ARGUMENT);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // a split block is freed in parts
+    void *ptr = nullptr;
+    umf_result = umfMemoryProviderAlloc(cp, 2 * block_size, 0, &ptr);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderAllocationSplit(cp, ptr, 2 * block_size,
+                                                  block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderFree(cp, ptr, 2 * block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+    umf_result = umfMemoryProviderFree(cp, (char *)ptr + block_size,
+                                       block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    umf_result = umfMemoryProviderFree(cp, ptr, block_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    ASSERT_EQ(GetStats(cp).used_size, 0);
+
+    umfMemoryProviderDestroy(coarse_memory_provider);
+}
@@ -6,8 +6,10 @@
 
 #include "cpp_helpers.hpp"
 #include "test_helpers.h"
+#include "utils_common.h"
 #ifndef _WIN32
 #include "test_helpers_linux.h"
+#include <sys/mman.h>
 #endif
 
 #include <umf/memory_provider.h>
@@ -351,6 +353,77 @@ TEST_F(test, create_empty_path) {
     EXPECT_EQ(hProvider, nullptr);
 }
 
+TEST_F(test, create_fixed_size_WRONG_SIZE) {
+    umf_memory_provider_handle_t hProvider = nullptr;
+    auto wrong_params = umfFileMemoryProviderParamsDefault(FILE_PATH);
+    wrong_params.size = utils_get_page_size() + 1;
+    auto ret = umfMemoryProviderCreate(umfFileMemoryProviderOps(),
+                                       &wrong_params, &hProvider);
+    EXPECT_EQ(ret, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(hProvider, nullptr);
+}
+
+// the whole-file mapping keeps the content of the file and its address
+// between the providers, so pointers stored inside of it stay valid
+TEST_F(test, fixed_size_content_preserved) {
+    const char *path = "tmp_file_fixed_size";
+    size_t size = 4 * utils_get_page_size();
+    umf_memory_provider_handle_t hProvider = nullptr;
+
+    (void)unlink(path);
+
+    // find a free range of the address space (in the middle of a larger
+    // one, so allocations made in the meantime do not take it)
+    size_t reserved = 64 * size;
+    void *reserved_addr =
+        utils_mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE, -1, 0);
+    ASSERT_NE(reserved_addr, nullptr);
+    utils_munmap(reserved_addr, reserved);
+    void *base_addr = (char *)reserved_addr + reserved / 2;
+
+    auto params = umfFileMemoryProviderParamsDefault(path);
+    params.visibility = UMF_MEM_MAP_SHARED;
+    params.size = size;
+    params.base_addr = base_addr;
+
+    auto ret = umfMemoryProviderCreate(umfFileMemoryProviderOps(), &params,
+                                       &hProvider);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_NE(hProvider, nullptr);
+
+    void **ptr = nullptr;
+    ret = umfMemoryProviderAlloc(hProvider, size / 2, 0, (void **)&ptr);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ((void *)ptr, base_addr);
+    ptr[0] = &ptr[1]; // a pointer into the mapping itself
+    ptr[1] = (void *)0xC0FFEE;
+
+    // the mapping cannot grow
+    void *ptr2 = nullptr;
+    ret = umfMemoryProviderAlloc(hProvider, size, 0, &ptr2);
+    ASSERT_EQ(ret, UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY);
+
+    // the range is already mapped
+    umf_memory_provider_handle_t hProvider2 = nullptr;
+    ret = umfMemoryProviderCreate(umfFileMemoryProviderOps(), &params,
+                                  &hProvider2);
+    ASSERT_EQ(ret, UMF_RESULT_ERROR_MEMORY_PROVIDER_SPECIFIC);
+
+    umfMemoryProviderDestroy(hProvider);
+
+    ret = umfMemoryProviderCreate(umfFileMemoryProviderOps(), &params,
+                                  &hProvider);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+
+    ret = umfMemoryProviderAlloc(hProvider, size / 2, 0, (void **)&ptr);
+    ASSERT_EQ(ret, UMF_RESULT_SUCCESS);
+    ASSERT_EQ((void *)ptr, base_addr);
+    ASSERT_EQ(*(void **)ptr[0], (void *)0xC0FFEE);
+
+    umfMemoryProviderDestroy(hProvider);
+    (void)unlink(path);
+}
+
 TEST_P(FileProviderParamsDefault, free_INVALID_POINTER_SIZE_GT_0) {
     umf_result_t umf_result =
         umfMemoryProviderFree(provider.get(), INVALID_PTR, page_plus_64);
@@ -9,9 +9,16 @@
 #include "test_helpers.h"
 
 #include <umf/memory_provider.h>
+#include <umf/memspace.h>
 #include <umf/pools/pool_disjoint.h>
+#include <umf/pools/pool_proxy.h>
 #include <umf/providers/provider_os_memory.h>
 
+#include <atomic>
+#include <climits>
+#include <thread>
+#include <vector>
+
 using umf_test::test;
 
 #define INVALID_PTR ((void *)0x01)
@@ -31,6 +38,8 @@ static const char *Native_error_str[] = {
     "lazy purging failed",             // UMF_OS_RESULT_ERROR_PURGE_LAZY_FAILED
     "force purging failed",            // UMF_OS_RESULT_ERROR_PURGE_FORCE_FAILED
     "HWLOC topology discovery failed", // UMF_OS_RESULT_ERROR_TOPO_DISCOVERY_FAILED
+    "pre-faulting pages failed",        // UMF_OS_RESULT_ERROR_POPULATE_FAILED
+    "moving pages to NUMA node failed", // UMF_OS_RESULT_ERROR_MIGRATE_FAILED
 };
 
 // test helpers
@@ -328,6 +337,166 @@ TEST_P(umfProviderTest, purge_force_INVALID_POINTER) {
                              UMF_OS_RESULT_ERROR_PURGE_FORCE_FAILED);
 }
 
+// OS index of the first NUMA node
+static unsigned first_numa_node() {
+    unsigned node = 0;
+    umf_const_memspace_handle_t hMemspace = umfMemspaceHostAllGet();
+    if (hMemspace && umfMemspaceMemtargetNum(hMemspace) > 0) {
+        umfMemtargetGetId(umfMemspaceMemtargetGet(hMemspace, 0), &node);
+    }
+    return node;
+}
+
+TEST_P(umfProviderTest, migrate) {
+    size_t size = 3 * page_size;
+    void *ptr = nullptr;
+    umf_result_t umf_result =
+        umfMemoryProviderAlloc(provider.get(), size, 0, &ptr);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(ptr, nullptr);
+
+    memset(ptr, 0xFF, size);
+
+    umf_result =
+        umfMemoryProviderMigrate(provider.get(), ptr, size, first_numa_node());
+    if (umf_result == UMF_RESULT_ERROR_NOT_SUPPORTED) {
+        umfMemoryProviderFree(provider.get(), ptr, size);
+        GTEST_SKIP() << "memory binding is not supported";
+    }
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    // the content is kept
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(((unsigned char *)ptr)[i], 0xFF);
+    }
+
+    umf_result = umfMemoryProviderFree(provider.get(), ptr, size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    // the memory allocated from now on
+    umf_result =
+        umfMemoryProviderMigrate(provider.get(), nullptr, 0, first_numa_node());
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    test_alloc_free_success(provider.get(), size, 0, PURGE_NONE);
+}
+
+TEST_P(umfProviderTest, migrate_WRONG_NODE) {
+    umf_result_t umf_result =
+        umfMemoryProviderMigrate(provider.get(), nullptr, 0, UINT_MAX);
+    ASSERT_EQ(umf_result, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+}
+
+TEST_P(umfProviderTest, migrate_WRONG_ALIGNMENT) {
+    void *ptr = nullptr;
+    umf_result_t umf_result =
+        umfMemoryProviderAlloc(provider.get(), page_size, 0, &ptr);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    umf_result = umfMemoryProviderMigrate(provider.get(), (char *)ptr + 64,
+                                          64, first_numa_node());
+    EXPECT_EQ(umf_result, UMF_RESULT_ERROR_INVALID_ALIGNMENT);
+
+    umf_result = umfMemoryProviderFree(provider.get(), ptr, page_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+}
+
+TEST_P(umfProviderTest, migrate_WRONG_SIZE) {
+    umf_result_t umf_result = umfMemoryProviderMigrate(
+        provider.get(), nullptr, page_size, first_numa_node());
+    ASSERT_EQ(umf_result, UMF_RESULT_ERROR_INVALID_ARGUMENT);
+}
+
+TEST_F(test, migratePool) {
+    umf_memory_provider_handle_t hProvider = nullptr;
+    umf_result_t umf_result = umfMemoryProviderCreate(
+        umfOsMemoryProviderOps(), &defaultParams, &hProvider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    umf_memory_pool_handle_t hPool = nullptr;
+    umf_result = umfPoolCreate(umfProxyPoolOps(), hProvider, nullptr,
+                               UMF_POOL_CREATE_FLAG_OWN_PROVIDER, &hPool);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    constexpr size_t NUM_ALLOCS = 16;
+    std::vector<void *> ptrs(NUM_ALLOCS);
+    for (size_t i = 0; i < NUM_ALLOCS; i++) {
+        ptrs[i] = umfPoolMalloc(hPool, (i + 1) * 4096);
+        ASSERT_NE(ptrs[i], nullptr);
+        memset(ptrs[i], (int)i, (i + 1) * 4096);
+    }
+
+    umf_result = umfPoolMigrate(hPool, first_numa_node());
+    if (umf_result != UMF_RESULT_ERROR_NOT_SUPPORTED) {
+        ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    }
+
+    for (size_t i = 0; i < NUM_ALLOCS; i++) {
+        ASSERT_EQ(((unsigned char *)ptrs[i])[(i + 1) * 4096 - 1], i);
+        ASSERT_EQ(umfPoolFree(hPool, ptrs[i]), UMF_RESULT_SUCCESS);
+    }
+
+    umfPoolDestroy(hPool);
+}
+
+TEST_F(test, migratePool_concurrentFree) {
+    umf_memory_provider_handle_t hProvider = nullptr;
+    umf_result_t umf_result = umfMemoryProviderCreate(
+        umfOsMemoryProviderOps(), &defaultParams, &hProvider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    // every allocation of the proxy pool is mapped and unmapped
+    // by the OS provider
+    umf_memory_pool_handle_t hPool = nullptr;
+    umf_result = umfPoolCreate(umfProxyPoolOps(), hProvider, nullptr,
+                               UMF_POOL_CREATE_FLAG_OWN_PROVIDER, &hPool);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    std::atomic<bool> done{false};
+    std::thread worker([&] {
+        while (!done.load()) {
+            void *ptr = umfPoolMalloc(hPool, 16 * 4096);
+            if (ptr) {
+                memset(ptr, 1, 16 * 4096);
+                umfPoolFree(hPool, ptr);
+            }
+        }
+    });
+
+    // the ranges freed during the migration are skipped
+    for (int i = 0; i < 100; i++) {
+        umf_result = umfPoolMigrate(hPool, first_numa_node());
+        if (umf_result == UMF_RESULT_ERROR_NOT_SUPPORTED) {
+            break;
+        }
+        EXPECT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    }
+
+    done.store(true);
+    worker.join();
+
+    umfPoolDestroy(hPool);
+}
+
+TEST_F(test, migratePool_DISABLE_TRACKING) {
+    umf_memory_provider_handle_t hProvider = nullptr;
+    umf_result_t umf_result = umfMemoryProviderCreate(
+        umfOsMemoryProviderOps(), &defaultParams, &hProvider);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    umf_memory_pool_handle_t hPool = nullptr;
+    umf_result = umfPoolCreate(umfProxyPoolOps(), hProvider, nullptr,
+                               UMF_POOL_CREATE_FLAG_OWN_PROVIDER |
+                                   UMF_POOL_CREATE_FLAG_DISABLE_TRACKING,
+                               &hPool);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    umf_result = umfPoolMigrate(hPool, first_numa_node());
+    EXPECT_EQ(umf_result, UMF_RESULT_ERROR_NOT_SUPPORTED);
+
+    umfPoolDestroy(hPool);
+}
+
 TEST_P(umfProviderTest, get_ipc_handle_size_wrong_visibility) {
     size_t size;
     umf_result_t umf_result =
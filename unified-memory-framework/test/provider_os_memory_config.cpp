@@ -14,6 +14,8 @@
 
 #include <numa.h>
 #include <numaif.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 static constexpr size_t allocSize = 4096;
 
@@ -199,3 +201,103 @@ TEST_P(providerConfigTestNumaMode, numa_modes) {
     }
     free(params.numa_list);
 }
+
+TEST_F(providerConfigTest, populate) {
+    params.populate = true;
+
+    create_provider(&params);
+    allocate_memory();
+
+    // all pages have to be resident right after the allocation
+    unsigned char vec = 0;
+    int ret = mincore(ptr, allocSize, &vec);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(vec & 1, 1);
+}
+
+TEST_F(providerConfigTest, reserve_size) {
+    const size_t page_size = sysconf(_SC_PAGE_SIZE);
+    params.populate = true;
+    params.reserve_size = 4 * page_size;
+
+    create_provider(&params);
+
+    // allocations are carved out of the reservation one after another
+    void *ptr1 = nullptr, *ptr2 = nullptr;
+    auto res = umfMemoryProviderAlloc(provider, page_size, 0, &ptr1);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    res = umfMemoryProviderAlloc(provider, page_size, 0, &ptr2);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    ASSERT_EQ((char *)ptr1 + page_size, (char *)ptr2);
+
+    // the most recent range is given back to the reservation
+    res = umfMemoryProviderFree(provider, ptr2, page_size);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    res = umfMemoryProviderAlloc(provider, page_size, 0, &ptr2);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    ASSERT_EQ((char *)ptr1 + page_size, (char *)ptr2);
+
+    // an allocation exceeding the reservation is mapped separately
+    void *ptr3 = nullptr;
+    res = umfMemoryProviderAlloc(provider, 4 * page_size, 0, &ptr3);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    ASSERT_NE(ptr3, nullptr);
+
+    EXPECT_EQ(umfMemoryProviderFree(provider, ptr3, 4 * page_size),
+              UMF_RESULT_SUCCESS);
+    EXPECT_EQ(umfMemoryProviderFree(provider, ptr2, page_size),
+              UMF_RESULT_SUCCESS);
+    EXPECT_EQ(umfMemoryProviderFree(provider, ptr1, page_size),
+              UMF_RESULT_SUCCESS);
+}
+
+TEST_F(providerConfigTest, reserve_size_reuse_holes) {
+    const size_t page_size = sysconf(_SC_PAGE_SIZE);
+    params.reserve_size = 4 * page_size;
+
+    create_provider(&params);
+
+    void *ptr[4] = {};
+    for (int i = 0; i < 4; i++) {
+        auto res = umfMemoryProviderAlloc(provider, page_size, 0, &ptr[i]);
+        ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    }
+
+    // freed ranges below the top stay mapped and are reused,
+    // adjacent ones are coalesced
+    memset(ptr[1], 0xAB, page_size);
+    auto res = umfMemoryProviderFree(provider, ptr[1], page_size);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    res = umfMemoryProviderFree(provider, ptr[2], page_size);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+
+    void *hole = nullptr;
+    res = umfMemoryProviderAlloc(provider, 2 * page_size, 0, &hole);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(hole, ptr[1]);
+    memset(hole, 0, 2 * page_size);
+
+    // freeing everything rewinds the reservation to its beginning
+    for (void *p : {ptr[3], hole, ptr[0]}) {
+        res = umfMemoryProviderFree(provider, p,
+                                    p == hole ? 2 * page_size : page_size);
+        ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    }
+
+    void *all = nullptr;
+    res = umfMemoryProviderAlloc(provider, 4 * page_size, 0, &all);
+    ASSERT_EQ(res, UMF_RESULT_SUCCESS);
+    ASSERT_EQ(all, ptr[0]);
+    EXPECT_EQ(umfMemoryProviderFree(provider, all, 4 * page_size),
+              UMF_RESULT_SUCCESS);
+}
+
+TEST_F(providerConfigTest, reserve_size_shared_not_supported) {
+    params.visibility = UMF_MEM_MAP_SHARED;
+    params.reserve_size = 4096;
+
+    auto res =
+        umfMemoryProviderCreate(umfOsMemoryProviderOps(), &params, &provider);
+    ASSERT_EQ(res, UMF_RESULT_ERROR_NOT_SUPPORTED);
+    ASSERT_EQ(provider, nullptr);
+}
@@ -177,6 +177,57 @@ TEST_P(testNumaOnEachNode, checkNumaNodesAllocations) {
     EXPECT_NODE_EQ(ptr, numa_node_number);
 }
 
+// Test for moving allocated memory to another node. It will be executed
+// on each of the available numa nodes (as the destination).
+TEST_P(testNumaOnEachNode, checkMigrate) {
+    unsigned numa_node_number = GetParam();
+    std::vector<unsigned> numa_nodes = get_available_numa_nodes();
+    unsigned source_node = numa_nodes[0] != numa_node_number ? numa_nodes[0]
+                                                             : numa_nodes[1];
+
+    umf_os_memory_provider_params_t os_memory_provider_params =
+        UMF_OS_MEMORY_PROVIDER_PARAMS_TEST;
+
+    os_memory_provider_params.numa_list = &source_node;
+    os_memory_provider_params.numa_list_len = 1;
+    os_memory_provider_params.numa_mode = UMF_NUMA_MODE_BIND;
+    initOsProvider(os_memory_provider_params);
+
+    size_t page_size = sysconf(_SC_PAGE_SIZE);
+    alloc_size = 4 * page_size;
+    umf_result_t umf_result =
+        umfMemoryProviderAlloc(os_memory_provider, alloc_size, 0, &ptr);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(ptr, nullptr);
+
+    memset(ptr, 0xFF, alloc_size);
+    EXPECT_NODE_EQ(ptr, source_node);
+
+    umf_result = umfMemoryProviderMigrate(os_memory_provider, ptr, alloc_size,
+                                          numa_node_number);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    for (size_t i = 0; i < alloc_size; i += page_size) {
+        EXPECT_NODE_EQ((char *)ptr + i, numa_node_number);
+    }
+
+    // the memory allocated from now on is placed on the new node too
+    umf_result = umfMemoryProviderMigrate(os_memory_provider, nullptr, 0,
+                                          numa_node_number);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+
+    void *ptr2 = nullptr;
+    umf_result =
+        umfMemoryProviderAlloc(os_memory_provider, alloc_size, 0, &ptr2);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(ptr2, nullptr);
+
+    memset(ptr2, 0xFF, alloc_size);
+    EXPECT_NODE_EQ(ptr2, numa_node_number);
+
+    umf_result = umfMemoryProviderFree(os_memory_provider, ptr2, alloc_size);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+}
+
 // Test for allocations on numa nodes with mode preferred. It will be executed
 // on each of the available numa nodes.
 TEST_P(testNumaOnEachNode, checkModePreferred) {
@@ -485,6 +536,45 @@ TEST_F(testNuma, checkModeInterleaveCustomPartSize) {
     umfMemoryProviderFree(os_memory_provider, ptr, size);
 }
 
+// Test for allocations on numa nodes with weighted interleave mode enabled.
+// Pages are interleaved 3:1 between the first two nodes.
+TEST_F(testNuma, checkModeInterleaveWeighted) {
+    constexpr int round_num = 256;
+    long _page_size = sysconf(_SC_PAGE_SIZE);
+    ASSERT_GT(_page_size, 0);
+    size_t page_size = _page_size;
+    umf_os_memory_provider_params_t os_memory_provider_params =
+        UMF_OS_MEMORY_PROVIDER_PARAMS_TEST;
+
+    std::vector<unsigned> numa_nodes = get_available_numa_nodes();
+    if (numa_nodes.size() < 2) {
+        GTEST_SKIP_("Not enough numa nodes");
+    }
+
+    std::vector<umf_numa_split_partition_t> weights = {{3, numa_nodes[0]},
+                                                       {1, numa_nodes[1]}};
+    os_memory_provider_params.numa_list = numa_nodes.data();
+    os_memory_provider_params.numa_list_len = 2;
+    os_memory_provider_params.numa_mode = UMF_NUMA_MODE_INTERLEAVE;
+    os_memory_provider_params.partitions = weights.data();
+    os_memory_provider_params.partitions_len = weights.size();
+    initOsProvider(os_memory_provider_params);
+
+    size_t size = round_num * 4 * page_size;
+    umf_result_t umf_result;
+    umf_result = umfMemoryProviderAlloc(os_memory_provider, size, 0, &ptr);
+    ASSERT_EQ(umf_result, UMF_RESULT_SUCCESS);
+    ASSERT_NE(ptr, nullptr);
+
+    // 'ptr' must point to an initialized value before retrieving its numa node
+    memset(ptr, 0xFF, size);
+    for (size_t i = 0; i < size / page_size; i++) {
+        unsigned expected = (i % 4 < 3) ? numa_nodes[0] : numa_nodes[1];
+        ASSERT_NODE_EQ((char *)ptr + i * page_size, expected);
+    }
+    umfMemoryProviderFree(os_memory_provider, ptr, size);
+}
+
 using numaSplitOut = std::vector<std::vector<unsigned>>;
 
 // Input for Numa split test - in the following format
@@ -84,3 +84,27 @@ TEST_F(test, proxyLib_aligned_alloc) {
     ::free(ptr);
 #endif
 }
+
+TEST_F(test, proxyLib_numa_local) {
+    if (!utils_env_var_has_str("UMF_PROXY", "numa=local")) {
+        GTEST_SKIP() << "Test skipped, UMF_PROXY does not contain numa=local";
+    }
+
+    size_t size = 4 * utils_get_page_size();
+    int node_before = utils_get_current_numa_node();
+    void *ptr = ::malloc(size);
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, 0xAB, size);
+    int node_after = utils_get_current_numa_node();
+
+    // the memory comes from the pool of the node the thread runs on
+    // (unless the thread has been migrated in the meantime)
+    if (node_before >= 0 && node_before == node_after) {
+        ASSERT_EQ(utils_get_numa_node_of_addr((char *)ptr + size / 2),
+                  node_before);
+    }
+
+    ptr = ::realloc(ptr, 2 * size);
+    ASSERT_NE(ptr, nullptr);
+    ::free(ptr);
+}
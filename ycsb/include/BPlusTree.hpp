@@ -0,0 +1,268 @@
+#pragma once
+#ifndef _BPLUS_TREE_HPP_
+#define _BPLUS_TREE_HPP_
+
+#include "node_region.hpp"
+#include "ycsb_key.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+// Ordered index (--engine btree) with the operations of HashTable plus
+// scan(): the keys and counts are kept sorted in leaves chained left to
+// right, so a scan reads consecutive slots of a leaf and then follows the
+// chain (prefetching the next leaf) instead of doing a lookup per key.
+//
+// The inner nodes and the leaves of a tree are carved from chunks allocated
+// on the node of the tree (node < 0: the regular heap, or the snapshot arena
+// while it is being built). Keys are never removed by the benchmark, so
+// nodes are only split, never merged, and live until the tree is destroyed.
+
+template <typename Key>
+class BPlusTree {
+    static constexpr int LEAF_SLOTS = 32;
+    static constexpr int INNER_KEYS = 32;
+    // chunks double from MIN_CHUNK up to MAX_CHUNK bytes
+    static constexpr size_t MIN_CHUNK = 16 << 10;
+    static constexpr size_t MAX_CHUNK = 1 << 20;
+
+    struct Slot {
+        Key key;
+        int count;
+    };
+
+    struct Leaf {
+        int n;
+        Leaf* next;
+        Slot slots[LEAF_SLOTS];
+    };
+
+    // keys[i] is the smallest key of child[i + 1]
+    struct Inner {
+        int n;
+        Key keys[INNER_KEYS];
+        void* child[INNER_KEYS + 1];
+    };
+
+    // chunk the nodes are carved from
+    struct Chunk {
+        Chunk* prev;
+        size_t size;
+        size_t used;
+    };
+
+    void* root;
+    int height = 0;  // inner levels above the leaves
+    int node;
+    Chunk* chunk = nullptr;
+
+    template <typename T>
+    T* new_node() {
+        size_t size = (sizeof(T) + 63) & ~size_t(63);
+        if (chunk == nullptr || chunk->used + size > chunk->size) {
+            size_t chunk_size = chunk ? std::min(chunk->size * 2, MAX_CHUNK) : MIN_CHUNK;
+            Chunk* c = static_cast<Chunk*>(node_region_alloc(node, chunk_size, 64));
+            c->prev = chunk;
+            c->size = chunk_size;
+            c->used = 64;
+            chunk = c;
+        }
+        void* p = reinterpret_cast<char*>(chunk) + chunk->used;
+        chunk->used += size;
+        return new (p) T();
+    }
+
+    // index of the child of <in> which holds <value>
+    template <typename Value>
+    static int child_index(const Inner* in, Value value) {
+        int lo = 0, hi = in->n;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (in->keys[mid].compare(value) <= 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // first slot of <leaf> whose key is not less than <value>
+    template <typename Value>
+    static int lower_bound(const Leaf* leaf, Value value) {
+        int lo = 0, hi = leaf->n;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (leaf->slots[mid].key.compare(value) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    template <typename Value>
+    Leaf* find_leaf(Value value) const {
+        void* n = root;
+        for (int level = height; level > 0; level--) {
+            const Inner* in = static_cast<const Inner*>(n);
+            n = in->child[child_index(in, value)];
+        }
+        return static_cast<Leaf*>(n);
+    }
+
+    template <typename Value>
+    Slot* find(Value value) const {
+        Leaf* leaf = find_leaf(value);
+        int i = lower_bound(leaf, value);
+        return (i < leaf->n && leaf->slots[i].key.equals(value)) ? &leaf->slots[i] : nullptr;
+    }
+
+    static bool full(void* n, bool leaf) {
+        return leaf ? static_cast<Leaf*>(n)->n == LEAF_SLOTS : static_cast<Inner*>(n)->n == INNER_KEYS;
+    }
+
+    // Splits the full child i of <parent> (a leaf if <leaf>) in two halves.
+    void split_child(Inner* parent, int i, bool leaf) {
+        Key separator;
+        void* right_node;
+        if (leaf) {
+            Leaf* left = static_cast<Leaf*>(parent->child[i]);
+            Leaf* right = new_node<Leaf>();
+            int half = LEAF_SLOTS / 2;
+            for (int j = half; j < LEAF_SLOTS; j++) {
+                right->slots[j - half] = left->slots[j];
+            }
+            right->n = LEAF_SLOTS - half;
+            left->n = half;
+            right->next = left->next;
+            left->next = right;
+            separator = right->slots[0].key;
+            right_node = right;
+        } else {
+            Inner* left = static_cast<Inner*>(parent->child[i]);
+            Inner* right = new_node<Inner>();
+            int mid = INNER_KEYS / 2;
+            separator = left->keys[mid];
+            for (int j = mid + 1; j < INNER_KEYS; j++) {
+                right->keys[j - mid - 1] = left->keys[j];
+            }
+            for (int j = mid + 1; j <= INNER_KEYS; j++) {
+                right->child[j - mid - 1] = left->child[j];
+            }
+            right->n = INNER_KEYS - mid - 1;
+            left->n = mid;
+            right_node = right;
+        }
+        for (int j = parent->n; j > i; j--) {
+            parent->keys[j] = parent->keys[j - 1];
+            parent->child[j + 1] = parent->child[j];
+        }
+        parent->keys[i] = separator;
+        parent->child[i + 1] = right_node;
+        parent->n++;
+    }
+
+    // Slot of the key, inserted with count 0 if missing (inserted == true).
+    // Full nodes are split on the way down, so a split never propagates up.
+    template <typename Value>
+    Slot& find_or_insert(Value value, unsigned long key_hash, bool& inserted) {
+        if (full(root, height == 0)) {
+            Inner* new_root = new_node<Inner>();
+            new_root->child[0] = root;
+            split_child(new_root, 0, height == 0);
+            root = new_root;
+            height++;
+        }
+        void* n = root;
+        for (int level = height; level > 0; level--) {
+            Inner* in = static_cast<Inner*>(n);
+            int i = child_index(in, value);
+            if (full(in->child[i], level == 1)) {
+                split_child(in, i, level == 1);
+                if (in->keys[i].compare(value) <= 0) {
+                    i++;
+                }
+            }
+            n = in->child[i];
+        }
+        Leaf* leaf = static_cast<Leaf*>(n);
+        int i = lower_bound(leaf, value);
+        if (i < leaf->n && leaf->slots[i].key.equals(value)) {
+            inserted = false;
+            return leaf->slots[i];
+        }
+        for (int j = leaf->n; j > i; j--) {
+            leaf->slots[j] = leaf->slots[j - 1];
+        }
+        leaf->slots[i].key.assign(value, key_hash);
+        leaf->slots[i].count = 0;
+        leaf->n++;
+        inserted = true;
+        return leaf->slots[i];
+    }
+
+public:
+    using value_type = decltype(std::declval<Key>().value());
+
+    // the tables are picked by key range, see table_of() of the benchmark
+    static constexpr bool ordered = true;
+
+    // <buckets> is not used, the tree grows with the keys
+    BPlusTree(int buckets, int node = -1) : node(node) {
+        (void)buckets;
+        root = new_node<Leaf>();
+    }
+
+    ~BPlusTree() {
+        while (chunk) {
+            Chunk* prev = chunk->prev;
+            node_region_free(node, chunk, chunk->size);
+            chunk = prev;
+        }
+    }
+
+    bool insert(value_type key, unsigned long key_hash) {
+        bool inserted;
+        find_or_insert(key, key_hash, inserted).count++;
+        return inserted;
+    }
+
+    int getCount(value_type key, unsigned long key_hash) {
+        (void)key_hash;
+        Slot* slot = find(key);
+        return slot ? slot->count : 0;
+    }
+
+    // Updated in place, like SwissTable::updateCount().
+    bool updateCount(value_type key, int count, unsigned long key_hash) {
+        bool inserted;
+        find_or_insert(key, key_hash, inserted).count += count;
+        return true;
+    }
+
+    // Reads the counts of (up to) <n> keys in key order, starting with the
+    // first key not less than <key>. Returns the sum of the counts.
+    int scan(value_type key, int n) {
+        Leaf* leaf = find_leaf(key);
+        int i = lower_bound(leaf, key);
+        int sum = 0;
+        while (leaf && n > 0) {
+            if (leaf->next) {
+                __builtin_prefetch(leaf->next);
+            }
+            for (; i < leaf->n && n > 0; i++, n--) {
+                sum += leaf->slots[i].count;
+            }
+            leaf = leaf->next;
+            i = 0;
+        }
+        return sum;
+    }
+
+    static void* operator new(size_t size) { return SnapshotArena::alloc(size); }
+    static void operator delete(void* p) { SnapshotArena::free(p); }
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <iostream>
 #include "numatype.hpp"
 #include <cstring>
+#include "snapshot_arena.hpp"
 
 class HashNode {
 public:
@@ -11,14 +12,18 @@ public:
     HashNode(const char* word);
 
     ~HashNode();
+
+    // nodes (and keys) of snapshotted tables live in the snapshot arena
+    static void* operator new(size_t size) { return SnapshotArena::alloc(size); }
+    static void operator delete(void* p) { SnapshotArena::free(p); }
 };
 
 HashNode::HashNode(const char* word) {
         count = 1;
         next =nullptr;
-        key = new char[strlen(word) + 1];
+        key = static_cast<char*>(SnapshotArena::alloc(strlen(word) + 1));
         strcpy(key, word);
     }
 HashNode::~HashNode() {
-        delete[] key;
+        SnapshotArena::free(key);
     }
@@ -1,6 +1,7 @@
 #include "HashNode.hpp"
 #include "numatype.hpp"
 #include <iostream>
+#include <atomic>
 #include <cstring>
 #include <vector>
 
@@ -10,25 +11,71 @@ class HashTable{
     HashNode** table;
     int bucket_count;
 
+    // New nodes are linked in with a release store, so a reader walking the
+    // chain without the lock (TableLock optimistic mode) sees them complete.
+    void publish(int idx, HashNode* newNode) {
+        newNode->next = table[idx];
+        std::atomic_ref<HashNode*>(table[idx]).store(newNode, std::memory_order_release);
+    }
+    HashNode* head(int idx) {
+        return std::atomic_ref<HashNode*>(table[idx]).load(std::memory_order_acquire);
+    }
+    // the same for the links replaced by updateCount() (TableLock rcu mode)
+    static void set_next(HashNode*& link, HashNode* node) {
+        std::atomic_ref<HashNode*>(link).store(node, std::memory_order_release);
+    }
+    static HashNode* next(HashNode* node) {
+        return std::atomic_ref<HashNode*>(node->next).load(std::memory_order_acquire);
+    }
+    // Counts changed in place (insert(), updateCountInPlace()) are read by
+    // getCount() without the lock in optimistic mode. The writers hold the
+    // lock, so a relaxed load and store is enough; keys never change once
+    // the node is published.
+    static int load_count(HashNode* node) {
+        return std::atomic_ref<int>(node->count).load(std::memory_order_relaxed);
+    }
+    static void add_count(HashNode* node, int count) {
+        std::atomic_ref<int> c(node->count);
+        c.store(c.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
    
 public:
     HashTable(int buckets);
     ~HashTable();
     int hash(const char* key);
+    // djb2 of the key - hash() is hash_key() % bucket_count
+    static unsigned long hash_key(const char* key);
     bool insert(const char* key);
     bool insert(const char* key, int count);
     void remove(const char* key);
     int getCount(const char* key);
     bool updateCount(const char* key, int count);
+    // the same operations with hash_key(key) computed by the caller
+    bool insert(const char* key, unsigned long key_hash);
+    // insert() for lock-free readers: the count of an existing key is not
+    // incremented in place, the node is replaced like in updateCount()
+    template <typename Retire>
+    bool insert(const char* key, unsigned long key_hash, Retire&& retire);
+    int getCount(const char* key, unsigned long key_hash);
+    bool updateCount(const char* key, int count, unsigned long key_hash);
+    // updateCount() for lock-free readers: the old node is passed to
+    // retire() (e.g. Epoch::retire) instead of being deleted right away
+    template <typename Retire>
+    bool updateCount(const char* key, int count, unsigned long key_hash, Retire&& retire);
+    // updateCount() without replacing the node (safe for lock-free readers)
+    bool updateCountInPlace(const char* key, int count, unsigned long key_hash);
     bool exists(const char* key);
     void printAll();
     std::vector<char*> getAllKeys();
+
+    static void* operator new(size_t size) { return SnapshotArena::alloc(size); }
+    static void operator delete(void* p) { SnapshotArena::free(p); }
 };
 
 
 HashTable::HashTable(int buckets) {
     bucket_count = buckets;
-    table = new HashNode*[bucket_count];
+    table = static_cast<HashNode**>(SnapshotArena::alloc(sizeof(HashNode*) * bucket_count));
     for(int i = 0; i < bucket_count; i++) {
         table[i] = nullptr;
     }
@@ -43,31 +90,58 @@ HashTable::~HashTable() {
             delete toDelete;
         }
     }
-    delete[] table;
+    SnapshotArena::free(table);
 }
 
-int HashTable::hash(const char* key) {
+unsigned long HashTable::hash_key(const char* key) {
     unsigned long hash = 5381;
     int c;
     while ((c = *key++)) {
         hash = ((hash << 5) + hash) + c; // hash * 33 + c
     }
-    return hash % bucket_count;
+    return hash;
+}
+
+int HashTable::hash(const char* key) {
+    return hash_key(key) % bucket_count;
 }
 
 bool HashTable::insert(const char* word){
-    int idx = hash(word);
+    return insert(word, hash_key(word));
+}
+
+bool HashTable::insert(const char* word, unsigned long key_hash){
+    int idx = key_hash % bucket_count;
     HashNode* curr = table[idx];
     while(curr){
         if(strcmp(curr->key, word)==0){
-            curr->count++;
+            add_count(curr, 1);
             return false;
         }
         curr = curr->next;
     }
-    HashNode* newNode = new HashNode(word);
-    newNode->next = table[idx];
-    table[idx] = newNode;
+    publish(idx, new HashNode(word));
+    return true;
+}
+
+template <typename Retire>
+bool HashTable::insert(const char* word, unsigned long key_hash, Retire&& retire){
+    int idx = key_hash % bucket_count;
+    HashNode* curr = table[idx];
+    HashNode* prev = nullptr;
+    while(curr){
+        if(strcmp(curr->key, word)==0){
+            HashNode* newNode = new HashNode(word);
+            newNode->count = curr->count + 1;
+            newNode->next = curr->next;
+            set_next(prev ? prev->next : table[idx], newNode);
+            retire(curr);
+            return false;
+        }
+        prev = curr;
+        curr = curr->next;
+    }
+    publish(idx, new HashNode(word));
     return true;
 }
 
@@ -76,7 +150,7 @@ bool HashTable::insert(const char* word, int count){
     HashNode* curr = table[idx];
     while(curr){
         if(strcmp(curr->key, word)==0){
-            curr->count += count;
+            add_count(curr, count);
             return false;
         }
         curr = curr->next;
@@ -108,19 +182,32 @@ void HashTable::remove(const char* word){
 }
 
 int HashTable::getCount(const char* word){
-    int idx = hash(word);
-    HashNode* curr = table[idx];
+    return getCount(word, hash_key(word));
+}
+
+int HashTable::getCount(const char* word, unsigned long key_hash){
+    int idx = key_hash % bucket_count;
+    HashNode* curr = head(idx);
     while(curr){
         if(strcmp(curr->key, word)==0){
-            return curr->count;
+            return load_count(curr);
         }
-        curr = curr->next;
+        curr = next(curr);
     }
     return 0;
 }
 
 bool HashTable::updateCount(const char* word, int count){
-    int idx = hash(word);
+    return updateCount(word, count, hash_key(word));
+}
+
+bool HashTable::updateCount(const char* word, int count, unsigned long key_hash){
+    return updateCount(word, count, key_hash, [](HashNode* old) { delete old; });
+}
+
+template <typename Retire>
+bool HashTable::updateCount(const char* word, int count, unsigned long key_hash, Retire&& retire){
+    int idx = key_hash % bucket_count;
     HashNode* curr = table[idx];
     HashNode* prev = nullptr;
 
@@ -132,13 +219,9 @@ bool HashTable::updateCount(const char* word, int count){
             newNode->count = curr->count + count;
             newNode->next = curr->next;
             
-            if (prev) {
-                prev->next = newNode;
-            } else {
-                table[idx] = newNode;
-            }
+            set_next(prev ? prev->next : table[idx], newNode);
             
-            delete curr; // Free the old node memory
+            retire(curr); // Free the old node memory
             return true;
         }
         prev = curr;
@@ -148,8 +231,21 @@ bool HashTable::updateCount(const char* word, int count){
     // If it isn't found, insert it anyway to guarantee a heap allocation/write
     HashNode* newNode = new HashNode(word);
     newNode->count = count;
-    newNode->next = table[idx];
-    table[idx] = newNode;
+    publish(idx, newNode);
+    return true;
+}
+
+bool HashTable::updateCountInPlace(const char* word, int count, unsigned long key_hash){
+    int idx = key_hash % bucket_count;
+    for (HashNode* curr = table[idx]; curr; curr = curr->next) {
+        if (strcmp(curr->key, word) == 0) {
+            add_count(curr, count);
+            return true;
+        }
+    }
+    HashNode* newNode = new HashNode(word);
+    newNode->count = count;
+    publish(idx, newNode);
     return true;
 }
 
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef _INT_HASH_TABLE_HPP_
+#define _INT_HASH_TABLE_HPP_
+
+#include "numatype.hpp"
+#include "snapshot_arena.hpp"
+#include "ycsb_key.hpp"
+#include <atomic>
+#include <cstdint>
+
+// HashTable for integer keys (--key_type int): the key is stored in the
+// node, so there is no separate key allocation and no strcmp() on lookup.
+// The operations behave the same as the ones of HashTable.
+
+class IntHashNode {
+public:
+    uint64_t key;
+    int count;
+    IntHashNode* next;
+
+    IntHashNode(uint64_t key) : key(key), count(1), next(nullptr) {}
+
+    static void* operator new(size_t size) { return SnapshotArena::alloc(size); }
+    static void operator delete(void* p) { SnapshotArena::free(p); }
+};
+
+class IntHashTable {
+    IntHashNode** table;
+    int bucket_count;
+
+    // see HashTable::publish()
+    void publish(int idx, IntHashNode* newNode) {
+        newNode->next = table[idx];
+        std::atomic_ref<IntHashNode*>(table[idx]).store(newNode, std::memory_order_release);
+    }
+    IntHashNode* head(int idx) {
+        return std::atomic_ref<IntHashNode*>(table[idx]).load(std::memory_order_acquire);
+    }
+    static void set_next(IntHashNode*& link, IntHashNode* node) {
+        std::atomic_ref<IntHashNode*>(link).store(node, std::memory_order_release);
+    }
+    static IntHashNode* next(IntHashNode* node) {
+        return std::atomic_ref<IntHashNode*>(node->next).load(std::memory_order_acquire);
+    }
+    // see HashTable::load_count()
+    static int load_count(IntHashNode* node) {
+        return std::atomic_ref<int>(node->count).load(std::memory_order_relaxed);
+    }
+    static void add_count(IntHashNode* node, int count) {
+        std::atomic_ref<int> c(node->count);
+        c.store(c.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+public:
+    IntHashTable(int buckets) : bucket_count(buckets) {
+        table = static_cast<IntHashNode**>(SnapshotArena::alloc(sizeof(IntHashNode*) * bucket_count));
+        for (int i = 0; i < bucket_count; i++) {
+            table[i] = nullptr;
+        }
+    }
+
+    ~IntHashTable() {
+        for (int i = 0; i < bucket_count; i++) {
+            IntHashNode* curr = table[i];
+            while (curr) {
+                IntHashNode* toDelete = curr;
+                curr = curr->next;
+                delete toDelete;
+            }
+        }
+        SnapshotArena::free(table);
+    }
+
+    static unsigned long hash_key(uint64_t key) { return IntKey::mix(key); }
+
+    bool insert(uint64_t key) { return insert(key, hash_key(key)); }
+    int getCount(uint64_t key) { return getCount(key, hash_key(key)); }
+    bool updateCount(uint64_t key, int count) { return updateCount(key, count, hash_key(key)); }
+
+    bool insert(uint64_t key, unsigned long key_hash) {
+        int idx = key_hash % bucket_count;
+        for (IntHashNode* curr = table[idx]; curr; curr = curr->next) {
+            if (curr->key == key) {
+                add_count(curr, 1);
+                return false;
+            }
+        }
+        publish(idx, new IntHashNode(key));
+        return true;
+    }
+
+    // Like HashTable::insert() with retire(): an existing key gets a new node.
+    template <typename Retire>
+    bool insert(uint64_t key, unsigned long key_hash, Retire&& retire) {
+        int idx = key_hash % bucket_count;
+        IntHashNode* curr = table[idx];
+        IntHashNode* prev = nullptr;
+        while (curr) {
+            if (curr->key == key) {
+                IntHashNode* newNode = new IntHashNode(key);
+                newNode->count = curr->count + 1;
+                newNode->next = curr->next;
+                set_next(prev ? prev->next : table[idx], newNode);
+                retire(curr);
+                return false;
+            }
+            prev = curr;
+            curr = curr->next;
+        }
+        publish(idx, new IntHashNode(key));
+        return true;
+    }
+
+    int getCount(uint64_t key, unsigned long key_hash) {
+        int idx = key_hash % bucket_count;
+        for (IntHashNode* curr = head(idx); curr; curr = next(curr)) {
+            if (curr->key == key) {
+                return load_count(curr);
+            }
+        }
+        return 0;
+    }
+
+    // Like HashTable::updateCount(), replaces the node with a new one.
+    bool updateCount(uint64_t key, int count, unsigned long key_hash) {
+        return updateCount(key, count, key_hash, [](IntHashNode* old) { delete old; });
+    }
+
+    template <typename Retire>
+    bool updateCount(uint64_t key, int count, unsigned long key_hash, Retire&& retire) {
+        int idx = key_hash % bucket_count;
+        IntHashNode* curr = table[idx];
+        IntHashNode* prev = nullptr;
+        while (curr) {
+            if (curr->key == key) {
+                IntHashNode* newNode = new IntHashNode(key);
+                newNode->count = curr->count + count;
+                newNode->next = curr->next;
+                set_next(prev ? prev->next : table[idx], newNode);
+                retire(curr);
+                return true;
+            }
+            prev = curr;
+            curr = curr->next;
+        }
+        IntHashNode* newNode = new IntHashNode(key);
+        newNode->count = count;
+        publish(idx, newNode);
+        return true;
+    }
+
+    bool updateCountInPlace(uint64_t key, int count, unsigned long key_hash) {
+        int idx = key_hash % bucket_count;
+        for (IntHashNode* curr = table[idx]; curr; curr = curr->next) {
+            if (curr->key == key) {
+                add_count(curr, count);
+                return true;
+            }
+        }
+        IntHashNode* newNode = new IntHashNode(key);
+        newNode->count = count;
+        publish(idx, newNode);
+        return true;
+    }
+
+    static void* operator new(size_t size) { return SnapshotArena::alloc(size); }
+    static void operator delete(void* p) { SnapshotArena::free(p); }
+};
+
+#endif
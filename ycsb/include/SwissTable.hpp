@@ -0,0 +1,180 @@
+#pragma once
+#ifndef _SWISS_TABLE_HPP_
+#define _SWISS_TABLE_HPP_
+
+#include "node_region.hpp"
+#include "ycsb_key.hpp"
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Open addressing table (--engine swiss) with the same operations as
+// HashTable/IntHashTable: the keys are stored inline in the slots and every
+// slot has a control byte holding 7 bits of the hash of its key (or EMPTY).
+// A lookup compares a group of 16 control bytes at once (SSE2) and reads only
+// the slots whose fingerprint matches, so it touches the control line and
+// usually one slot line instead of following a chain of nodes.
+//
+// The control bytes and the slots of a table are one region allocated on the
+// node of the table (node < 0: the regular heap, or the snapshot arena while
+// it is being built). The table doubles when it is 7/8 full. Keys are never
+// removed by the benchmark, so there are no tombstones.
+
+template <typename Key>
+class SwissTable {
+    static constexpr size_t GROUP = 16;
+    static constexpr int8_t EMPTY = -128;
+
+    struct Slot {
+        Key key;
+        int count;
+    };
+
+    int8_t* ctrl;   // capacity control bytes, followed by the slots
+    Slot* slots;
+    size_t capacity;
+    size_t size = 0;
+    int node;
+
+    static size_t region_size(size_t capacity) {
+        return capacity + capacity * sizeof(Slot);
+    }
+
+    void allocate(size_t cap) {
+        capacity = cap;
+        ctrl = static_cast<int8_t*>(node_region_alloc(node, region_size(capacity), alignof(Slot)));
+        memset(ctrl, EMPTY, capacity);
+        slots = reinterpret_cast<Slot*>(ctrl + capacity);
+    }
+
+    // bits of the hash of the slot and of the group are independent of the
+    // ones which picked the table (key_hash % num_tables)
+    static uint64_t mix(unsigned long key_hash) { return IntKey::mix(key_hash); }
+    static int8_t fingerprint(uint64_t h) { return static_cast<int8_t>(h & 0x7f); }
+
+    // bit i is set if control byte i of the group equals b
+    static uint32_t match(const int8_t* group, int8_t b) {
+#ifdef __SSE2__
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_bytes, _mm_set1_epi8(b)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; i++) {
+            mask |= (uint32_t)(group[i] == b) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Slot of the key, or the empty slot it would be inserted into
+    // (found == false). Groups are probed quadratically (triangular numbers
+    // visit every group of a power of 2 table).
+    template <typename Value>
+    size_t find(Value value, uint64_t h, bool& found) const {
+        size_t groups_mask = capacity / GROUP - 1;
+        size_t g = (h >> 7) & groups_mask;
+        int8_t fp = fingerprint(h);
+        for (size_t step = 1;; step++) {
+            const int8_t* group = ctrl + g * GROUP;
+            for (uint32_t m = match(group, fp); m; m &= m - 1) {
+                size_t idx = g * GROUP + __builtin_ctz(m);
+                if (slots[idx].key.equals(value)) {
+                    found = true;
+                    return idx;
+                }
+            }
+            uint32_t empty = match(group, EMPTY);
+            if (empty) {
+                found = false;
+                return g * GROUP + __builtin_ctz(empty);
+            }
+            g = (g + step) & groups_mask;
+        }
+    }
+
+    void grow() {
+        int8_t* old_ctrl = ctrl;
+        Slot* old_slots = slots;
+        size_t old_capacity = capacity;
+        allocate(capacity * 2);
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_ctrl[i] != EMPTY) {
+                bool found;
+                uint64_t h = mix(old_slots[i].key.hash);
+                size_t idx = find(old_slots[i].key.value(), h, found);
+                ctrl[idx] = fingerprint(h);
+                slots[idx] = old_slots[i];
+            }
+        }
+        node_region_free(node, old_ctrl, region_size(old_capacity));
+    }
+
+    template <typename Value>
+    Slot& emplace(Value value, unsigned long key_hash, size_t idx, uint64_t h) {
+        if ((size + 1) * 8 > capacity * 7) {
+            grow();
+            bool found;
+            idx = find(value, h, found);
+        }
+        ctrl[idx] = fingerprint(h);
+        slots[idx].key.assign(value, key_hash);
+        slots[idx].count = 0;
+        size++;
+        return slots[idx];
+    }
+
+public:
+    using value_type = decltype(std::declval<Key>().value());
+
+    // capacity for (at least) <buckets> keys, rounded up to a power of 2
+    SwissTable(int buckets, int node = -1) : node(node) {
+        size_t cap = GROUP;
+        while (cap < (size_t)buckets) {
+            cap *= 2;
+        }
+        allocate(cap);
+    }
+
+    ~SwissTable() { node_region_free(node, ctrl, region_size(capacity)); }
+
+    bool insert(value_type key, unsigned long key_hash) {
+        bool found;
+        uint64_t h = mix(key_hash);
+        size_t idx = find(key, h, found);
+        if (found) {
+            slots[idx].count++;
+            return false;
+        }
+        emplace(key, key_hash, idx, h).count = 1;
+        return true;
+    }
+
+    int getCount(value_type key, unsigned long key_hash) {
+        bool found;
+        size_t idx = find(key, mix(key_hash), found);
+        return found ? slots[idx].count : 0;
+    }
+
+    // Updated in place - unlike HashTable::updateCount() nothing is allocated
+    // (except when a missing key is inserted).
+    bool updateCount(value_type key, int count, unsigned long key_hash) {
+        bool found;
+        uint64_t h = mix(key_hash);
+        size_t idx = find(key, h, found);
+        if (found) {
+            slots[idx].count += count;
+        } else {
+            emplace(key, key_hash, idx, h).count = count;
+        }
+        return true;
+    }
+
+    static void* operator new(size_t size) { return SnapshotArena::alloc(size); }
+    static void operator delete(void* p) { SnapshotArena::free(p); }
+};
+
+#endif
@@ -0,0 +1,32 @@
+//
+//  counter_generator.h
+//  YCSB-C
+//
+//  Notes:
+//  - Shared by all the threads (the counter is atomic)
+//
+
+#ifndef YCSB_C_COUNTER_GENERATOR_H_
+#define YCSB_C_COUNTER_GENERATOR_H_
+
+#include "zipfian_generator.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace ycsbc {
+
+class CounterGenerator : public Generator<uint64_t> {
+ public:
+  CounterGenerator(uint64_t start) : counter_(start) { }
+  uint64_t Next() override { return counter_.fetch_add(1); }
+  uint64_t Last() override { return counter_.load() - 1; }
+  void Set(uint64_t start) { counter_.store(start); }
+
+ private:
+  std::atomic<uint64_t> counter_;
+};
+
+}
+
+#endif // YCSB_C_COUNTER_GENERATOR_H_
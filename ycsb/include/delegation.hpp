@@ -0,0 +1,121 @@
+#pragma once
+#ifndef _DELEGATION_HPP_
+#define _DELEGATION_HPP_
+
+#include "node_region.hpp"
+#include "table_lock.hpp"
+#include "ycsb_benchmark.hpp"
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+// Request ring of a shard in the delegation mode (--delegation): every
+// client thread has its own slot (a cache line) in the ring of every shard.
+// A client writes its request into the slot and publishes it by bumping
+// seq, then spins on its slot until the server of the shard sets done to
+// the same value. The server, pinned to the node of the shard, sweeps the
+// whole ring and applies every pending request in one pass (ffwd style), so
+// the tables and their locks are only touched by threads of their node.
+// A slot has a single writer of each field at a time, nothing is locked.
+// A server without requests spins for a while and then parks on the
+// parked word of its ring (a futex), the next client request wakes it up.
+
+struct alignas(64) DelegationSlot {
+    std::atomic<uint64_t> seq{0};   // written by the client
+    std::atomic<uint64_t> done{0};  // written by the server
+    OpType op;
+    int table;
+    uint64_t key_id;
+    bool inserted;                  // result of the request
+};
+
+class DelegationRing {
+public:
+    // idle passes of a server before it parks
+    static constexpr unsigned PARK_AFTER = 1024;
+
+    // The slots of <clients> threads and the parked word (in a slot-sized
+    // line after them), allocated on <node> (< 0: the heap).
+    DelegationRing(int clients, int node) : clients(clients), node(node) {
+        void* p = node_region_alloc(node, sizeof(DelegationSlot) * (clients + 1), alignof(DelegationSlot));
+        slots = static_cast<DelegationSlot*>(p);
+        for (int i = 0; i < clients; i++) {
+            new (&slots[i]) DelegationSlot();
+        }
+        parked = new (&slots[clients]) std::atomic<uint32_t>(0);
+    }
+
+    ~DelegationRing() {
+        node_region_free(node, slots, sizeof(DelegationSlot) * (clients + 1));
+    }
+
+    // Runs <op> on key <key_id> in table <table> of the shard by its server
+    // and waits for it. Returns true if a new key was inserted.
+    bool delegate(int client, OpType op, int table, uint64_t key_id) {
+        DelegationSlot& slot = slots[client];
+        slot.op = op;
+        slot.table = table;
+        slot.key_id = key_id;
+        uint64_t seq = slot.seq.load(std::memory_order_relaxed) + 1;
+        // seq_cst: the server either sees the request or is seen parked
+        slot.seq.store(seq, std::memory_order_seq_cst);
+        wake();
+        for (unsigned spins = 0; slot.done.load(std::memory_order_acquire) != seq; spins++) {
+            TableLock::backoff(spins);
+        }
+        return slot.inserted;
+    }
+
+    // One pass of the server over the ring: apply(op, table, key_id) for
+    // every pending request. Returns the number of requests applied.
+    template <typename F>
+    int serve(F&& apply) {
+        int served = 0;
+        for (int i = 0; i < clients; i++) {
+            DelegationSlot& slot = slots[i];
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq == slot.done.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            slot.inserted = apply(slot.op, slot.table, slot.key_id);
+            slot.done.store(seq, std::memory_order_release);
+            served++;
+        }
+        return served;
+    }
+
+    // Blocks the server until a request is published or <stopped> is set
+    // (followed by wake()).
+    void park(const std::atomic<bool>& stopped) {
+        parked->store(1, std::memory_order_seq_cst);
+        if (pending() || stopped.load(std::memory_order_seq_cst)) {
+            parked->store(0, std::memory_order_relaxed);
+            return;
+        }
+        parked->wait(1, std::memory_order_acquire);
+    }
+
+    // Wakes the server if it is parked.
+    void wake() {
+        if (parked->load(std::memory_order_seq_cst) && parked->exchange(0, std::memory_order_acq_rel)) {
+            parked->notify_one();
+        }
+    }
+
+private:
+    bool pending() const {
+        for (int i = 0; i < clients; i++) {
+            if (slots[i].seq.load(std::memory_order_seq_cst) != slots[i].done.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    DelegationSlot* slots;
+    std::atomic<uint32_t>* parked; // 1 while the server is (about to be) parked
+    int clients;
+    int node;
+};
+
+#endif
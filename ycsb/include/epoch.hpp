@@ -0,0 +1,175 @@
+#pragma once
+#ifndef _EPOCH_HPP_
+#define _EPOCH_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Epoch-based reclamation of the nodes replaced by copy-on-write updates
+// (--locking rcu). A lock-free reader announces the global epoch it runs in
+// (Epoch::Guard); a writer unlinks a node and retires it to its own list of
+// the current epoch. The global epoch advances only when every active reader
+// has announced it, so once it is two epochs past the one a node was retired
+// in, no reader can still hold the node and the writer thread frees it -
+// retired nodes are always freed by the thread (so on the node) which
+// replaced them, never by a remote reader.
+
+class Epoch {
+public:
+    static constexpr unsigned MAX_THREADS = 1024;
+    // retires between two attempts to advance the epoch
+    static constexpr unsigned RETIRE_BATCH = 64;
+
+    // Critical section of a lock-free reader.
+    struct Guard {
+        Guard() { enter(); }
+        ~Guard() { exit(); }
+    };
+
+    static void enter() {
+        Record& r = self();
+        r.state.store((global.load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+        // the announcement is visible before any node is read
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    static void exit() {
+        self().state.store(0, std::memory_order_release);
+    }
+
+    // Frees <node> (delete) once no reader can see it any more.
+    template <typename T>
+    static void retire(T* node) {
+        retire(node, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    static void retire(void* p, void (*deleter)(void*)) {
+        Local& l = local();
+        uint64_t e = global.load(std::memory_order_acquire);
+        Limbo& limbo = l.limbo[e % 3];
+        if (limbo.epoch != e) {
+            // retired at least 3 epochs ago
+            free_all(limbo);
+            limbo.epoch = e;
+        }
+        limbo.nodes.push_back({p, deleter});
+        if (++l.retired % RETIRE_BATCH == 0) {
+            try_advance();
+            collect(l);
+        }
+    }
+
+private:
+    struct alignas(64) Record {
+        std::atomic<bool> used{false};
+        // (epoch << 1) | 1 while in a critical section, 0 otherwise
+        std::atomic<uint64_t> state{0};
+    };
+
+    struct Retired {
+        void* p;
+        void (*deleter)(void*);
+    };
+
+    struct Limbo {
+        uint64_t epoch = 0;
+        std::vector<Retired> nodes;
+    };
+
+    // Nodes retired by the thread, by epoch modulo 3. On exit the thread
+    // waits until it can free all of them and gives its record back.
+    struct Local {
+        Record* record = nullptr;
+        Limbo limbo[3];
+        uint64_t retired = 0;
+
+        ~Local() {
+            for (unsigned spins = 0; !empty(); spins++) {
+                try_advance();
+                collect(*this);
+                if (spins > 64) {
+                    std::this_thread::yield();
+                }
+            }
+            if (record) {
+                record->state.store(0, std::memory_order_release);
+                record->used.store(false, std::memory_order_release);
+            }
+        }
+
+        bool empty() const {
+            return limbo[0].nodes.empty() && limbo[1].nodes.empty() && limbo[2].nodes.empty();
+        }
+    };
+
+    static std::atomic<uint64_t> global;
+    static Record records[MAX_THREADS];
+    static std::atomic<unsigned> high_water;
+
+    static Local& local() {
+        static thread_local Local l;
+        return l;
+    }
+
+    static Record& self() {
+        Local& l = local();
+        if (l.record == nullptr) {
+            l.record = claim();
+        }
+        return *l.record;
+    }
+
+    static Record* claim() {
+        for (unsigned i = 0; i < MAX_THREADS; i++) {
+            bool expected = false;
+            if (!records[i].used.load(std::memory_order_relaxed) &&
+                records[i].used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                unsigned hw = high_water.load(std::memory_order_relaxed);
+                while (hw < i + 1 && !high_water.compare_exchange_weak(hw, i + 1)) {
+                }
+                return &records[i];
+            }
+        }
+        throw std::runtime_error("Too many threads for epoch-based reclamation");
+    }
+
+    // Moves the global epoch on if every active reader is in it.
+    static void try_advance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t e = global.load(std::memory_order_relaxed);
+        unsigned n = high_water.load(std::memory_order_acquire);
+        for (unsigned i = 0; i < n; i++) {
+            uint64_t s = records[i].state.load(std::memory_order_acquire);
+            if ((s & 1) && (s >> 1) != e) {
+                return;
+            }
+        }
+        global.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+    }
+
+    // Frees the nodes retired two or more epochs ago.
+    static void collect(Local& l) {
+        uint64_t e = global.load(std::memory_order_acquire);
+        for (Limbo& limbo : l.limbo) {
+            if (limbo.epoch + 2 <= e) {
+                free_all(limbo);
+            }
+        }
+    }
+
+    static void free_all(Limbo& limbo) {
+        for (Retired& r : limbo.nodes) {
+            r.deleter(r.p);
+        }
+        limbo.nodes.clear();
+    }
+};
+
+inline std::atomic<uint64_t> Epoch::global{1};
+inline Epoch::Record Epoch::records[Epoch::MAX_THREADS];
+inline std::atomic<unsigned> Epoch::high_water{0};
+
+#endif
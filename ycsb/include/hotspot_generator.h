@@ -0,0 +1,64 @@
+//
+//  hotspot_generator.h
+//  YCSB-C
+//
+//  Notes:
+//  - hot_ops_fraction of the operations go to the first hot_set_fraction
+//    of the items, both the hot and the cold set are uniform
+//
+
+#ifndef YCSB_C_HOTSPOT_GENERATOR_H_
+#define YCSB_C_HOTSPOT_GENERATOR_H_
+
+#include "zipfian_generator.h"
+
+#include <cstdint>
+#include <random>
+
+namespace ycsbc {
+
+class HotspotGenerator : public Generator<uint64_t> {
+ public:
+  HotspotGenerator(uint64_t min, uint64_t max, double hot_set_fraction,
+                   double hot_ops_fraction) :
+      base_(min),
+      hot_ops_fraction_(hot_ops_fraction),
+      rng_(Seed()),
+      uniform_(0.0, 1.0)
+  {
+    uint64_t num_items = max - min + 1;
+    uint64_t hot_items = num_items * hot_set_fraction;
+    if (hot_items == 0) {
+      hot_items = 1;
+    }
+    if (hot_items >= num_items) {
+      hot_items = num_items - 1;
+    }
+    hot_ = std::uniform_int_distribution<uint64_t>(0, hot_items - 1);
+    cold_ = std::uniform_int_distribution<uint64_t>(hot_items, num_items - 1);
+
+    Next();
+  }
+
+  uint64_t Next() override {
+    if (uniform_(rng_) < hot_ops_fraction_) {
+      return last_value_ = base_ + hot_(rng_);
+    }
+    return last_value_ = base_ + cold_(rng_);
+  }
+  uint64_t Last() override { return last_value_; }
+
+ private:
+  const uint64_t base_;
+  const double hot_ops_fraction_;
+  uint64_t last_value_;
+
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> uniform_;
+  std::uniform_int_distribution<uint64_t> hot_;
+  std::uniform_int_distribution<uint64_t> cold_;
+};
+
+}
+
+#endif // YCSB_C_HOTSPOT_GENERATOR_H_
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef _LATENCY_HISTOGRAM_HPP_
+#define _LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Log-linear histogram of latencies (in ns): values below 2^SUB_BITS have a
+// bucket each, above that every power of 2 is split into 2^SUB_BITS buckets,
+// so a recorded value is off by less than 1/32 (3%) over the whole range.
+// Every thread records into its own histograms, they are merged at the end.
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr uint64_t SUB = 1ULL << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    LatencyHistogram() : buckets(BUCKETS, 0) {}
+
+    void record(uint64_t ns) {
+        buckets[index(ns)]++;
+        total++;
+        max_ns = std::max(max_ns, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            buckets[i] += other.buckets[i];
+        }
+        total += other.total;
+        max_ns = std::max(max_ns, other.max_ns);
+    }
+
+    void reset() {
+        std::fill(buckets.begin(), buckets.end(), 0);
+        total = 0;
+        max_ns = 0;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_ns; }
+
+    // Latency which <p> percent of the recorded ones do not exceed (the
+    // upper bound of its bucket, at most the maximum).
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = std::max<uint64_t>(1, (uint64_t)(p / 100 * total + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return std::min(upper_bound(i), max_ns);
+            }
+        }
+        return max_ns;
+    }
+
+private:
+    static size_t index(uint64_t v) {
+        if (v < SUB) {
+            return v;
+        }
+        unsigned shift = 63 - __builtin_clzll(v) - SUB_BITS;
+        return (shift + 1) * SUB + ((v >> shift) - SUB);
+    }
+
+    static uint64_t upper_bound(size_t idx) {
+        if (idx < SUB) {
+            return idx;
+        }
+        unsigned shift = idx / SUB - 1;
+        return ((SUB + idx % SUB) << shift) + ((1ULL << shift) - 1);
+    }
+
+    std::vector<uint64_t> buckets;
+    uint64_t total = 0;
+    uint64_t max_ns = 0;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef _NODE_REGION_HPP_
+#define _NODE_REGION_HPP_
+
+#include "numatype.hpp"
+#include "snapshot_arena.hpp"
+#include <cstddef>
+#include <new>
+#include <numa.h>
+
+// Memory of the tables that place their storage themselves (SwissTable,
+// BPlusTree): allocated on <node> (node < 0: the regular heap, or the
+// snapshot arena while it is being built).
+
+inline void* node_region_alloc(int node, size_t bytes, size_t align) {
+    if (node < 0) {
+        return SnapshotArena::alloc(bytes);
+    }
+#ifdef UMF
+    return umf_alloc(node, bytes, align);
+#else
+    (void)align;
+    void* p = numa_alloc_onnode(bytes, node);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+#endif
+}
+
+inline void node_region_free(int node, void* p, size_t bytes) {
+    if (node < 0) {
+        SnapshotArena::free(p);
+        return;
+    }
+#ifdef UMF
+    (void)bytes;
+    umf_free(node, p);
+#else
+    numa_free(p, bytes);
+#endif
+}
+
+#endif
@@ -0,0 +1,43 @@
+//
+//  scrambled_zipfian_generator.h
+//  YCSB-C
+//
+//  Notes:
+//  - The popular items are spread over the whole key space (FNV hash of
+//    the zipfian rank) instead of being clustered at its start
+//
+
+#ifndef YCSB_C_SCRAMBLED_ZIPFIAN_GENERATOR_H_
+#define YCSB_C_SCRAMBLED_ZIPFIAN_GENERATOR_H_
+
+#include "zipfian_generator.h"
+#include "ycsbutils.h"
+
+#include <cstdint>
+
+namespace ycsbc {
+
+class ScrambledZipfianGenerator : public Generator<uint64_t> {
+ public:
+  // zeta_n is ZipfianGenerator::Zeta(max - min + 1, zipfian_const)
+  ScrambledZipfianGenerator(uint64_t min, uint64_t max,
+                            double zipfian_const, double zeta_n) :
+      base_(min), num_items_(max - min + 1),
+      generator_(0, max - min, zipfian_const, zeta_n) { Next(); }
+
+  uint64_t Next() override {
+    return last_value_ =
+        base_ + utils::FNVHash64(generator_.Next()) % num_items_;
+  }
+  uint64_t Last() override { return last_value_; }
+
+ private:
+  const uint64_t base_;
+  const uint64_t num_items_;
+  ZipfianGenerator generator_;
+  uint64_t last_value_;
+};
+
+}
+
+#endif // YCSB_C_SCRAMBLED_ZIPFIAN_GENERATOR_H_
@@ -0,0 +1,43 @@
+//
+//  skewed_latest_generator.h
+//  YCSB-C
+//
+//  Notes:
+//  - The most recently inserted items (the last ones of the shared
+//    insert counter) are the most popular ones
+//
+
+#ifndef YCSB_C_SKEWED_LATEST_GENERATOR_H_
+#define YCSB_C_SKEWED_LATEST_GENERATOR_H_
+
+#include "counter_generator.h"
+#include "zipfian_generator.h"
+
+#include <cstdint>
+
+namespace ycsbc {
+
+class SkewedLatestGenerator : public Generator<uint64_t> {
+ public:
+  // zeta_n is ZipfianGenerator::Zeta(counter.Last() + 1, zipfian_const),
+  // it is raised (per thread) while the counter grows
+  SkewedLatestGenerator(CounterGenerator &counter, double zipfian_const,
+                        double zeta_n) :
+      basis_(counter),
+      zipfian_(0, basis_.Last(), zipfian_const, zeta_n) { Next(); }
+
+  uint64_t Next() override {
+    uint64_t max = basis_.Last();
+    return last_ = max - zipfian_.Next(max);
+  }
+  uint64_t Last() override { return last_; }
+
+ private:
+  CounterGenerator &basis_;
+  ZipfianGenerator zipfian_;
+  uint64_t last_;
+};
+
+}
+
+#endif // YCSB_C_SKEWED_LATEST_GENERATOR_H_
@@ -0,0 +1,187 @@
+#pragma once
+#ifndef _SNAPSHOT_ARENA_HPP_
+#define _SNAPSHOT_ARENA_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+
+#ifdef UMF
+#include <umf/memory_provider.h>
+#include <umf/providers/provider_file_memory.h>
+#endif
+
+// Snapshot of the prefilled tables of one node: a file (on tmpfs) mapped by
+// the UMF file memory provider at a fixed address and bound to the node.
+// While SnapshotArena::current is set (on the prefill threads) HashTable and
+// HashNode memory is bump-allocated from the arena, so once it is sealed
+// the file holds a complete image of the tables whose pointers stay valid
+// when a later run maps it back at the same address.
+//
+// A restored (or just sealed) snapshot is mapped privately (only its used
+// part - it does not grow any more): the benchmark modifies its copy-on-write
+// pages, the file is left intact. Blocks of the arena are never freed one
+// by one - delete of such a block is a no-op.
+
+struct SnapshotHeader {
+    uint64_t magic;
+    uint64_t capacity;
+    char config[256];           // parameters the tables were built for
+    std::atomic<uint64_t> used; // bump pointer (offset from the header)
+    uint64_t sealed;            // the tables are complete
+    void* root;                 // HashTable* array of the node
+};
+
+class SnapshotArena {
+public:
+    static constexpr uint64_t MAGIC = 0x3170616e73626379ULL; // "ycbsnap1"
+    static constexpr unsigned MAX_ARENAS = 8;
+    // 64 GiB of (sparse) file per node, 1 TiB apart from 0x600000000000
+    static constexpr size_t CAPACITY = 64ULL << 30;
+    static constexpr size_t PAGE = 2ULL << 20;
+    static void* base_address(unsigned idx) {
+        return reinterpret_cast<void*>(0x600000000000ULL + ((uint64_t)idx << 40));
+    }
+
+    // arena the calling thread allocates from (nullptr - the regular heap)
+    static inline thread_local SnapshotArena* current = nullptr;
+
+    // Maps <path> (creating it if needed). The snapshot is usable only if it
+    // was sealed for the same config - otherwise it is reset for rebuilding.
+    SnapshotArena(const std::string& path, unsigned idx, int numa_node,
+                  const std::string& config)
+        : path(path), idx(idx), numa_node(numa_node) {
+        if (idx >= MAX_ARENAS || config.size() >= sizeof(header->config)) {
+            throw std::invalid_argument("Invalid snapshot arena");
+        }
+        map(false, CAPACITY);
+        if (header->magic == MAGIC && header->sealed &&
+            header->capacity == CAPACITY && config == header->config) {
+            // keep the file intact from now on
+            map_private();
+        } else {
+            reset(config);
+        }
+        arenas[idx] = this;
+    }
+
+    ~SnapshotArena() {
+        arenas[idx] = nullptr;
+        unmap();
+    }
+
+    // Discards the content, the tables are going to be rebuilt.
+    void reset(const std::string& config) {
+        if (mapped != CAPACITY) {
+            map(false, CAPACITY);
+        }
+        header->sealed = 0;
+        header->capacity = CAPACITY;
+        header->root = nullptr;
+        header->used.store(sizeof(SnapshotHeader));
+        strcpy(header->config, config.c_str());
+        header->magic = MAGIC;
+    }
+
+    bool sealed() const { return header->magic == MAGIC && header->sealed != 0; }
+    void* root() const { return header->root; }
+
+    // Marks the tables complete and flushes the file.
+    void seal(void* root) {
+        header->root = root;
+        header->sealed = 1;
+        msync(header, header->used.load(), MS_SYNC);
+        map_private();
+    }
+
+    void* allocate(size_t size) {
+        size = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        uint64_t offset = header->used.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size > header->capacity) {
+            throw std::bad_alloc();
+        }
+        return reinterpret_cast<char*>(header) + offset;
+    }
+
+    bool contains(const void* p) const {
+        return p >= static_cast<const void*>(header) &&
+               p < static_cast<const void*>(reinterpret_cast<char*>(header) + mapped);
+    }
+
+    // Allocation hooks of the snapshotted types.
+    static void* alloc(size_t size) {
+        if (current) {
+            return current->allocate(size);
+        }
+        return ::operator new(size);
+    }
+
+    static void free(void* p) {
+        for (auto arena : arenas) {
+            if (arena && arena->contains(p)) {
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+private:
+    static inline SnapshotArena* arenas[MAX_ARENAS] = {};
+
+    std::string path;
+    unsigned idx;
+    int numa_node;
+    SnapshotHeader* header = nullptr;
+    size_t mapped = 0;
+#ifdef UMF
+    umf_memory_provider_handle_t provider = nullptr;
+#endif
+
+    void map_private() {
+        map(true, (header->used.load() + PAGE - 1) & ~(PAGE - 1));
+    }
+
+    void map(bool priv, size_t size) {
+        unmap();
+#ifdef UMF
+        umf_file_memory_provider_params_t params =
+            umfFileMemoryProviderParamsDefault(path.c_str());
+        params.visibility = priv ? UMF_MEM_MAP_PRIVATE : UMF_MEM_MAP_SHARED;
+        params.size = size;
+        params.base_addr = base_address(idx);
+        params.numa_node = numa_node;
+        if (umfMemoryProviderCreate(umfFileMemoryProviderOps(), &params,
+                                    &provider) != UMF_RESULT_SUCCESS) {
+            throw std::runtime_error("Could not map snapshot " + path);
+        }
+        void* ptr = nullptr;
+        if (umfMemoryProviderAlloc(provider, size, 0, &ptr) != UMF_RESULT_SUCCESS) {
+            throw std::runtime_error("Could not map snapshot " + path);
+        }
+        header = static_cast<SnapshotHeader*>(ptr);
+        mapped = size;
+#else
+        (void)priv;
+        (void)size;
+        throw std::runtime_error("Snapshots require a UMF build (make UMF=1)");
+#endif
+    }
+
+    void unmap() {
+#ifdef UMF
+        if (provider) {
+            umfMemoryProviderDestroy(provider);
+            provider = nullptr;
+        }
+#endif
+        header = nullptr;
+        mapped = 0;
+    }
+};
+
+#endif
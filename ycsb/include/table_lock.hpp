@@ -0,0 +1,136 @@
+#pragma once
+#ifndef _TABLE_LOCK_HPP_
+#define _TABLE_LOCK_HPP_
+
+#include "epoch.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TABLE_LOCK_PAUSE() _mm_pause()
+#else
+#define TABLE_LOCK_PAUSE() std::atomic_signal_fence(std::memory_order_seq_cst)
+#endif
+
+// Concurrency control of one table (--locking):
+//  table      - one mutex per table (every operation takes it)
+//  striped    - the buckets are split into STRIPES stripes with a lock each,
+//               operations on keys of different stripes do not contend
+//  optimistic - the stripe locks are seqlocks: writers lock the stripe and
+//               bump its version, readers do not write anything - they read
+//               without the lock and retry if the version changed meanwhile
+//  rcu        - writers lock the stripe, readers neither lock nor retry:
+//               updates replace nodes (copy-on-write) and the old ones are
+//               reclaimed by epochs (epoch.hpp) once no reader can see them
+//
+// A key is always in the same stripe: it is picked from its bucket
+// (key_hash % buckets), so the stripes cover disjoint sets of bucket chains.
+// The striped modes need a table whose operations touch only the bucket of
+// the key (the chained engine) and, for the optimistic and rcu reads, whose
+// nodes are not freed while a reader may still see them (counts are updated
+// in place, or the nodes retired).
+
+enum class LockMode { table, striped, optimistic, rcu };
+
+class TableLock {
+public:
+    static constexpr unsigned STRIPES = 64;
+
+    static inline LockMode mode = LockMode::table;
+
+    static LockMode parse_mode(const std::string& m) {
+        if (m == "table") return LockMode::table;
+        if (m == "striped") return LockMode::striped;
+        if (m == "optimistic") return LockMode::optimistic;
+        if (m == "rcu") return LockMode::rcu;
+        throw std::invalid_argument("Unknown locking mode " + m);
+    }
+
+    TableLock(int buckets) : buckets(buckets) {}
+
+    void lock(unsigned long key_hash) {
+        if (mode == LockMode::table) {
+            table_mutex.lock();
+            return;
+        }
+        std::atomic<uint64_t>& version = stripe(key_hash).version;
+        for (unsigned spins = 0;; spins++) {
+            uint64_t v = version.load(std::memory_order_relaxed);
+            if (!(v & 1) && version.compare_exchange_weak(v, v + 1, std::memory_order_acquire)) {
+                break;
+            }
+            backoff(spins);
+        }
+        // the odd version is visible before any write of the critical section
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void unlock(unsigned long key_hash) {
+        if (mode == LockMode::table) {
+            table_mutex.unlock();
+            return;
+        }
+        stripe(key_hash).version.fetch_add(1, std::memory_order_release);
+    }
+
+    // Runs the read-only f() - in the optimistic mode without the lock,
+    // until no writer changed the stripe meanwhile, in the rcu mode without
+    // the lock in an epoch critical section.
+    template <typename F>
+    auto read(unsigned long key_hash, F&& f) {
+        if (mode == LockMode::rcu) {
+            Epoch::Guard guard;
+            return f();
+        }
+        if (mode != LockMode::optimistic) {
+            lock(key_hash);
+            auto ret = f();
+            unlock(key_hash);
+            return ret;
+        }
+        std::atomic<uint64_t>& version = stripe(key_hash).version;
+        for (unsigned spins = 0;;) {
+            uint64_t v = version.load(std::memory_order_acquire);
+            if (v & 1) {
+                backoff(spins++);
+                continue;
+            }
+            auto ret = f();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == v) {
+                return ret;
+            }
+        }
+    }
+
+    // spins a while, then gives the CPU to the (possibly preempted) thread
+    // being waited for
+    static void backoff(unsigned spins) {
+        if (spins < 128) {
+            TABLE_LOCK_PAUSE();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    // every stripe has its own cache line
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> version{0};
+    };
+
+    Stripe& stripe(unsigned long key_hash) {
+        return stripes[(key_hash % buckets) % STRIPES];
+    }
+
+    std::mutex table_mutex;
+    int buckets;
+    Stripe stripes[STRIPES];
+};
+
+#endif
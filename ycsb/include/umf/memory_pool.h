@@ -170,6 +170,75 @@ umf_memory_pool_handle_t umfPoolByPtr(const void *ptr);
 umf_result_t umfPoolGetMemoryProvider(umf_memory_pool_handle_t hPool,
                                       umf_memory_provider_handle_t *hProvider);
 
+///
+/// @brief Moves all the memory of \p hPool to the NUMA node \p target_node:
+///        the memory provider of the pool places the memory allocated from
+///        now on there, and every range the pool has already got from it
+///        is migrated (see umfMemoryProviderMigrate()). Meant for moving
+///        a data structure along with the threads using it. The pool may
+///        be used meanwhile: the ranges freed during the migration are
+///        skipped.
+/// @param hPool specified memory pool
+/// @param target_node OS index of the destination NUMA node
+/// @return UMF_RESULT_SUCCESS on success or appropriate error code on failure.
+///         UMF_RESULT_ERROR_NOT_SUPPORTED if the pool was created with
+///         UMF_POOL_CREATE_FLAG_DISABLE_TRACKING (its ranges are not known)
+///         or its provider does not support migration.
+///
+umf_result_t umfPoolMigrate(umf_memory_pool_handle_t hPool,
+                            unsigned target_node);
+
+/// @brief A single live allocation recorded by the pool sampler
+typedef struct umf_pool_sample_t {
+    void *ptr;       ///< address of the sampled allocation
+    size_t size;     ///< requested size of the sampled allocation
+    void *call_site; ///< return address of the allocating call
+    int numa_node; ///< node backing the first page or -1 if unknown/not faulted
+    size_t weight; ///< estimated number of live bytes this sample represents
+} umf_pool_sample_t;
+
+///
+/// @brief Enables (or reconfigures) sampling of the allocations made from
+///        \p hPool. Unlike the full tracking (see UMF_POOL_CREATE_FLAG_DISABLE_TRACKING)
+///        only a small, statistically representative subset of the
+///        allocations is recorded, so the cost on the allocation path is
+///        a thread-local countdown for all the other ones.
+///        Sampling can also be enabled for every created pool with the
+///        UMF_POOL_SAMPLING environment variable: "allocs,<N>" or "bytes,<N>".
+/// @param hPool specified memory pool
+/// @param every_n_allocs record (on average) one in \p every_n_allocs allocations,
+///        0 disables this criterion
+/// @param every_n_bytes record (on average) one allocation per \p every_n_bytes
+///        allocated bytes, 0 disables this criterion
+/// @return UMF_RESULT_SUCCESS on success or appropriate error code on failure.
+///
+umf_result_t umfPoolSetSampling(umf_memory_pool_handle_t hPool,
+                                size_t every_n_allocs, size_t every_n_bytes);
+
+///
+/// @brief Retrieves the live (not freed yet) sampled allocations of \p hPool.
+///        Summing the weight fields gives an estimate of the live heap size,
+///        grouping them by numa_node gives the estimated placement profile.
+/// @param hPool specified memory pool
+/// @param samples [out] array of at least *count entries, or NULL to query
+///        the number of live samples only
+/// @param count [in,out] capacity of \p samples on input, number of the
+///        samples stored (or available, if \p samples is NULL) on output
+/// @return UMF_RESULT_SUCCESS on success or appropriate error code on failure.
+///
+umf_result_t umfPoolGetSamples(umf_memory_pool_handle_t hPool,
+                               umf_pool_sample_t *samples, size_t *count);
+
+///
+/// @brief Hooks used by the inline allocation fast paths that bypass
+///        umfPoolMalloc()/umfPoolFree() (e.g. umfFastJemallocMalloc())
+///        to keep the pool sampler up to date. They are no-ops if sampling
+///        is not enabled for \p hPool.
+///
+void umfPoolSampleAlloc(umf_memory_pool_handle_t hPool, void *ptr, size_t size,
+                        void *call_site);
+void umfPoolSampleFree(umf_memory_pool_handle_t hPool, void *ptr);
+
 #ifdef __cplusplus
 }
 #endif
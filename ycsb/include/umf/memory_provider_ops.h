@@ -87,6 +87,23 @@ typedef struct umf_memory_provider_ext_ops_t {
     umf_result_t (*allocation_split)(void *hProvider, void *ptr,
                                      size_t totalSize, size_t firstSize);
 
+    ///
+    /// @brief Moves the physical pages of the virtual memory range \p ptr, \p size
+    ///        to the NUMA node \p target_node and binds the range to it, so pages
+    ///        faulted in later are placed there as well.
+    ///        If \p ptr is NULL and \p size is 0, the memory allocated by
+    ///        the provider from now on is placed on \p target_node instead.
+    /// @param hProvider handle to the memory provider
+    /// @param ptr beginning of the virtual memory range
+    /// @param size size of the virtual memory range
+    /// @param target_node OS index of the destination NUMA node
+    /// @return UMF_RESULT_SUCCESS on success or appropriate error code on failure
+    ///         UMF_RESULT_ERROR_INVALID_ALIGNMENT if ptr is not page-aligned.
+    ///         UMF_RESULT_ERROR_NOT_SUPPORTED if operation is not supported by this provider.
+    ///
+    umf_result_t (*migrate)(void *hProvider, void *ptr, size_t size,
+                            unsigned target_node);
+
 } umf_memory_provider_ext_ops_t;
 
 ///
@@ -26,6 +26,18 @@ typedef struct umf_file_memory_provider_params_t {
     unsigned protection;
     /// memory visibility mode
     umf_memory_visibility_t visibility;
+    /// If not 0, the file is neither truncated nor grown on demand: it is
+    /// (sparsely) extended to this size if it is smaller and mapped as
+    /// a whole at the provider creation, so its current content is preserved
+    /// (e.g. a snapshot kept on tmpfs). All allocations are carved out of
+    /// this single mapping. It has to be a multiple of the page size.
+    size_t size;
+    /// Address the mapping is placed at if \p size is not 0 (NULL - any).
+    /// The creation of the provider fails if this range is already mapped.
+    void *base_addr;
+    /// NUMA node the mapping is bound to if \p size is not 0 (-1 - none).
+    /// Pages already present in the file are migrated to this node.
+    int numa_node;
 } umf_file_memory_provider_params_t;
 
 /// @brief File Memory Provider operation results
@@ -45,6 +57,9 @@ umfFileMemoryProviderParamsDefault(const char *path) {
         path,                                       /* a path to the file */
         UMF_PROTECTION_READ | UMF_PROTECTION_WRITE, /* protection */
         UMF_MEM_MAP_PRIVATE,                        /* visibility mode */
+        0,    /* size (0 - grow the file on demand) */
+        NULL, /* base address */
+        -1,   /* NUMA node */
     };
 
     return params;
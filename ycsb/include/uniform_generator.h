@@ -0,0 +1,36 @@
+//
+//  uniform_generator.h
+//  YCSB-C
+//
+//  Notes:
+//  - Per-object mt19937_64 (thread-safe as long as each thread has its own)
+//
+
+#ifndef YCSB_C_UNIFORM_GENERATOR_H_
+#define YCSB_C_UNIFORM_GENERATOR_H_
+
+#include "zipfian_generator.h"
+
+#include <cstdint>
+#include <random>
+
+namespace ycsbc {
+
+class UniformGenerator : public Generator<uint64_t> {
+ public:
+  // Both min and max are inclusive
+  UniformGenerator(uint64_t min, uint64_t max) :
+      rng_(Seed()), dist_(min, max) { Next(); }
+
+  uint64_t Next() override { return last_value_ = dist_(rng_); }
+  uint64_t Last() override { return last_value_; }
+
+ private:
+  uint64_t last_value_;
+  std::mt19937_64 rng_;
+  std::uniform_int_distribution<uint64_t> dist_;
+};
+
+}
+
+#endif // YCSB_C_UNIFORM_GENERATOR_H_
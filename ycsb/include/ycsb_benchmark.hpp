@@ -1,14 +1,22 @@
 #ifndef YCSB_BENCHMARK_HPP
 #define YCSB_BENCHMARK_HPP
 
+#include <ostream>
 #include <string>
 #include "zipfian_generator.h"
+#include "counter_generator.h"
 #include <stdexcept>
+#include <utility>
 #include <jemalloc/jemalloc.h>
 #include <umf/pools/pool_jemalloc.h>
 using namespace ycsbc;
 using namespace std;
 
+#ifndef NUMA_NODE_NUM
+    #warning "NUMA_NODE_NUM not defined! Defaulting to 2."
+    #define NUMA_NODE_NUM 2
+#endif
+
 /**
  *
  * @param workload_key (A, B, C, D, E)
@@ -19,7 +27,7 @@ using namespace std;
  * @param locality_key (80-20, 50-50, 20-80)
  * @param num_threads 
  * @param th_config (regular, numa)
- * @param DS_config (regular, numa)
+ * @param DS_config (regular, numa, weighted[:L-R])
  */
 
 struct WorkloadConfig {
@@ -32,34 +40,113 @@ struct WorkloadConfig {
 
 WorkloadConfig selectWorkload(const string &w);
 
+// Operations of the workloads (the latencies are recorded per type).
+enum OpType { OP_READ, OP_UPDATE, OP_INSERT, OP_SCAN, OP_RMW, OP_TYPES };
+
+OpType op_type(const WorkloadConfig* cfg, int op_choice);
+
+const char* op_name(OpType op);
+
+// Key distribution (--distribution): uniform, zipfian, scrambled, latest or
+// hotspot[:S-O]. Every benchmark thread builds its own generator from it,
+// the zeta constant of the zipfian ones is computed once and shared.
+struct KeyDistribution {
+    string name;
+    uint64_t num_keys;
+    double theta;
+    double zeta_n;             // Zeta(num_keys, theta)
+    double hot_set;            // hotspot: fraction of the keys that are hot
+    double hot_ops;            // hotspot: fraction of the ops that go to them
+    CounterGenerator* latest;  // latest: keys inserted so far (shared)
+};
+
+KeyDistribution selectDistribution(const string &d, uint64_t num_keys, double theta);
+
+Generator<uint64_t>* make_key_generator(const KeyDistribution& dist);
+
+// --key_type int: the tables are IntHashTables keyed by the key id instead
+// of HashTables keyed by "key<id>" strings
+extern bool int_keys;
+
+// --engine: "chained" (HashTable/IntHashTable), "swiss" (SwissTable, open
+// addressing with the slots in one region on the node of the table) or
+// "btree" (BPlusTree, ordered - the tables are split by key range and the
+// scans of workload E walk the leaves)
+extern std::string engine;
+
+// --nodes: number of shards (each with its own tables and threads). Shard i
+// lives on node i, except that with 2 shards the second one is on MAX_NODE.
+extern int num_nodes;
+
+// --remote: how the remote operations pick the other shard, "uniform" or
+// "distance" (weighted by the inverse NUMA distance)
+extern std::string remote_policy;
+
+int shard_node(int shard);
+
+// Calls f.template operator()<Node>() with the (run-time) <node> as the
+// template argument of numa<T, Node> and thread_numa<Node>.
+template <typename F, int... Nodes>
+void with_node(int node, F&& f, std::integer_sequence<int, Nodes...>) {
+    bool found = ((node == Nodes ? (f.template operator()<Nodes>(), true) : false) || ...);
+    if (!found) {
+        throw std::invalid_argument("Node " + std::to_string(node) + " is not below NUMA_NODE_NUM");
+    }
+}
+
+template <typename F>
+void with_node(int node, F&& f) {
+    with_node(node, std::forward<F>(f), std::make_integer_sequence<int, NUMA_NODE_NUM>{});
+}
+
+// --load_factor: fraction (0, 1] of the keys inserted into every shard
+// before the run
+extern double load_factor;
+
 void global_init(int num_threads, int duration, int interval);
 
+void weighted_pools_init(const std::string& DS_config);
+
+// Maps the table snapshots in <dir>. Returns true if the prefilled tables
+// were restored, false if they are going to be built (and snapshotted) by
+// numa_hash_table_init().
+bool snapshot_init(const std::string& dir, const std::string& DS_config, int buckets, int num_tables, uint64_t num_keys);
+
+// Allocates the tables of the shard of the thread (the first thread of every
+// shard) and prefills them: all the threads of the shard insert their part
+// of the keys, the number of keys found afterwards is verified.
 void numa_hash_table_init(int thread_id, int numa_node, std::string DS_config, int buckets, int num_tables, uint64_t num_keys, int num_total_threads);
 
 void ycsb_test(
     int thread_id,
-    int num_total_threads,
     int numa_node,
     int duration,
     const WorkloadConfig* cfg,
-    ZipfianGenerator* gen,
+    const KeyDistribution* dist,
     uint64_t num_keys,
     int local_pct,
     int interval,
     int num_tables
 );
 
-void run_ycsb_benchmark(
-    const std::string& workload_key,
-    int duration,
-    uint64_t num_keys,
-    double theta,
-    int buckets,
-    const std::string& locality_key,
-    int num_threads,
-    const std::string& th_config,
-    const std::string& DS_config,
-    int num_tables
-);
+// --delegation: remote operations are not run by the thread itself but
+// shipped to the server thread of the target shard, see delegation.hpp.
+extern bool delegation;
+
+// Creates the request rings of the shards (for <num_threads> clients),
+// on the nodes of the shards if <numa_placement> (their servers are
+// pinned there).
+void delegation_init(int num_threads, bool numa_placement);
+
+// Server thread of <shard>: applies the requests of its ring until
+// delegation_stop().
+void delegation_server(int shard, uint64_t num_keys);
+
+void delegation_stop();
+
+// Prints the latency percentiles of every op type, local and remote, of the
+// last run to <out>, a CSV row each starting with <run> (the columns of the
+// run, ending with ", ").
+void print_latencies(std::ostream& out, const std::string& run);
 
 #endif
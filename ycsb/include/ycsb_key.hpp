@@ -0,0 +1,81 @@
+#pragma once
+#ifndef _YCSB_KEY_HPP_
+#define _YCSB_KEY_HPP_
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+// Keys of the benchmark operations. A key is formatted into (or kept in)
+// a buffer owned by the thread and hashed once: the hash picks the table
+// and is passed on to the table, which does not hash the key again. No
+// allocation happens on the hot path.
+
+// djb2 of HashTable::hash_key() continued over len more characters
+constexpr unsigned long djb2(unsigned long hash, const char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash = ((hash << 5) + hash) + s[i]; // hash * 33 + c
+    }
+    return hash;
+}
+
+// "key<id>" strings of HashTable
+struct StringKey {
+    // "key" + up to 20 digits of a uint64_t + '\0'
+    char buf[24] = {'k', 'e', 'y'};
+    unsigned long hash = 0;
+
+    static constexpr unsigned long PREFIX_HASH = djb2(5381, "key", 3);
+
+    void set(uint64_t id) {
+        char* end = std::to_chars(buf + 3, buf + sizeof(buf) - 1, id).ptr;
+        *end = '\0';
+        hash = djb2(PREFIX_HASH, buf + 3, end - (buf + 3));
+    }
+
+    const char* value() const { return buf; }
+
+    // keys stored in the slots of SwissTable and BPlusTree (which orders
+    // the keys as strings, like YCSB)
+    bool equals(const char* key) const { return strcmp(buf, key) == 0; }
+    int compare(const char* key) const { return strcmp(buf, key); }
+    void assign(const char* key, unsigned long key_hash) {
+        size_t len = strnlen(key, sizeof(buf) - 1);
+        memcpy(buf, key, len);
+        buf[len] = '\0';
+        hash = key_hash;
+    }
+};
+
+// Fixed-width integer keys of IntHashTable.
+struct IntKey {
+    uint64_t id = 0;
+    unsigned long hash = 0;
+
+    // finalizer of MurmurHash3 - every bit of the id affects the table
+    // and the bucket
+    static constexpr uint64_t mix(uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    void set(uint64_t key_id) {
+        id = key_id;
+        hash = mix(key_id);
+    }
+
+    uint64_t value() const { return id; }
+
+    bool equals(uint64_t key) const { return id == key; }
+    int compare(uint64_t key) const { return (id > key) - (id < key); }
+    void assign(uint64_t key, unsigned long key_hash) {
+        id = key;
+        hash = key_hash;
+    }
+};
+
+#endif
@@ -27,6 +27,16 @@ class Generator {
   virtual Value Next() = 0;
   virtual Value Last() = 0;
   virtual ~Generator() { }
+
+ protected:
+  // Strong per-thread seed
+  static uint64_t Seed() {
+    std::random_device rd;
+    uint64_t t = std::chrono::high_resolution_clock::now()
+                   .time_since_epoch().count();
+    uint64_t tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return rd() ^ (t + (tid << 1));
+  }
 };
 
 class ZipfianGenerator : public Generator<uint64_t> {
@@ -36,14 +46,22 @@ class ZipfianGenerator : public Generator<uint64_t> {
 
   ZipfianGenerator(uint64_t min, uint64_t max,
                    double zipfian_const = kZipfianConst) :
+      ZipfianGenerator(min, max, zipfian_const,
+                       Zeta(max - min + 1, zipfian_const)) { }
+
+  // zeta_n is Zeta(max - min + 1, zipfian_const) - it takes O(n) pow()
+  // calls, so it is computed once and shared by the generators of all
+  // the threads.
+  ZipfianGenerator(uint64_t min, uint64_t max, double zipfian_const,
+                   double zeta_n) :
       num_items_(max - min + 1),
       base_(min),
       theta_(zipfian_const),
-      zeta_n_(0),
+      zeta_n_(zeta_n),
       eta_(0),
       alpha_(0),
       zeta_2_(0),
-      n_for_zeta_(0),
+      n_for_zeta_(max - min + 1),
       last_value_(0),
       rng_(Seed()),
       uniform_(0.0, 1.0) 
@@ -52,8 +70,6 @@ class ZipfianGenerator : public Generator<uint64_t> {
 
     zeta_2_ = Zeta(2, theta_);
     alpha_ = 1.0 / (1.0 - theta_);
-
-    RaiseZeta(num_items_);
     eta_ = Eta();
 
     Next();   // warm up
@@ -66,17 +82,12 @@ class ZipfianGenerator : public Generator<uint64_t> {
   uint64_t Next() override { return Next(num_items_); }
   uint64_t Last() override { return last_value_; }
 
- private:
-
-  // Strong per-thread seed
-  static uint64_t Seed() {
-    std::random_device rd;
-    uint64_t t = std::chrono::high_resolution_clock::now()
-                   .time_since_epoch().count();
-    uint64_t tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
-    return rd() ^ (t + (tid << 1));
+  static double Zeta(uint64_t num, double theta) {
+    return Zeta(0, num, theta, 0);
   }
 
+ private:
+
   void RaiseZeta(uint64_t num) {
     assert(num >= n_for_zeta_);
     zeta_n_ = Zeta(n_for_zeta_, num, theta_, zeta_n_);
@@ -97,10 +108,6 @@ class ZipfianGenerator : public Generator<uint64_t> {
     return z;
   }
 
-  static double Zeta(uint64_t num, double theta) {
-    return Zeta(0, num, theta, 0);
-  }
-
   uint64_t num_items_;
   uint64_t base_;
   
@@ -130,11 +137,11 @@ inline uint64_t ZipfianGenerator::Next(uint64_t num) {
   double uz = u * zeta_n_;
 
   if (uz < 1.0) {
-    return last_value_ = 0;
+    return last_value_ = base_;
   }
   
   if (uz < 1.0 + std::pow(0.5, theta_)) {
-    return last_value_ = 1;
+    return last_value_ = base_ + 1;
   }
 
   return last_value_ =
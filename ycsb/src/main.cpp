@@ -1,5 +1,8 @@
 #include "ycsb_benchmark.hpp"
 #include "zipfian_generator.h"
+#include "table_lock.hpp"
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -24,37 +27,47 @@ int bucket_count = 1024;
 string workload_key = "A-100-0-100"; // Default to Workload A, 100% local, 100% of threads
 uint64_t num_keys = 10000;
 double theta = 0.99;
+string distribution = "zipfian";
 string th_config = "regular";
 string DS_config = "regular";
 int duration = 20;
 int interval = 10;
 int num_tables = 10;
+string snapshot_dir;
+string latency_file;
 
-extern int64_t ops0;
-extern int64_t ops1;
-extern std::vector<int64_t> globalOps0;
-extern std::vector<int64_t> globalOps1;
-std::vector <int64_t> num_ops1;
-std::vector <int64_t> num_ops0;
-std::vector <int64_t> total_ops;
-
-vector<thread_numa<NODE_ZERO>*> numa_thread0;
-vector<thread_numa<MAX_NODE>*> numa_thread1;
-vector<thread*> regular_thread0;
-vector<thread*> regular_thread1;
-vector<thread_numa<NODE_ZERO>*> init_thread0;
-vector<thread_numa<MAX_NODE>*> init_thread1;
-vector<std::thread*> init_thread_regular0;
-vector<std::thread*> init_thread_regular1;
-
-vector<ZipfianGenerator*> generators;
-
-void print_function(int duration, int64_t ops0, int64_t ops1, int64_t totalOps) {
+extern std::vector<std::vector<int64_t>> globalOps;
+
+// Starts a thread of <shard>, pinned to the node of the shard if <pin>.
+template <typename... Args>
+thread start_thread_on(bool pin, int shard, Args&&... args) {
+    if (!pin) {
+        return thread(std::forward<Args>(args)...);
+    }
+    thread t;
+    with_node(shard_node(shard), [&]<int Node>() {
+        t = thread_numa<Node>(std::forward<Args>(args)...);
+    });
+    return t;
+}
+
+// Starts a thread of <shard>, pinned to the node of the shard with the numa
+// th_config.
+template <typename... Args>
+thread start_thread(int shard, Args&&... args) {
+    return start_thread_on(th_config == "numa", shard, std::forward<Args>(args)...);
+}
+
+void print_date(std::ostream& out) {
 	auto now = std::chrono::system_clock::now();
     std::time_t now_time = std::chrono::system_clock::to_time_t(now);
     std::tm* local_time = std::localtime(&now_time);
-    std::cout<<std::put_time(local_time, "%Y-%m-%d") << ", ";
-	std::cout<<std::put_time(local_time, "%H:%M:%S") <<", ";
+    out<<std::put_time(local_time, "%Y-%m-%d") << ", ";
+	out<<std::put_time(local_time, "%H:%M:%S") <<", ";
+}
+
+void print_function(int duration, const vector<int64_t>& ops) {
+	print_date(std::cout);
 	std::cout<<num_tables << ", ";
 	std::cout<<num_threads << ", ";
 	std::cout<<th_config << ", ";
@@ -64,13 +77,51 @@ void print_function(int duration, int64_t ops0, int64_t ops1, int64_t totalOps)
 	std::cout<<duration << ", ";
 	std::cout<<num_keys<<", ";
 	std::cout<<interval<<", ";
-	std::cout<<ops0 << ", ";
-	std::cout<<ops1 << ", ";
+	int64_t totalOps = 0;
+	for (int64_t node_ops : ops) {
+		std::cout<<node_ops << ", ";
+		totalOps += node_ops;
+	}
 	std::cout<<totalOps << "\n";
 }
 
 void print_header() {
-    std::cout << "Date, Time, Num_Tables, Num_Threads, Thread_Config, DS_Config, Buckets, Workload, Duration(s), Num_Keys, Interval(s), Ops_Node0, Ops_Node1, Total_Ops\n";
+    std::cout << "Date, Time, Num_Tables, Num_Threads, Thread_Config, DS_Config, Buckets, Workload, Duration(s), Num_Keys, Interval(s), ";
+    for (int i = 0; i < num_nodes; i++) {
+        std::cout << "Ops_Node" << i << ", ";
+    }
+    std::cout << "Total_Ops\n";
+}
+
+// The latencies go to their own CSV (appended to, the header is written when
+// the file is created) so that stdout keeps one throughput row per interval.
+// Without --latencies they are printed to stderr.
+void print_latency_rows() {
+    const char* header = "Date, Time, num_tables, num_threads, thread_config, DS_config, buckets, workload, "
+                         "duration, num_keys, op, target, count, p50_ns, p99_ns, p999_ns, max_ns\n";
+    std::ostringstream run;
+    print_date(run);
+    // the workload may list several configs separated by commas
+    run << num_tables << ", " << num_threads << ", " << th_config << ", " << DS_config << ", "
+        << bucket_count << ", \"" << workload_key << "\", " << duration << ", " << num_keys << ", ";
+
+    if (latency_file.empty()) {
+        cerr << header;
+        print_latencies(cerr, run.str());
+        return;
+    }
+
+    std::error_code ec;
+    bool empty = !std::filesystem::exists(latency_file, ec) || std::filesystem::file_size(latency_file, ec) == 0;
+    std::ofstream out(latency_file, std::ios::app);
+    if (!out) {
+        cerr << "Cannot open " << latency_file << "\n";
+        return;
+    }
+    if (empty) {
+        out << header;
+    }
+    print_latencies(out, run.str());
 }
 
 void compile_options(int argc, char *argv[]) {
@@ -81,10 +132,20 @@ void compile_options(int argc, char *argv[]) {
         {"duration",   required_argument, nullptr, 'u'},
         {"keys",       required_argument, nullptr, 'k'},
         {"theta",      required_argument, nullptr, 'z'},
+        {"distribution", required_argument, nullptr, 'r'},
+        {"key_type",   required_argument, nullptr, 'y'},
+        {"engine",     required_argument, nullptr, 'e'},
+        {"locking",    required_argument, nullptr, 'l'},
+        {"nodes",      required_argument, nullptr, 'n'},
+        {"remote",     required_argument, nullptr, 'm'},
+        {"load_factor", required_argument, nullptr, 'f'},
+        {"delegation", no_argument,       nullptr, 'g'},
         {"th_config",  required_argument, nullptr, 'c'},
         {"DS_config",  required_argument, nullptr, 'd'},
         {"interval",   required_argument, nullptr, 'i'},
         {"tables",     required_argument, nullptr, 'a'},
+        {"snapshot",   required_argument, nullptr, 's'},
+        {"latencies",  required_argument, nullptr, 'L'},
         {"help",       no_argument,       nullptr, 'h'},
         {nullptr, 0, nullptr, 0}
     };
@@ -92,7 +153,7 @@ void compile_options(int argc, char *argv[]) {
     int opt;
     int option_index = 0;
 
-    while ((opt = getopt_long(argc, argv, "t:b:w:u:k:z:c:d:i:a:h", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "t:b:w:u:k:z:r:y:e:l:n:m:f:gc:d:i:a:s:L:h", long_options, &option_index)) != -1) {
         switch (opt) {
             case 't': num_threads = std::stoi(optarg); break;
             case 'b': bucket_count = std::stoi(optarg); break;
@@ -100,9 +161,56 @@ void compile_options(int argc, char *argv[]) {
             case 'u': duration = std::stoi(optarg); break;
             case 'k': num_keys = std::stoull(optarg); break;
             case 'z': theta = std::stod(optarg); break;
+            case 'r': distribution = optarg; break;
+            case 'y':
+                if (string(optarg) != "string" && string(optarg) != "int") {
+                    cerr << "Unknown key type " << optarg << "\n";
+                    exit(1);
+                }
+                int_keys = string(optarg) == "int";
+                break;
+            case 'e':
+                engine = optarg;
+                if (engine != "chained" && engine != "swiss" && engine != "btree") {
+                    cerr << "Unknown engine " << engine << "\n";
+                    exit(1);
+                }
+                break;
+            case 'l':
+                try {
+                    TableLock::mode = TableLock::parse_mode(optarg);
+                } catch (const std::invalid_argument& e) {
+                    cerr << e.what() << "\n";
+                    exit(1);
+                }
+                break;
+            case 'n':
+                num_nodes = std::stoi(optarg);
+                if (num_nodes < 1 || num_nodes > NUMA_NODE_NUM) {
+                    cerr << "The number of nodes must be in [1, " << NUMA_NODE_NUM << "] (NUM_NUMA_NODES)\n";
+                    exit(1);
+                }
+                break;
+            case 'm':
+                remote_policy = optarg;
+                if (remote_policy != "uniform" && remote_policy != "distance") {
+                    cerr << "Unknown remote policy " << remote_policy << "\n";
+                    exit(1);
+                }
+                break;
+            case 'f':
+                load_factor = std::stod(optarg);
+                if (load_factor <= 0 || load_factor > 1) {
+                    cerr << "The load factor must be in (0, 1]\n";
+                    exit(1);
+                }
+                break;
+            case 'g': delegation = true; break;
             case 'c': th_config = optarg; break;
             case 'd': DS_config = optarg; break;
             case 'a': num_tables = std::stoi(optarg); break;
+            case 's': snapshot_dir = optarg; break;
+            case 'L': latency_file = optarg; break;
             case 'h':
                 cout << "Usage: ./runner [options]\n";
                 cout << "Options:\n";
@@ -113,8 +221,23 @@ void compile_options(int argc, char *argv[]) {
                 cout << "  -o, --ops <num>          Total operations (default: 1000000)\n";
                 cout << "  -k, --keys <num>         Number of keys (default: 10000)\n";
                 cout << "  -z, --theta <float>      Zipfian theta (default: 0.99)\n";
+                cout << "  -r, --distribution <d>   Key distribution (uniform, zipfian, scrambled, latest, hotspot[:S-O]) (default: zipfian)\n";
+                cout << "                           hotspot: O% of the ops go to S% of the keys (default 20-80)\n";
+                cout << "  -y, --key_type <type>    Keys of the tables (string: \"key<id>\", int: the id) (default: string)\n";
+                cout << "  -e, --engine <engine>    Table engine (chained: bucket chains, swiss: open addressing,\n";
+                cout << "                           btree: B+tree with real range scans) (default: chained)\n";
+                cout << "  -l, --locking <mode>     Table locking (table: a mutex per table, striped: a lock per stripe of buckets,\n";
+                cout << "                           optimistic: striped seqlocks, lock-free reads,\n";
+                cout << "                           rcu: striped writers, lock-free reads, epoch reclamation) (default: table, chained only)\n";
+                cout << "  -n, --nodes <num>        Number of node shards, each with its tables and threads (default: 2)\n";
+                cout << "  -m, --remote <policy>    Shard of the remote ops (uniform, distance: weighted by 1/NUMA distance) (default: uniform)\n";
+                cout << "  -f, --load_factor <f>    Fraction of the keys prefilled into every shard (default: 1)\n";
+                cout << "  -g, --delegation         Ship the remote ops to a server thread of the target node\n";
                 cout << "  -c, --th_config <cfg>    Thread config (regular, numa) (default: regular)\n";
-                cout << "  -d, --DS_config <cfg>    Data structure config (regular, numa) (default: regular)\n";
+                cout << "  -d, --DS_config <cfg>    Data structure config (regular, numa, weighted[:L-R]) (default: regular)\n";
+                cout << "                           weighted: pages interleaved L:R local:remote (default 3-1, UMF only)\n";
+                cout << "  -s, --snapshot <dir>     Restore the prefilled tables from <dir>, build them there if missing (UMF only)\n";
+                cout << "  -L, --latencies <file>   Append the latency percentiles to the CSV <file> (default: stderr)\n";
                 exit(0);
             case '?':
                 cerr << "Unknown option or missing argument.\n";
@@ -122,6 +245,10 @@ void compile_options(int argc, char *argv[]) {
             default: break;
         }
     }
+    if (engine != "chained" && TableLock::mode != LockMode::table) {
+        cerr << "The striped, optimistic and rcu locking need the chained engine\n";
+        exit(1);
+    }
 }
 
 WorkloadConfig selectWorkload(const string &w) {
@@ -140,6 +267,44 @@ WorkloadConfig selectWorkload(const string &w) {
     throw runtime_error("Unknown workload " + w);
 }
 
+KeyDistribution selectDistribution(const string &d, uint64_t num_keys, double theta) {
+    KeyDistribution dist = {d, num_keys, theta, 0, 0, 0, nullptr};
+    if (num_keys < 2) {
+        throw runtime_error("At least 2 keys are required");
+    }
+    if (d.rfind("hotspot", 0) == 0) {
+        dist.name = "hotspot";
+        dist.hot_set = 0.2;
+        dist.hot_ops = 0.8;
+        size_t colon = d.find(':');
+        if (colon != string::npos) {
+            string fractions = d.substr(colon + 1);
+            size_t dash = fractions.find('-');
+            if (dash == string::npos) {
+                throw runtime_error("Invalid distribution " + d);
+            }
+            dist.hot_set = stod(fractions.substr(0, dash)) / 100;
+            dist.hot_ops = stod(fractions.substr(dash + 1)) / 100;
+        }
+        return dist;
+    }
+    if (d == "uniform") {
+        return dist;
+    }
+    if (d != "zipfian" && d != "scrambled" && d != "latest") {
+        throw runtime_error("Unknown distribution " + d);
+    }
+    if (theta <= 0 || theta >= 1) {
+        throw runtime_error("Zipfian theta must be in (0, 1)");
+    }
+    // O(num_keys), done once for all the threads
+    dist.zeta_n = ZipfianGenerator::Zeta(num_keys, theta);
+    if (d == "latest") {
+        dist.latest = new CounterGenerator(num_keys);
+    }
+    return dist;
+}
+
 struct MixedWorkloadConfig {
     WorkloadConfig cfg;
     int local_pct;
@@ -182,15 +347,15 @@ vector<MixedWorkloadConfig> parse_mixed_workload(const string& w_key, int num_th
         pool.push_back(pool.back());
     }
 
-    // 2. Deal the workloads evenly across the two NUMA nodes (Interleaving)
+    // 2. Deal the workloads evenly across the NUMA nodes (Interleaving)
     vector<MixedWorkloadConfig> thread_tasks(num_threads);
-    int threads_per_node = num_threads / 2;
+    int threads_per_node = num_threads / num_nodes;
     
     for(int i = 0; i < threads_per_node; i++) {
-        // Assign to Node 0 (Threads 0 to threads_per_node-1)
-        thread_tasks[i] = pool[i * 2]; 
-        // Assign to Node 1 (Threads threads_per_node to num_threads-1)
-        thread_tasks[i + threads_per_node] = pool[i * 2 + 1]; 
+        // Assign to Node n (Threads n * threads_per_node to (n + 1) * threads_per_node - 1)
+        for (int n = 0; n < num_nodes; n++) {
+            thread_tasks[i + n * threads_per_node] = pool[i * num_nodes + n];
+        }
     }
     
     return thread_tasks;
@@ -202,7 +367,6 @@ void run_ycsb_benchmark(
     double theta,
     int buckets,
     int num_threads,
-    const string& th_config,
     const string& DS_config,
     int num_tables
 ) 
@@ -212,153 +376,90 @@ void run_ycsb_benchmark(
         return;
     }
     
-    for (int i = 0; i < num_threads; ++i)
-        generators.push_back(new ZipfianGenerator(0, num_keys - 1, theta));
+    KeyDistribution key_dist = selectDistribution(distribution, num_keys, theta);
 
     vector<MixedWorkloadConfig> thread_tasks = parse_mixed_workload(workload_key, num_threads);
     
-    global_init(num_threads, duration, interval);
-    int threads_per_node = num_threads / 2;
+    int threads_per_node = num_threads / num_nodes;
+    global_init(threads_per_node * num_nodes, duration, interval);
+    int tables_per_node = num_tables / num_nodes;
 
 //Initialization
-    if (th_config == "numa") {
-        init_thread0.resize(threads_per_node);
-        init_thread1.resize(threads_per_node);
-        for(int i=0; i< threads_per_node; ++i)
-        {   int thread_id = i;
-            int numa_node = 0;
-            init_thread0[i] = new thread_numa<NODE_ZERO>(numa_hash_table_init, thread_id ,numa_node, DS_config, buckets, num_tables/2, num_keys, num_threads);
-        }
-
-        for(int i=0; i< threads_per_node; ++i)
-        {   
-            int thread_id = i + threads_per_node;
-            int numa_node = 1;
-            init_thread1[i] = new thread_numa<MAX_NODE>(numa_hash_table_init, thread_id ,numa_node, DS_config, buckets, num_tables/2, num_keys, num_threads);
-        }
-
-        for(auto th : init_thread0) th->join();
-        for(auto th : init_thread1) th->join();
-        for(auto th : init_thread0) delete th;
-        for(auto th : init_thread1) delete th;
-    } else {
-        init_thread_regular0.resize(threads_per_node);
-        init_thread_regular1.resize(threads_per_node);
-        for(int i=0; i< threads_per_node; ++i){   
-            int thread_id = i;
-            int numa_node = 0;
-            init_thread_regular0[i] = new thread(numa_hash_table_init, thread_id ,numa_node, DS_config, buckets, num_tables/2, num_keys, num_threads);
-        }
-        for(int i=0; i< threads_per_node; ++i)
-        {   
-            int thread_id = i + threads_per_node;
-            int numa_node = 1;
-            init_thread_regular1[i] = new thread(numa_hash_table_init, thread_id ,numa_node, DS_config, buckets, num_tables/2, num_keys, num_threads);
+    vector<thread> init_threads;
+    for (int n = 0; n < num_nodes; ++n) {
+        for (int i = 0; i < threads_per_node; ++i) {
+            int thread_id = i + n * threads_per_node;
+            init_threads.push_back(start_thread(n, numa_hash_table_init, thread_id, n, DS_config, buckets,
+                                                tables_per_node, num_keys, threads_per_node * num_nodes));
         }
-
-        for(auto th : init_thread_regular0) th->join();
-        for(auto th : init_thread_regular1) th->join();
-        for(auto th : init_thread_regular0) delete th;
-        for(auto th : init_thread_regular1) delete th;
     }
-
+    for (auto& th : init_threads) th.join();
 
 //End Initialization
 
-    if (th_config == "numa") {
-        numa_thread0.resize(threads_per_node);
-        numa_thread1.resize(threads_per_node);
-    } else {
-        regular_thread0.resize(threads_per_node);
-        regular_thread1.resize(threads_per_node);
-    }
-
-    auto start = chrono::high_resolution_clock::now();
-    int tables_per_node = num_tables/2;
-
-    for (int i = 0; i < threads_per_node; ++i) {
-        int thread_id = i;
-        int numa_node = 0;
-        if (th_config == "numa") 
-        {
-            numa_thread0[i] = new thread_numa<NODE_ZERO>(
-                ycsb_test,
-                thread_id, threads_per_node, numa_node, duration, 
-                &thread_tasks[thread_id].cfg, 
-                generators[thread_id], num_keys, 
-                thread_tasks[thread_id].local_pct, 
-                interval, tables_per_node
-            );
-        } else {
-            regular_thread0[i] = new thread(
-                ycsb_test,
-                thread_id, threads_per_node, numa_node, duration, 
-                &thread_tasks[thread_id].cfg, 
-                generators[thread_id], num_keys, 
-                thread_tasks[thread_id].local_pct, 
-                interval, tables_per_node
-            );
+    // one server per shard, pinned to the node of the shard (whatever the
+    // th_config is) with its ring on that node, unless the node does not exist
+    vector<thread> servers;
+    if (delegation) {
+        bool numa_servers = numa_available() >= 0 &&
+                            shard_node(num_nodes - 1) < numa_num_configured_nodes() &&
+                            shard_node(num_nodes - 1) < NUMA_NODE_NUM;
+        if (!numa_servers) {
+            cerr << "Not enough NUMA nodes, the delegation servers are not pinned.\n";
+        }
+        delegation_init(threads_per_node * num_nodes, numa_servers);
+        for (int n = 0; n < num_nodes; ++n) {
+            servers.push_back(start_thread_on(numa_servers, n, delegation_server, n, num_keys));
         }
     }
 
-    for (int i = 0; i < threads_per_node; ++i) {
-        int thread_id = i + threads_per_node;
-        int numa_node = 1;
-        if (th_config == "numa") {
-            numa_thread1[i] = new thread_numa<MAX_NODE>(
+    vector<thread> workers;
+    for (int n = 0; n < num_nodes; ++n) {
+        for (int i = 0; i < threads_per_node; ++i) {
+            int thread_id = i + n * threads_per_node;
+            workers.push_back(start_thread(n,
                 ycsb_test,
-                thread_id, threads_per_node, numa_node, duration, 
+                thread_id, n, duration, 
                 &thread_tasks[thread_id].cfg, 
-                generators[thread_id], num_keys, 
+                &key_dist, num_keys, 
                 thread_tasks[thread_id].local_pct, 
                 interval, tables_per_node
-            );
-        } else {
-            regular_thread1[i] = new thread(
-                ycsb_test,
-                thread_id, threads_per_node, numa_node, duration, 
-                &thread_tasks[thread_id].cfg, 
-                generators[thread_id], num_keys, 
-                thread_tasks[thread_id].local_pct, 
-                interval, tables_per_node
-            );
+            ));
         }
     }
+    for (auto& th : workers) th.join();
+    delegation_stop();
+    for (auto& th : servers) th.join();
 
-    if (th_config == "numa") {
-        for (auto th : numa_thread0) th->join();
-        for (auto th : numa_thread1) th->join();
-    } else {
-        for (auto th : regular_thread0) th->join();
-        for (auto th : regular_thread1) th->join();
-    }
-
-    if (th_config == "numa") {
-        for (auto th : numa_thread0) delete th;
-        for (auto th : numa_thread1) delete th;
-    } else {
-        for (auto th : regular_thread0) delete th;
-        for (auto th : regular_thread1) delete th;
-    }
-
-    num_ops0.push_back(ops0);
-	num_ops1.push_back(ops1);
-	total_ops.push_back(ops0 + ops1);
+    delete key_dist.latest;
 }
 
 int main(int argc, char** argv) {
 
     compile_options(argc, argv);
 
-    if (th_config == "numa" || DS_config == "numa") {
+    bool weighted = DS_config.rfind("weighted", 0) == 0;
+    if (th_config == "numa" || DS_config == "numa" || weighted) {
         if (numa_num_configured_nodes() == 1) {
             std::cout << "NUMA not available or only one node configured. Running in regular mode.\n";
             th_config = "regular";
             DS_config = "regular";
+            weighted = false;
         }
     }
+    if ((th_config == "numa" || DS_config == "numa" || weighted) &&
+        shard_node(num_nodes - 1) >= numa_num_configured_nodes()) {
+        std::cerr << "Only " << numa_num_configured_nodes() << " NUMA nodes configured.\n";
+        return 1;
+    }
+    if (weighted) {
+        weighted_pools_init(DS_config);
+    }
+    if (!snapshot_dir.empty() && snapshot_init(snapshot_dir, DS_config, bucket_count, num_tables/num_nodes, num_keys)) {
+        std::cerr << "Restored the tables from " << snapshot_dir << "\n";
+    }
 
-    print_function(0, 0, 0, 0); // Print header
+    print_header();
     run_ycsb_benchmark(
         workload_key,
         duration,
@@ -366,34 +467,20 @@ int main(int argc, char** argv) {
         theta,
         bucket_count,
         num_threads,
-        th_config,
         DS_config,
         num_tables
     );
 
-    for (auto gen : generators) {
-        delete gen;
-    }
-    
-    int64_t sum0 = 0;
-	int64_t sum1 = 0;
-	int64_t total_sum = 0;
-	
-	for(int i = 0; i < num_ops0.size(); i++){
-		sum0 += num_ops0[i];	
-	}
-	for(int i = 0; i < num_ops1.size(); i++){
-		sum1 += num_ops1[i];
-	}
-	for(int i = 0; i < total_ops.size(); i++){
-		total_sum += total_ops[i];
-	}
-	
 	int newDuration = interval;
-	for(int i = 0; i< globalOps0.size(); i++){
-		print_function(newDuration, globalOps0[i], globalOps1[i], globalOps0[i] + globalOps1[i]);
+	for(size_t i = 0; i < globalOps[0].size(); i++){
+		vector<int64_t> ops;
+		for (auto& node_ops : globalOps) {
+			ops.push_back(node_ops[i]);
+		}
+		print_function(newDuration, ops);
 		newDuration += interval;
 	}
+	print_latency_rows();
 
     return 0;
 }
@@ -1,6 +1,17 @@
 #include "ycsb_benchmark.hpp"
 #include "ycsbutils.h"
+#include "uniform_generator.h"
+#include "scrambled_zipfian_generator.h"
+#include "skewed_latest_generator.h"
+#include "hotspot_generator.h"
 #include "HashTable.hpp"
+#include "IntHashTable.hpp"
+#include "SwissTable.hpp"
+#include "BPlusTree.hpp"
+#include "table_lock.hpp"
+#include "delegation.hpp"
+#include "ycsb_key.hpp"
+#include "latency_histogram.hpp"
 #include <iostream>
 #include <sstream>
 #include <chrono>
@@ -18,6 +29,10 @@
 
 #include <map>
 #include <atomic>
+#include <memory>
+#include <type_traits>
+#include <cmath>
+#include <array>
 
 using namespace std;
 using namespace ycsbc;
@@ -30,173 +45,480 @@ using namespace std::chrono;
 #endif
 
 int global_successful_inserts;
-int global_successful_init_inserts;
-HashTable** ht_node0;
-HashTable** ht_node1;
-std::vector<std::mutex*> ht_node0_locks;
-std::vector<std::mutex*> ht_node1_locks;
+uint64_t global_successful_init_inserts;
+// prefilled keys of every shard: inserted and found again
+std::vector<uint64_t> prefill_expected;
+std::vector<uint64_t> prefill_found;
+double load_factor = 1.0;
+bool int_keys = false;
+std::string engine = "chained";
+int num_nodes = 2;
+std::string remote_policy = "uniform";
+// locks of the tables of every shard
+std::vector<std::vector<TableLock*>> shard_locks;
 
 std::mutex* printLK;
 std::mutex* globalLK;
 
-std::vector<int64_t> globalOps0;
-std::vector<int64_t> globalOps1;
-int64_t ops0=0;
-int64_t ops1=0;
+// ops of the threads of every shard at the end of every interval
+std::vector<std::vector<int64_t>> globalOps;
+// [shard][target shard] weight of the target of the remote operations
+std::vector<std::vector<double>> remote_weights;
+bool delegation = false;
+// request rings of the shards and the flag stopping their servers
+std::vector<DelegationRing*> delegation_rings;
+std::atomic<bool> delegation_stopped;
+// latencies of all the threads by op type and target (0 - local, 1 - remote)
+LatencyHistogram globalLatency[2][OP_TYPES];
 pthread_barrier_t bar;
 pthread_barrier_t init_bar;
 
-unsigned long prefill_hash(const char* key) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *key++)) {
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
+// DS_config "weighted[:L-R]" - the tables of each node live in a pool that
+// interleaves pages L:R between that node and the other ones (default 3-1).
+void weighted_pools_init(const std::string& DS_config) {
+#ifdef UMF
+    unsigned local_weight = 3;
+    unsigned remote_weight = 1;
+    size_t colon = DS_config.find(':');
+    if (colon != string::npos) {
+        string weights = DS_config.substr(colon + 1);
+        size_t dash = weights.find('-');
+        local_weight = stoul(weights.substr(0, dash));
+        remote_weight = (dash == string::npos) ? 0 : stoul(weights.substr(dash + 1));
+    }
+    umf_weighted_init(local_weight, remote_weight);
+#else
+    cerr << "DS_config " << DS_config << " requires a UMF build (make UMF=1).\n";
+    exit(1);
+#endif
+}
+
+int shard_node(int shard) {
+    return (num_nodes == 2 && shard == 1) ? MAX_NODE : shard;
+}
+
+// Tables of every shard (of the table type of the run).
+template <typename Table> std::vector<Table**> node_tables;
+
+// Calls f.template operator()<Table, Key>() for the engine and the key type
+// of the run.
+template <typename F>
+void with_table_type(F&& f) {
+    if (engine == "swiss") {
+        if (int_keys) {
+            f.template operator()<SwissTable<IntKey>, IntKey>();
+        } else {
+            f.template operator()<SwissTable<StringKey>, StringKey>();
+        }
+    } else if (engine == "btree") {
+        if (int_keys) {
+            f.template operator()<BPlusTree<IntKey>, IntKey>();
+        } else {
+            f.template operator()<BPlusTree<StringKey>, StringKey>();
+        }
+    } else if (int_keys) {
+        f.template operator()<IntHashTable, IntKey>();
+    } else {
+        f.template operator()<HashTable, StringKey>();
+    }
+}
+
+// Weights of the other shards as targets of the remote operations of the
+// threads of every shard (--remote): "uniform" - all alike, "distance" -
+// inversely proportional to the NUMA distance between their nodes (nearer
+// nodes get more of the remote operations).
+void remote_targets_init() {
+    remote_weights.assign(num_nodes, std::vector<double>(num_nodes, 0));
+    for (int from = 0; from < num_nodes; from++) {
+        for (int to = 0; to < num_nodes; to++) {
+            if (to == from) {
+                continue;
+            }
+            int distance = 0;
+            if (remote_policy == "distance" && numa_available() != -1) {
+                distance = numa_distance(shard_node(from), shard_node(to));
+            }
+            // (the distance is 0 if it is unknown)
+            remote_weights[from][to] = distance > 0 ? 1.0 / distance : 1.0;
+        }
     }
-    return hash;
 }
 
 void global_init(int num_threads, int duration, int interval) {
 	pthread_barrier_init(&bar, NULL, num_threads);
 	pthread_barrier_init(&init_bar, NULL, num_threads);
-	globalOps0.resize(duration/interval);
-	globalOps1.resize(duration/interval);
-	ops0 = 0;
-	ops1 = 0;
+	globalOps.assign(num_nodes, std::vector<int64_t>(duration/interval));
+	// (restored snapshots have their tables and locks already)
+	shard_locks.resize(num_nodes);
+	with_table_type([&]<typename Table, typename Key>() {
+		node_tables<Table>.resize(num_nodes);
+	});
+	remote_targets_init();
+	for (auto& target : globalLatency) {
+		for (auto& h : target) {
+			h.reset();
+		}
+	}
 	printLK = new std::mutex();
 	globalLK = new std::mutex();
     global_successful_init_inserts=0;
     global_successful_inserts=0;
+    prefill_expected.assign(num_nodes, 0);
+    prefill_found.assign(num_nodes, 0);
 }
-void numa_hash_table_init(int thread_id,
-                          int node,
-                          std::string DS_config,
-                          int buckets,
-                          int num_tables,        // tables per node
-                          uint64_t num_keys,
-                          int num_total_threads)
-{
-    int threads_per_node = num_total_threads / 2;
-    // ------------------ GLOBAL ALLOCATION (ONCE) ------------------
-    if (thread_id == 0) {
-        if(DS_config == "numa") {
-            //std::cout << "Thread " << thread_id << " initializing NUMA hash tables on Node " << NODE_ZERO << std::endl;
-            ht_node0 = reinterpret_cast<HashTable**>( new numa<HashTable*, NODE_ZERO>[num_tables]);
-            ht_node0_locks.resize(num_tables);
-            for(int i = 0; i < num_tables; i++) {
-                ht_node0[i] = reinterpret_cast<HashTable*>( new numa<HashTable, NODE_ZERO>(buckets));
-                ht_node0_locks[i] = new std::mutex();
-            }
-            //std::cout << "Thread " << thread_id << " finished initializing NUMA hash tables on Node " << NODE_ZERO << std::endl;
+
+// --snapshot <dir>: the tables of shard i are built into (or restored from)
+// <dir>/ycsb-node<i>.snap, see snapshot_arena.hpp. A snapshot is reused only
+// if it was built for the same DS_config, buckets, tables, keys, key type,
+// engine, number of nodes and load factor.
+std::vector<SnapshotArena*> snapshot_arenas;
+bool snapshot_restored = false;
+
+bool snapshot_init(const std::string& dir, const std::string& DS_config, int buckets, int num_tables, uint64_t num_keys) {
+    if (DS_config.rfind("weighted", 0) == 0) {
+        cerr << "Snapshots do not support DS_config " << DS_config << ".\n";
+        exit(1);
+    }
+    string config = DS_config + " " + to_string(buckets) + " " + to_string(num_tables) + " " + to_string(num_keys) +
+                    (int_keys ? " int " : " string ") + engine + " " + to_string(num_nodes) + " " +
+                    to_string(load_factor);
+    try {
+        snapshot_restored = true;
+        for (int i = 0; i < num_nodes; i++) {
+            snapshot_arenas.push_back(new SnapshotArena(dir + "/ycsb-node" + to_string(i) + ".snap", i,
+                                                        DS_config == "numa" ? shard_node(i) : -1, config));
+            snapshot_restored = snapshot_restored && snapshot_arenas[i]->sealed();
         }
-        else {
-            ht_node0 = reinterpret_cast<HashTable**>( new HashTable*[num_tables]);
-            ht_node0_locks.resize(num_tables);
-            for(int i = 0; i < num_tables; i++) {
-                ht_node0[i] = new HashTable(buckets);
-                ht_node0_locks[i] = new std::mutex();
+        if (!snapshot_restored) {
+            for (auto arena : snapshot_arenas) {
+                arena->reset(config);
             }
+            return false;
         }
+    } catch (const std::exception& e) {
+        cerr << e.what() << "\n";
+        exit(1);
     }
-    if (thread_id == threads_per_node +1 && node == 1) {
-        if(DS_config == "numa") {
-            //std::cout << "Thread " << thread_id << " initializing NUMA hash tables on Node " << MAX_NODE<< std::endl;
-            ht_node1 = reinterpret_cast<HashTable**>( new numa<HashTable*, MAX_NODE>[num_tables]);
-            ht_node1_locks.resize(num_tables);
-            for(int i = 0; i < num_tables; i++) {
-                ht_node1[i] = reinterpret_cast<HashTable*>( new numa<HashTable, MAX_NODE>(buckets));
-                ht_node1_locks[i] = new std::mutex();
-            }
-            //std::cout << "Thread " << thread_id << " finished initializing NUMA hash tables on Node " << MAX_NODE << std::endl;
+
+    with_table_type([&]<typename Table, typename Key>() {
+        node_tables<Table>.resize(num_nodes);
+        for (int i = 0; i < num_nodes; i++) {
+            node_tables<Table>[i] = static_cast<Table**>(snapshot_arenas[i]->root());
         }
-        else {  
-            ht_node1 = reinterpret_cast<HashTable**>( new HashTable*[num_tables]);
-            ht_node1_locks.resize(num_tables);
-            for(int i = 0; i < num_tables; i++) {
-                ht_node1[i] = new HashTable(buckets);
-                ht_node1_locks[i] = new std::mutex();
-            }
-        }   
+    });
+    shard_locks.resize(num_nodes);
+    for (auto& locks : shard_locks) {
+        locks.resize(num_tables);
+        for (int i = 0; i < num_tables; i++) {
+            locks[i] = new TableLock(buckets);
+        }
+    }
+    return true;
+}
+
+// Index of the table of the key among <n> tables: by hash, or by key range
+// for the ordered tables (a scan then stays within one table).
+template <typename Table, typename Key>
+static inline int table_of(const Key& key, uint64_t key_id, int n, uint64_t num_keys)
+{
+    if constexpr (requires { Table::ordered; }) {
+        // the latest distribution inserts keys past num_keys
+        return key_id < num_keys ? key_id * n / num_keys : n - 1;
+    } else {
+        return key.hash % n;
+    }
+}
+
+// True if the key is one of the load_factor part of the keys which are
+// prefilled (picked by a hash of the id, not the most popular ones).
+static inline bool prefilled(uint64_t key_id)
+{
+    return load_factor >= 1.0 || IntKey::mix(key_id) < std::ldexp(load_factor, 64);
+}
+
+// New table of node <Node>. SwissTables and BPlusTrees allocate their slots
+// (nodes) on the node themselves (in a snapshot build the arena is bound to the node already).
+template <typename Table, int Node>
+Table* new_table(int buckets, int node) {
+    if constexpr (std::is_constructible_v<Table, int, int>) {
+        return new numa<Table, Node>(buckets, node);
+    } else {
+        return new numa<Table, Node>(buckets);
+    }
+}
+
+// Allocates the tables (and locks) of <shard> (on node <Node>) where
+// DS_config places them.
+template <typename Table, int Node>
+void alloc_node_tables(int shard, const std::string& DS_config, bool snapshot_build, int buckets, int num_tables) {
+    Table**& tables = node_tables<Table>[shard];
+    std::vector<TableLock*>& locks = shard_locks[shard];
+    if (snapshot_build) {
+        tables = static_cast<Table**>(SnapshotArena::alloc(sizeof(Table*) * num_tables));
+        for(int i = 0; i < num_tables; i++) {
+            tables[i] = new Table(buckets);
+        }
+    }
+    else if(DS_config == "numa") {
+        tables = reinterpret_cast<Table**>( new numa<Table*, Node>[num_tables]);
+        for(int i = 0; i < num_tables; i++) {
+            tables[i] = new_table<Table, Node>(buckets, Node);
+        }
+    }
+    else if (DS_config.rfind("weighted", 0) == 0) {
+        tables = reinterpret_cast<Table**>( new numa<Table*, umf_weighted_node(Node)>[num_tables]);
+        for(int i = 0; i < num_tables; i++) {
+            tables[i] = new_table<Table, umf_weighted_node(Node)>(buckets, umf_weighted_node(Node));
+        }
+    }
+    else {
+        tables = new Table*[num_tables];
+        for(int i = 0; i < num_tables; i++) {
+            tables[i] = new Table(buckets);
+        }
+    }
+    locks.resize(num_tables);
+    for(int i = 0; i < num_tables; i++) {
+        locks[i] = new TableLock(buckets);
+    }
+}
+
+template <typename Table, typename Key>
+void numa_tables_init(int thread_id,
+                      int shard,
+                      const std::string& DS_config,
+                      int buckets,
+                      int num_tables,        // tables per node
+                      uint64_t num_keys,
+                      int num_total_threads)
+{
+    int threads_per_node = num_total_threads / num_nodes;
+    // the tables (and the prefill) go to the snapshot of the shard
+    bool snapshot_build = !snapshot_arenas.empty();
+    if (snapshot_build) {
+        SnapshotArena::current = snapshot_arenas[shard];
+    }
+    // ------------------ GLOBAL ALLOCATION (ONCE) ------------------
+    // by the first thread of every shard
+    if (thread_id == shard * threads_per_node) {
+        with_node(shard_node(shard), [&]<int Node>() {
+            alloc_node_tables<Table, Node>(shard, DS_config, snapshot_build, buckets, num_tables);
+        });
     }
     pthread_barrier_wait(&init_bar);
     // ------------------ SANITY CHECK ------------------
     if (thread_id == 0) {
-        for (int i = 0; i < num_tables; i++) {
-            if (ht_node0[i] == nullptr || ht_node1[i] == nullptr || ht_node0_locks[i] == nullptr || ht_node1_locks[i] == nullptr) {
-                std::cerr << "Hash table allocation error!" << std::endl;
-                return;
+        for (int n = 0; n < num_nodes; n++) {
+            for (int i = 0; i < num_tables; i++) {
+                if (node_tables<Table>[n][i] == nullptr || shard_locks[n][i] == nullptr) {
+                    std::cerr << "Hash table allocation error!" << std::endl;
+                    return;
+                }
             }
         }
     }
     pthread_barrier_wait(&init_bar);
-    return;
-    // ------------------ RNG (UNIQUE PER THREAD) ------------------
-    std::random_device rd;
-    std::mt19937_64 rng(rd() ^ (node << 16) ^ thread_id);
-    std::uniform_int_distribution<uint64_t> dist(0, num_keys - 1);
-    int tables_per_node = num_tables;
-    long long local_successful_inserts = 0;
-    int actual_total_tables = tables_per_node * 2;
-    // ------------------ PREFILL LOOP ------------------
-    long long iterations = (num_keys / 2);
-
-    for (long long i = 0; i < iterations; ++i) {
-        long long key_id = dist(rng); 
-        std::string key = "key" + std::to_string(key_id);
-        unsigned long key_hash = prefill_hash(key.c_str());
-        int table_index = key_hash % actual_total_tables;
-
-        if (node == 0) {
-            // If random key belongs to Node 0, insert it.
-            if (table_index < tables_per_node) {
-                ht_node0_locks[table_index]->lock();
-                bool result = ht_node0[table_index]->insert(key.c_str());
-                // if (result) {
-                //     local_successful_inserts++;
-                // }
-                ht_node0_locks[table_index]->unlock();  
-            }
-            // If it belongs to Node 1, skip it.
-        } 
-        else if (node == 1) {
-            // If random key belongs to Node 1, insert it.
-            if (table_index >= tables_per_node) {
-                int local_idx = table_index - tables_per_node;
-                ht_node1_locks[local_idx]->lock();
-                bool result = ht_node1[local_idx]->insert(key.c_str());
-                // if (result) {
-                //     local_successful_inserts++;
-                // }
-                ht_node1_locks[local_idx]->unlock();
-            }
-            // If it belongs to Node 0, skip it.
+    // ------------------ PREFILL ------------------
+    // Every shard holds all the prefilled keys (an operation on a key may
+    // go to any shard): the threads of the shard split the key space into
+    // ranges and insert the keys of their own range into its tables.
+    int node_thread = thread_id - shard * threads_per_node;
+    uint64_t first = num_keys * node_thread / threads_per_node;
+    uint64_t last = num_keys * (node_thread + 1) / threads_per_node;
+    Table** tables = node_tables<Table>[shard];
+    std::vector<TableLock*>& locks = shard_locks[shard];
+    Key key;
+    uint64_t expected = 0;
+    for (uint64_t key_id = first; key_id < last; key_id++) {
+        if (!prefilled(key_id)) {
+            continue;
         }
+        expected++;
+        key.set(key_id);
+        int t = table_of<Table>(key, key_id, num_tables, num_keys);
+        locks[t]->lock(key.hash);
+        tables[t]->insert(key.value(), key.hash);
+        locks[t]->unlock(key.hash);
     }
-    // ------------------ REDUCTION ------------------
     pthread_barrier_wait(&init_bar);
-
-    // globalLK->lock();
-    //     global_successful_init_inserts += local_successful_inserts;
-    // globalLK->unlock();
+    // ------------------ VERIFICATION ------------------
+    // (the tables are not modified any more, no locking)
+    uint64_t found = 0;
+    for (uint64_t key_id = first; key_id < last; key_id++) {
+        if (prefilled(key_id)) {
+            key.set(key_id);
+            int t = table_of<Table>(key, key_id, num_tables, num_keys);
+            found += tables[t]->getCount(key.value(), key.hash) > 0;
+        }
+    }
+    globalLK->lock();
+    prefill_expected[shard] += expected;
+    prefill_found[shard] += found;
+    global_successful_init_inserts += found;
+    globalLK->unlock();
 
     pthread_barrier_wait(&init_bar);
+    if (thread_id == 0) {
+        for (int n = 0; n < num_nodes; n++) {
+            if (prefill_found[n] != prefill_expected[n]) {
+                std::cerr << "Prefill of shard " << n << " failed: " << prefill_found[n] << " of "
+                          << prefill_expected[n] << " keys found" << std::endl;
+                exit(1);
+            }
+        }
+    }
     #ifdef DEBUG
         if (thread_id == 0) {
             std::cout << "Prefill complete. Total inserts = "  << global_successful_init_inserts << std::endl;
         }
     #endif
 
+    if (!snapshot_build) {
+        return;
+    }
     pthread_barrier_wait(&init_bar);
+    SnapshotArena::current = nullptr;
+    if (thread_id == 0) {
+        for (int n = 0; n < num_nodes; n++) {
+            snapshot_arenas[n]->seal(node_tables<Table>[n]);
+        }
+    }
 }
 
+void numa_hash_table_init(int thread_id,
+                          int node,
+                          std::string DS_config,
+                          int buckets,
+                          int num_tables,        // tables per node
+                          uint64_t num_keys,
+                          int num_total_threads)
+{
+    if (snapshot_restored) {
+        return;
+    }
+    with_table_type([&]<typename Table, typename Key>() {
+        numa_tables_init<Table, Key>(thread_id, node, DS_config, buckets, num_tables, num_keys, num_total_threads);
+    });
+}
 
+Generator<uint64_t>* make_key_generator(const KeyDistribution& dist) {
+    uint64_t max = dist.num_keys - 1;
+    if (dist.name == "uniform") {
+        return new UniformGenerator(0, max);
+    }
+    if (dist.name == "zipfian") {
+        return new ZipfianGenerator(0, max, dist.theta, dist.zeta_n);
+    }
+    if (dist.name == "scrambled") {
+        return new ScrambledZipfianGenerator(0, max, dist.theta, dist.zeta_n);
+    }
+    if (dist.name == "latest") {
+        return new SkewedLatestGenerator(*dist.latest, dist.theta, dist.zeta_n);
+    }
+    return new HotspotGenerator(0, max, dist.hot_set, dist.hot_ops);
+}
 
-void ycsb_test(
+// Updates the count of the key. With the optimistic reads the node is not
+// replaced (a reader could still be walking it), with the rcu ones the
+// replaced node is retired to the epoch lists of the thread.
+template <typename Table, typename Key>
+static inline void update_count(Table* table, Key& key, int count)
+{
+    if constexpr (requires { table->updateCount(key.value(), count, key.hash, [](auto*) {}); }) {
+        if (TableLock::mode == LockMode::rcu) {
+            table->updateCount(key.value(), count, key.hash, [](auto* old) { Epoch::retire(old); });
+            return;
+        }
+    }
+    if constexpr (requires { table->updateCountInPlace(key.value(), count, key.hash); }) {
+        if (TableLock::mode == LockMode::optimistic) {
+            table->updateCountInPlace(key.value(), count, key.hash);
+            return;
+        }
+    }
+    table->updateCount(key.value(), count, key.hash);
+}
+
+// Inserts the key, or increments its count. With the rcu reads the node of
+// an existing key is replaced and retired, as in update_count().
+template <typename Table, typename Key>
+static inline bool insert_key(Table* table, Key& key)
+{
+    if constexpr (requires { table->insert(key.value(), key.hash, [](auto*) {}); }) {
+        if (TableLock::mode == LockMode::rcu) {
+            return table->insert(key.value(), key.hash, [](auto* old) { Epoch::retire(old); });
+        }
+    }
+    return table->insert(key.value(), key.hash);
+}
+
+OpType op_type(const WorkloadConfig* cfg, int op_choice)
+{
+    if (op_choice <= cfg->read_pct) return OP_READ;
+    op_choice -= cfg->read_pct;
+    if (op_choice <= cfg->update_pct) return OP_UPDATE;
+    op_choice -= cfg->update_pct;
+    if (op_choice <= cfg->insert_pct) return OP_INSERT;
+    op_choice -= cfg->insert_pct;
+    if (op_choice <= cfg->scan_pct) return OP_SCAN;
+    return OP_RMW;
+}
+
+const char* op_name(OpType op)
+{
+    static const char* names[OP_TYPES] = {"read", "update", "insert", "scan", "rmw"};
+    return names[op];
+}
+
+// Runs operation <op> on <key> (key_id) in <table>.
+// Returns true if a new key was inserted.
+template <typename Table, typename Key>
+static inline bool ycsb_op(Table* table, TableLock* lock, OpType op,
+                           Key& key, uint64_t key_id, uint64_t num_keys)
+{
+    bool inserted = false;
+    switch (op) {
+    case OP_READ:
+        lock->read(key.hash, [&] { return table->getCount(key.value(), key.hash); });
+        break;
+    case OP_UPDATE:
+        lock->lock(key.hash);
+        update_count(table, key, 1);
+        lock->unlock(key.hash);
+        break;
+    case OP_INSERT:
+        lock->lock(key.hash);
+        inserted = insert_key(table, key);
+        lock->unlock(key.hash);
+        break;
+    case OP_SCAN:
+        if constexpr (requires { table->scan(key.value(), 10); }) {
+            // the 10 keys following the key in the ordered table
+            lock->read(key.hash, [&] { return table->scan(key.value(), 10); });
+        } else {
+            for (int j = 0; j < 10 && (key_id + j) < num_keys; j++) {
+                key.set(key_id + j);
+                lock->read(key.hash, [&] { return table->getCount(key.value(), key.hash); });
+            }
+        }
+        break;
+    default:
+        lock->lock(key.hash);
+        table->getCount(key.value(), key.hash);
+        update_count(table, key, 1);
+        lock->unlock(key.hash);
+        break;
+    }
+    return inserted;
+}
+
+template <typename Table, typename Key>
+void ycsb_run(
     int thread_id,
-    int num_total_threads,
     int numa_node,
     int duration,
     const WorkloadConfig* cfg,
-    ZipfianGenerator* gen,
+    const KeyDistribution* dist,
     uint64_t num_keys,
     int local_pct,
     int interval,
@@ -217,154 +539,52 @@ void ycsb_test(
 	thread_local vector<int64_t> localOps;
 	localOps.resize(duration/interval);
 	auto startTimer = std::chrono::steady_clock::now();
-	auto endTimer = startTimer + std::chrono::seconds(duration);
     auto nextLogTime = startTimer + std::chrono::seconds(interval);
 	int intervalIdx = 0;
     mt19937 rng(random_device{}());
     uniform_int_distribution<int> op_dist(1, 100);
     uniform_int_distribution<int> locality_dist(1, 100);
-    uniform_int_distribution<int> ht_dist(0, num_tables-1); // already passed in as num_tables/2 aka tables_per_node
-    uniform_int_distribution<uint64_t> key_dist(0, num_keys-1);
+    // built by the thread itself - its state stays thread local
+    unique_ptr<Generator<uint64_t>> gen(make_key_generator(*dist));
+    // the key of the current operation, formatted and hashed in place
+    Key key;
+    const vector<Table**>& tables = node_tables<Table>;
+    // remote operations go to the other shards, see remote_targets_init()
+    const vector<double>& weights = remote_weights[numa_node];
+    discrete_distribution<int> remote_dist(weights.begin(), weights.end());
     int successful_inserts = 0;
-	while (duration_cast<seconds>(steady_clock::now() - startTimer).count() < duration) {
-		//uint64_t key_id = gen->Next();
-        uint64_t key_id = key_dist(rng);
-        string key = "key" + to_string(key_id);
+    // [0 - local, 1 - remote][op type]
+    vector<array<LatencyHistogram, OP_TYPES>> latency(2);
+    // the end of the previous operation - ops read the clock only around themselves
+    auto now = startTimer;
+    const auto endTime = startTimer + seconds(duration);
+	while (now < endTime) {
+        OpType op = op_type(cfg, op_dist(rng));
+        // with the latest distribution inserts add new keys (the most popular ones)
+        uint64_t key_id = (dist->latest && op == OP_INSERT) ? dist->latest->Next() : gen->Next();
+        key.set(key_id);
         int locality_choice = locality_dist(rng);
-        int ht_choice = prefill_hash(key.c_str())%num_tables;
-
-        if (numa_node == 0) {
-            if (locality_choice <= local_pct) {
-                int op_choice = op_dist(rng);
-                if (op_choice <= cfg->read_pct) {
-                    ht_node0_locks[ht_choice]->lock();
-                    ht_node0[ht_choice]->getCount(key.c_str());
-                    ht_node0_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct) {
-                    ht_node0_locks[ht_choice]->lock();
-                    ht_node0[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node0_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct) {
-                    ht_node0_locks[ht_choice]->lock();
-                    bool result = ht_node0[ht_choice]->insert(key.c_str());
-                    if (result) {
-                        successful_inserts++;
-                    }
-                    ht_node0_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct + cfg->scan_pct) {
-                    for (int j = 0; j < 10 && (key_id + j) < (uint64_t)num_keys; j++) {
-                        string skey = "key" + to_string(key_id + j);
-                        ht_node0_locks[ht_choice]->lock();
-                        ht_node0[ht_choice]->getCount(skey.c_str());
-                        ht_node0_locks[ht_choice]->unlock();
-                    }
-                } else {
-                    ht_node0_locks[ht_choice]->lock();
-                    ht_node0[ht_choice]->getCount(key.c_str());
-                    ht_node0[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node0_locks[ht_choice]->unlock();
-                }
-            }
-            else {
-                int op_choice = op_dist(rng);
-                if (op_choice <= cfg->read_pct) {
-                    ht_node1_locks[ht_choice]->lock();
-                    ht_node1[ht_choice]->getCount(key.c_str());
-                    ht_node1_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct) {
-                    ht_node1_locks[ht_choice]->lock();
-                    ht_node1[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node1_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct) {
-                    ht_node1_locks[ht_choice]->lock();
-                    bool result = ht_node1[ht_choice]->insert(key.c_str());
-                    if (result) {
-                        successful_inserts++;
-                    }
-                    ht_node1_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct + cfg->scan_pct) {
-                    for (int j = 0; j < 10 && (key_id + j) < (uint64_t)num_keys; j++) {
-                        string skey = "key" + to_string(key_id + j);
-                        ht_node1_locks[ht_choice]->lock();
-                        ht_node1[ht_choice]->getCount(skey.c_str());
-                        ht_node1_locks[ht_choice]->unlock();
-                    }
-                } else {
-                    ht_node1_locks[ht_choice]->lock();
-                    ht_node1[ht_choice]->getCount(key.c_str());
-                    ht_node1[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node1_locks[ht_choice]->unlock();
-                }
-            }
-        }
+        int ht_choice = table_of<Table>(key, key_id, num_tables, num_keys);
 
-        else if (numa_node == 1)
-        {
-            if (locality_choice <= local_pct) {
-                int op_choice = op_dist(rng);
-                if (op_choice <= cfg->read_pct) {
-                    ht_node1_locks[ht_choice]->lock();
-                    ht_node1[ht_choice]->getCount(key.c_str());
-                    ht_node1_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct) {
-                    ht_node1_locks[ht_choice]->lock();
-                    ht_node1[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node1_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct) {
-                    ht_node1_locks[ht_choice]->lock();
-                    bool result = ht_node1[ht_choice]->insert(key.c_str());
-                    if (result) {
-                        successful_inserts++;
-                    }
-                    ht_node1_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct + cfg->scan_pct) {
-                    for (int j = 0; j < 10 && (key_id + j) < (uint64_t)num_keys; j++) {
-                        string skey = "key" + to_string(key_id + j);
-                        ht_node1_locks[ht_choice]->lock();
-                        ht_node1[ht_choice]->getCount(skey.c_str());
-                        ht_node1_locks[ht_choice]->unlock();
-                    }
-                } else {
-                    ht_node1_locks[ht_choice]->lock();
-                    ht_node1[ht_choice]->getCount(key.c_str());
-                    ht_node1[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node1_locks[ht_choice]->unlock();
-                }
-            }
-            else {
-                int op_choice = op_dist(rng);
-                if (op_choice <= cfg->read_pct) {
-                    ht_node0_locks[ht_choice]->lock();
-                    ht_node0[ht_choice]->getCount(key.c_str());
-                    ht_node0_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct) {
-                    ht_node0_locks[ht_choice]->lock();
-                    ht_node0[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node0_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct) {
-                    ht_node0_locks[ht_choice]->lock();
-                    bool result = ht_node0[ht_choice]->insert(key.c_str());
-                    if (result) {
-                        successful_inserts++;
-                    }
-                    ht_node0_locks[ht_choice]->unlock();
-                } else if (op_choice <= cfg->read_pct + cfg->update_pct + cfg->insert_pct + cfg->scan_pct) {
-                    for (int j = 0; j < 10 && (key_id + j) < (uint64_t)num_keys; j++) {
-                        string skey = "key" + to_string(key_id + j);
-                        ht_node0_locks[ht_choice]->lock();
-                        ht_node0[ht_choice]->getCount(skey.c_str());
-                        ht_node0_locks[ht_choice]->unlock();
-                    }
-                } else {
-                    ht_node0_locks[ht_choice]->lock();
-                    ht_node0[ht_choice]->getCount(key.c_str());
-                    ht_node0[ht_choice]->updateCount(key.c_str(), 1);
-                    ht_node0_locks[ht_choice]->unlock();
-                }
-            }
+        // local operations go to the tables of the thread's node
+        int target = (locality_choice <= local_pct || num_nodes == 1) ? numa_node : remote_dist(rng);
+        auto opStart = steady_clock::now();
+        bool inserted;
+        if (delegation && target != numa_node) {
+            // the server of the target shard runs it
+            inserted = delegation_rings[target]->delegate(thread_id, op, ht_choice, key_id);
+        } else {
+            inserted = ycsb_op(tables[target][ht_choice], shard_locks[target][ht_choice], op,
+                               key, key_id, num_keys);
+        }
+        if (inserted) {
+            successful_inserts++;
         }
+        auto opEnd = steady_clock::now();
+        latency[target != numa_node][op].record(duration_cast<nanoseconds>(opEnd - opStart).count());
+        now = opEnd;
 		ops++;
-		if(std::chrono::steady_clock::now() >= nextLogTime){
+		if(opEnd >= nextLogTime){
 			localOps[intervalIdx] = ops;
 			intervalIdx++;
 			nextLogTime += std::chrono::seconds(interval);
@@ -375,17 +595,13 @@ void ycsb_test(
      
 	globalLK->lock();
     global_successful_inserts += successful_inserts;
-	if(numa_node==0)
-	{
-		for(int i=0; i<localOps.size(); i++){
-			globalOps0[i] += localOps[i];
-		}
-	}
-	else
-	{
-		for(int i=0; i<localOps.size(); i++){
-			globalOps1[i] += localOps[i];
-		}
+    for (int remote = 0; remote < 2; remote++) {
+        for (int op = 0; op < OP_TYPES; op++) {
+            globalLatency[remote][op].merge(latency[remote][op]);
+        }
+    }
+	for(size_t i=0; i<localOps.size(); i++){
+		globalOps[numa_node][i] += localOps[i];
 	}
 	globalLK->unlock();
 
@@ -400,4 +616,86 @@ void ycsb_test(
     #endif
 }
 
+void delegation_init(int num_threads, bool numa_placement)
+{
+    for (auto ring : delegation_rings) {
+        delete ring;
+    }
+    delegation_rings.clear();
+    for (int n = 0; n < num_nodes; n++) {
+        delegation_rings.push_back(new DelegationRing(num_threads, numa_placement ? shard_node(n) : -1));
+    }
+    delegation_stopped = false;
+}
 
+template <typename Table, typename Key>
+void delegation_serve(int shard, uint64_t num_keys)
+{
+    Table** tables = node_tables<Table>[shard];
+    std::vector<TableLock*>& locks = shard_locks[shard];
+    DelegationRing* ring = delegation_rings[shard];
+    Key key;
+    unsigned idle = 0;
+    while (!delegation_stopped.load(std::memory_order_relaxed)) {
+        int served = ring->serve([&](OpType op, int t, uint64_t key_id) {
+            key.set(key_id);
+            return ycsb_op(tables[t], locks[t], op, key, key_id, num_keys);
+        });
+        if (served) {
+            idle = 0;
+        } else if (idle < DelegationRing::PARK_AFTER) {
+            TableLock::backoff(idle++);
+        } else {
+            ring->park(delegation_stopped);
+            idle = 0;
+        }
+    }
+}
+
+void delegation_server(int shard, uint64_t num_keys)
+{
+    with_table_type([&]<typename Table, typename Key>() {
+        delegation_serve<Table, Key>(shard, num_keys);
+    });
+}
+
+void delegation_stop()
+{
+    delegation_stopped = true;
+    for (auto ring : delegation_rings) {
+        ring->wake();
+    }
+}
+
+void ycsb_test(
+    int thread_id,
+    int numa_node,
+    int duration,
+    const WorkloadConfig* cfg,
+    const KeyDistribution* dist,
+    uint64_t num_keys,
+    int local_pct,
+    int interval,
+    int num_tables
+)
+{
+    with_table_type([&]<typename Table, typename Key>() {
+        ycsb_run<Table, Key>(thread_id, numa_node, duration, cfg, dist,
+                             num_keys, local_pct, interval, num_tables);
+    });
+}
+
+void print_latencies(std::ostream& out, const std::string& run)
+{
+    for (int op = 0; op < OP_TYPES; op++) {
+        for (int remote = 0; remote < 2; remote++) {
+            const LatencyHistogram& h = globalLatency[remote][op];
+            if (h.count() == 0) {
+                continue;
+            }
+            out << run << op_name((OpType)op) << ", " << (remote ? "remote" : "local") << ", "
+                << h.count() << ", " << h.percentile(50) << ", " << h.percentile(99) << ", "
+                << h.percentile(99.9) << ", " << h.max() << "\n";
+        }
+    }
+}